@@ -0,0 +1,88 @@
+#include "fenwick_tree.h"
+
+/// lowest set bit of i
+static size_t lowbit(size_t i)
+{
+	return i & (~i + 1);
+}
+
+/// construct empty tree
+fenwick_tree::fenwick_tree() : tree(1, 0)
+{
+}
+
+/// rebuild tree from given counts in O(n)
+void fenwick_tree::build(const std::vector<size_t>& counts)
+{
+	tree.assign(counts.size() + 1, 0);
+	for (size_t i = 1; i < tree.size(); ++i) {
+		tree[i] += counts[i - 1];
+		size_t parent = i + lowbit(i);
+		if (parent < tree.size())
+			tree[parent] += tree[i];
+	}
+}
+
+/// remove all counts
+void fenwick_tree::clear()
+{
+	tree.assign(1, 0);
+}
+
+/// return number of counts
+size_t fenwick_tree::size() const
+{
+	return tree.size() - 1;
+}
+
+/// append a count in O(log n)
+void fenwick_tree::push_back(size_t count)
+{
+	size_t i = tree.size();
+	// new entry covers the counts in [i-lowbit(i),i), of which all but the new one are already stored
+	tree.push_back(count + prefix_sum(i - 1) - prefix_sum(i - lowbit(i)));
+}
+
+/// add delta to count with given index
+void fenwick_tree::add(size_t idx, ptrdiff_t delta)
+{
+	for (size_t i = idx + 1; i < tree.size(); i += lowbit(i))
+		tree[i] += delta;
+}
+
+/// return sum of the counts with indices in [0,idx)
+size_t fenwick_tree::prefix_sum(size_t idx) const
+{
+	size_t sum = 0;
+	for (size_t i = idx; i > 0; i -= lowbit(i))
+		sum += tree[i];
+	return sum;
+}
+
+/// return sum of all counts
+size_t fenwick_tree::total() const
+{
+	return prefix_sum(size());
+}
+
+/// return count with given index
+size_t fenwick_tree::get(size_t idx) const
+{
+	return prefix_sum(idx + 1) - prefix_sum(idx);
+}
+
+/// return the index of the count that contains position pos
+size_t fenwick_tree::find(size_t pos) const
+{
+	// descend from the largest power of two and keep the largest index whose prefix sum does not exceed pos
+	size_t idx = 0;
+	size_t step = 1;
+	while (2 * step < tree.size())
+		step *= 2;
+	for (; step > 0; step /= 2)
+		if (idx + step < tree.size() && tree[idx + step] <= pos) {
+			idx += step;
+			pos -= tree[idx];
+		}
+	return idx;
+}
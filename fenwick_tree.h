@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/// Fenwick tree (binary indexed tree) over non negative counts supporting prefix sums, updates and search in O(log n)
+class fenwick_tree
+{
+protected:
+	/// one based tree array, where entry i stores the sum of the counts with indices in [i-lowbit(i),i)
+	std::vector<size_t> tree;
+public:
+	/// construct empty tree
+	fenwick_tree();
+	/// rebuild tree from given counts in O(n)
+	void build(const std::vector<size_t>& counts);
+	/// remove all counts
+	void clear();
+	/// return number of counts
+	size_t size() const;
+	/// append a count in O(log n)
+	void push_back(size_t count);
+	/// add delta to count with given index
+	void add(size_t idx, ptrdiff_t delta);
+	/// return sum of the counts with indices in [0,idx)
+	size_t prefix_sum(size_t idx) const;
+	/// return sum of all counts
+	size_t total() const;
+	/// return count with given index
+	size_t get(size_t idx) const;
+	/// return the index of the count that contains position pos, i.e. the index idx with prefix_sum(idx) <= pos < prefix_sum(idx+1); returns size() if pos >= total()
+	size_t find(size_t pos) const;
+};
@@ -0,0 +1,113 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/// construct without mapping
+mapped_file::mapped_file() : data_ptr(0), data_size(0)
+{
+#ifdef _WIN32
+	file_handle = INVALID_HANDLE_VALUE;
+	mapping_handle = 0;
+#else
+	file_descriptor = -1;
+#endif
+}
+
+/// unmap file
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+/// map given file and return whether this was successful
+bool mapped_file::open(const std::string& file_name)
+{
+	close();
+#ifdef _WIN32
+	file_handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_handle, &file_size)) {
+		close();
+		return false;
+	}
+	data_size = size_t(file_size.QuadPart);
+	// empty files cannot be mapped
+	if (data_size == 0)
+		return true;
+	mapping_handle = CreateFileMappingA(file_handle, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mapping_handle) {
+		close();
+		return false;
+	}
+	data_ptr = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+	if (!data_ptr) {
+		close();
+		return false;
+	}
+#else
+	file_descriptor = ::open(file_name.c_str(), O_RDONLY);
+	if (file_descriptor == -1)
+		return false;
+	struct stat file_stat;
+	if (fstat(file_descriptor, &file_stat) != 0) {
+		close();
+		return false;
+	}
+	data_size = size_t(file_stat.st_size);
+	// empty files cannot be mapped
+	if (data_size == 0)
+		return true;
+	void* ptr = mmap(0, data_size, PROT_READ, MAP_SHARED, file_descriptor, 0);
+	if (ptr == MAP_FAILED) {
+		close();
+		return false;
+	}
+	data_ptr = static_cast<const char*>(ptr);
+#endif
+	return true;
+}
+
+/// unmap file
+void mapped_file::close()
+{
+#ifdef _WIN32
+	if (data_ptr)
+		UnmapViewOfFile(data_ptr);
+	if (mapping_handle)
+		CloseHandle(mapping_handle);
+	if (file_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(file_handle);
+	file_handle = INVALID_HANDLE_VALUE;
+	mapping_handle = 0;
+#else
+	if (data_ptr)
+		munmap(const_cast<char*>(data_ptr), data_size);
+	if (file_descriptor != -1)
+		::close(file_descriptor);
+	file_descriptor = -1;
+#endif
+	data_ptr = 0;
+	data_size = 0;
+}
+
+/// return pointer to first byte of mapped file or 0 if nothing is mapped
+const char* mapped_file::data() const
+{
+	return data_ptr;
+}
+
+/// return size of mapped file in bytes
+size_t mapped_file::size() const
+{
+	return data_size;
+}
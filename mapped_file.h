@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+/// read only memory mapping of a whole file
+class mapped_file
+{
+protected:
+	const char* data_ptr;
+	size_t data_size;
+#ifdef _WIN32
+	void* file_handle;
+	void* mapping_handle;
+#else
+	int file_descriptor;
+#endif
+	mapped_file(const mapped_file&);
+	mapped_file& operator = (const mapped_file&);
+public:
+	/// construct without mapping
+	mapped_file();
+	/// unmap file
+	~mapped_file();
+	/// map given file and return whether this was successful
+	bool open(const std::string& file_name);
+	/// unmap file
+	void close();
+	/// return pointer to first byte of mapped file or 0 if nothing is mapped
+	const char* data() const;
+	/// return size of mapped file in bytes
+	size_t size() const;
+};
@@ -1,10 +1,27 @@
 #include "polygon.h"
+#include "polygon_stream.h"
 #include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
 
 /// constuct loop 
 polygon_loop::polygon_loop(size_t _fst_vtx, size_t _nr_vts, clr_type _clr, bool _is_clsd) :
-	orientation(PO_UNDEF), first_vertex(_fst_vtx), nr_vertices(_nr_vts), color(_clr), is_closed(_is_clsd) {
+	orientation(PO_UNDEF), first_vertex(_fst_vtx), nr_vertices(_nr_vts), color(_clr), is_closed(_is_clsd),
+	area(_nr_vts > 1 ? std::numeric_limits<double>::quiet_NaN() : 0), area_error(0), nr_area_updates(0), area_undecided(false) {
+}
+
+/// rebuild loop offsets after loops have been removed
+void polygon::update_loop_offsets()
+{
+	std::vector<size_t> sizes(loops.size());
+	for (size_t li = 0; li < loops.size(); ++li)
+		sizes[li] = loops[li].nr_vertices;
+	loop_offsets.build(sizes);
 }
 
 /// assert that loop index is within valid range
@@ -19,25 +36,169 @@ void polygon::validate_vertex_index(size_t vtx_idx) const
 	assert(vtx_idx < vertices.size()); 
 }
 
-///  function to compute the orientation of a loop
-PolygonOrientation polygon::compute_orientation(size_t loop_idx) const
+/// return twice the signed area of the triangle spanned by the origin and an edge, which is exact in double precision for float coordinates
+static double edge_term(const polygon::vtx_type& p0, const polygon::vtx_type& p1)
 {
-	if (!loop_closed(loop_idx))
-		return PO_UNDEF;
-	float cp_sum = 0;
-	size_t last_vi = loop_end(loop_idx)-1;
+	return double(p0(0))*p1(1) - double(p0(1))*p1(0);
+}
+
+/// return predecessor of vertex within its loop, where also open loops are treated as cyclic
+size_t polygon::prev_loop_vertex(size_t loop_idx, size_t vtx_idx) const
+{
+	return vtx_idx == loop_begin(loop_idx) ? loop_end(loop_idx) - 1 : vtx_idx - 1;
+}
+
+/// return successor of vertex within its loop, where also open loops are treated as cyclic
+size_t polygon::next_loop_vertex(size_t loop_idx, size_t vtx_idx) const
+{
+	return vtx_idx + 1 == loop_end(loop_idx) ? loop_begin(loop_idx) : vtx_idx + 1;
+}
+
+/// compute signed area of loop treated as closed by summation over all edges in double precision and optionally a bound on its rounding error
+double polygon::compute_area(size_t loop_idx, double* error_bound) const
+{
+	double sum = 0, abs_sum = 0;
+	size_t last_vi = loop_end(loop_idx) - 1;
 	for (size_t vi = loop_begin(loop_idx); vi < loop_end(loop_idx); ++vi) {
-		const vtx_type& p0 = vertex(last_vi);
-		const vtx_type& p1 = vertex(vi);
-		cp_sum += p0(0)*p1(1) - p0(1)*p1(0);
+		double term = edge_term(vertex(last_vi), vertex(vi));
+		sum += term;
+		abs_sum += std::abs(term);
 		last_vi = vi;
 	}
-	return cp_sum < 0 ? PO_CW : PO_CCW;
+	// each term and each partial sum is rounded once
+	if (error_bound)
+		*error_bound = 0.5*std::numeric_limits<double>::epsilon()*double(loop_size(loop_idx) + 1)*abs_sum;
+	return 0.5*sum;
+}
+
+/// add delta to loop area, where magnitude bounds the edge terms involved, and recompute it exactly after as many updates as the loop has vertices or if rounding errors could flip its sign
+void polygon::update_area(size_t loop_idx, double delta, double magnitude)
+{
+	polygon_loop& loop = loops[loop_idx];
+	// exact recomputation amortizes to O(1) per update and bounds the drift
+	if (!std::isnan(loop.area) && ++loop.nr_area_updates <= std::max(loop.nr_vertices, size_t(64))) {
+		loop.area += delta;
+		loop.area_error += std::numeric_limits<double>::epsilon()*(magnitude + std::abs(loop.area));
+		// only the orientation of closed loops depends on the sign, and a degenerate loop whose sign the exact computation could not decide would otherwise be recomputed on every update
+		if (!loop.is_closed || std::abs(loop.area) > loop.area_error || loop.area_undecided)
+			return;
+	}
+	loop.area = compute_area(loop_idx, &loop.area_error);
+	loop.area_undecided = std::abs(loop.area) <= loop.area_error;
+	loop.nr_area_updates = 0;
+}
+
+/// compute the orientation of a loop from the sign of its area
+PolygonOrientation polygon::compute_orientation(size_t loop_idx) const
+{
+	if (!loop_closed(loop_idx))
+		return PO_UNDEF;
+	double area = loops[loop_idx].area, area_error = loops[loop_idx].area_error;
+	if (std::isnan(area))
+		area = compute_area(loop_idx, &area_error);
+	// the sign of collinear or otherwise degenerate loops is not reliable
+	if (std::abs(area) <= area_error)
+		return PO_UNDEF;
+	return area < 0 ? PO_CW : PO_CCW;
+}
+
+/// set orientation of loop from its area and return PLA_ORIENTATION if it changed or 0 otherwise
+int polygon::update_orientation(size_t loop_idx)
+{
+	PolygonOrientation new_po = compute_orientation(loop_idx);
+	if (new_po == loops[loop_idx].orientation)
+		return 0;
+	loops[loop_idx].orientation = new_po;
+	return PLA_ORIENTATION;
+}
+
+/// emit on_change_loop or collect flags in case of batch
+void polygon::notify_loop_change(size_t loop_idx, int flags)
+{
+	if (batch_depth > 0)
+		batch_loop_flags[loop_idx] |= flags;
+	else
+		on_change_loop(loop_idx, flags);
+}
+
+/// keep batch vertex range valid after insertion of a vertex
+void polygon::batch_insert_vertex(size_t vtx_idx)
+{
+	if (batch_depth == 0 || batch_vtx_begin >= batch_vtx_end)
+		return;
+	if (vtx_idx <= batch_vtx_begin)
+		++batch_vtx_begin;
+	if (vtx_idx < batch_vtx_end)
+		++batch_vtx_end;
+}
+
+/// keep batch vertex range valid after removal of vertices
+void polygon::batch_remove_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	if (batch_depth == 0 || batch_vtx_begin >= batch_vtx_end)
+		return;
+	size_t n = vtx_end - vtx_begin;
+	// shift range ends behind the removed vertices and clamp range ends inside of them
+	batch_vtx_begin = batch_vtx_begin >= vtx_end ? batch_vtx_begin - n : std::min(batch_vtx_begin, vtx_begin);
+	batch_vtx_end = batch_vtx_end >= vtx_end ? batch_vtx_end - n : std::min(batch_vtx_end, vtx_begin);
+}
+
+/// keep batch loop flags valid after removal of a loop
+void polygon::batch_remove_loop(size_t loop_idx)
+{
+	if (batch_depth > 0)
+		batch_loop_flags.erase(batch_loop_flags.begin() + loop_idx);
 }
 
 /// construct empty polygon
-polygon::polygon() 
+polygon::polygon() : last_found_loop(0), batch_depth(0), batch_vtx_begin(0), batch_vtx_end(0)
+{
+}
+
+/// start a batch, batches can be nested
+void polygon::begin_batch()
 {
+	if (batch_depth++ > 0)
+		return;
+	batch_vtx_begin = batch_vtx_end = 0;
+	batch_loop_flags.assign(nr_loops(), 0);
+}
+
+/// end a batch, if outermost batch ends update orientations and emit on_change_vertex_range and on_change_loop for collected changes
+void polygon::end_batch()
+{
+	assert(batch_depth > 0);
+	if (--batch_depth > 0)
+		return;
+	if (batch_vtx_begin < batch_vtx_end) {
+		on_change_vertex_range(batch_vtx_begin, batch_vtx_end);
+		size_t loop_end_idx = find_loop(batch_vtx_end - 1) + 1;
+		// loop areas are up to date such that orientations are updated in O(1) per loop
+		for (size_t li = find_loop(batch_vtx_begin); li < loop_end_idx; ++li)
+			batch_loop_flags[li] |= update_orientation(li);
+	}
+	for (size_t li = 0; li < nr_loops(); ++li)
+		if (batch_loop_flags[li] != 0)
+			on_change_loop(li, batch_loop_flags[li]);
+	batch_loop_flags.clear();
+}
+
+/// return whether a batch is active
+bool polygon::in_batch() const
+{
+	return batch_depth > 0;
+}
+
+/// begin batch
+polygon_batch::polygon_batch(polygon& _poly) : poly(_poly)
+{
+	poly.begin_batch();
+}
+
+/// end batch
+polygon_batch::~polygon_batch()
+{
+	poly.end_batch();
 }
 
 /// remove all loops and all vertices
@@ -45,15 +206,30 @@ void polygon::clear()
 {
 	if (nr_vertices() > 0) {
 		before_remove_vertex_range(0, nr_vertices());
+		batch_remove_vertex_range(0, nr_vertices());
 		vertices.clear();
 	}
 	if (nr_loops() > 0) {
 		for (size_t li = nr_loops(); li > 0; --li)
 			before_remove_loop(li-1);
 		loops.clear();
+		loop_offsets.clear();
+		batch_loop_flags.clear();
 	}
 }
 
+/// return vertex storage mode
+VertexStorageMode polygon::get_vertex_storage_mode() const
+{
+	return vertices.get_mode();
+}
+
+/// convert vertex storage, where chunked storage supports vertex insertion and removal in O(log(nr_vertices())) for large polygons
+void polygon::set_vertex_storage_mode(VertexStorageMode mode)
+{
+	vertices.set_mode(mode);
+}
+
 /// compute axis aligned bounding box of vertices
 polygon::box_type polygon::compute_box() const
 {
@@ -70,10 +246,9 @@ void polygon::center_and_scale_to_unit_box()
 	box_type box = compute_box();
 	float scale = 2.0f / box.get_extent()[box.get_max_extent_coord_index()];
 	vtx_type ctr = box.get_center();
-	for (size_t vi = 0; vi < nr_vertices(); ++vi) {
-		vertices[vi] = scale*(vertices[vi] - ctr);
-		on_change_vertex(vi);
-	}
+	polygon_batch batch(*this);
+	for (size_t vi = 0; vi < nr_vertices(); ++vi)
+		set_vertex(vi, scale*(vertex(vi) - ctr));
 }
 
 void polygon::generate_circle(size_t nr_vts)
@@ -85,112 +260,218 @@ void polygon::generate_circle(size_t nr_vts)
 	}
 }
 
-/// read polygon from text file
-bool polygon::read(const std::string& file_name)
+/// replace loops and vertices in bulk, compute loop orientations and emit on_new_polygon
+void polygon::assign(std::vector<polygon_loop>& new_loops, std::vector<vtx_type>& new_vertices)
 {
-	std::ifstream is(file_name.c_str());
-	if (is.fail())
-		return false;
-	char buffer[1025];
-	buffer[1024] = 0;
-	float x, y;
-
-	// read first line to determine whether we have a file with loops
-	is.getline(buffer, 1024);
-	std::string str(buffer);
-	std::stringstream ss(str);
-	ss >> x >> y;
-
-	if (!ss.fail()) {
-		append_loop(vtx_type(x, y));
-		while (!is.eof()) {
-			is >> x >> y;
-			if (is.fail())
-				break;
-			append_vertex_to_loop(vtx_type(x, y));
-		}
-		close_loop(0);
-	}
-	else {
-		std::stringstream ss(str);
-		size_t nr_loops;
-		ss >> nr_loops;
-		if (ss.fail())
-			return false;
-
-		for (size_t li = 0; li < nr_loops; ++li) {
-			if (is.eof())
-				return false;
-			is.getline(buffer, 1024);
-			str = std::string(buffer);
-			std::stringstream ss(str);
-			size_t nr_vertices;
-			int closed, r, g, b;
-			ss >> nr_vertices >> closed;
-			if (ss.fail())
-				return false;
-			ss >> r >> g >> b;
-			if (ss.fail()) {
-				r = 0;
-				b = 0;
-				g = 0;
-			}
-			if (nr_vertices == 0)
-				return false;
-
-			is.getline(buffer, 1024);
-			str = std::string(buffer);
-			{
-				std::stringstream ss(str);
-				ss >> x >> y;
-				if (ss.fail())
-					return false;
-			}
+	clear();
+	vertices.assign(new_vertices);
+	assign_loops(new_loops, true);
+}
 
-			append_loop(vtx_type(x, y));			
-			set_loop_color(li, clr_type(r, g, b));
+/// replace loops after vertices have been replaced, optionally compute loop orientations and emit on_new_polygon
+void polygon::assign_loops(std::vector<polygon_loop>& new_loops, bool update_orientations)
+{
+	loops.swap(new_loops);
+	new_loops.clear();
+	size_t first_vertex = 0;
+	for (size_t li = 0; li < loops.size(); ++li) {
+		loops[li].first_vertex = first_vertex;
+		first_vertex += loops[li].nr_vertices;
+	}
+	assert(first_vertex == vertices.size());
+	update_loop_offsets();
+	if (batch_depth > 0)
+		batch_loop_flags.assign(loops.size(), 0);
+	for (size_t li = 0; li < loops.size(); ++li) {
+		// areas of loops with given orientations are computed on demand, such that mapped vertices are only paged in on access
+		loops[li].area_error = 0;
+		loops[li].area = update_orientations ? compute_area(li, &loops[li].area_error) : std::numeric_limits<double>::quiet_NaN();
+		loops[li].area_undecided = std::abs(loops[li].area) <= loops[li].area_error;
+		loops[li].nr_area_updates = 0;
+		if (update_orientations)
+			loops[li].orientation = compute_orientation(li);
+	}
+	on_new_polygon();
+}
 
-			for (size_t vi = 1; vi < nr_vertices; ++vi) {
-				is.getline(buffer, 1024);
-				str = std::string(buffer);
-				std::stringstream ss(str);
+/// copy loops and vertices into the snapshot
+void polygon::take_snapshot(polygon_snapshot& snapshot) const
+{
+	snapshot.loops = loops;
+	snapshot.vertices.resize(nr_vertices());
+	if (nr_vertices() > 0)
+		copy_vertices(0, nr_vertices(), &snapshot.vertices[0]);
+}
 
-				ss >> x >> y;
-				if (is.fail())
-					return false;
+/// replace polygon by the loops and vertices of the snapshot, which is left empty, keep the loop orientations of the snapshot and emit on_new_polygon
+void polygon::assign_snapshot(polygon_snapshot& snapshot)
+{
+	clear();
+	vertices.assign(snapshot.vertices);
+	assign_loops(snapshot.loops, false);
+}
 
-				size_t vtx_idx = append_vertex_to_loop(vtx_type(x, y));
-			}
-			if (closed != 0)
-				close_loop(li);
-		}
-	}
+/// read polygon from text file
+bool polygon::read(const std::string& file_name)
+{
+	std::vector<polygon_loop> new_loops;
+	std::vector<vtx_type> new_vertices;
+	polygon_stream stream;
+	bool success = stream.read_text(file_name, [&](const polygon_chunk& chunk) {
+		if (chunk.begins_loop)
+			new_loops.push_back(polygon_loop(chunk.first_vertex, 0, chunk.color));
+		new_loops.back().nr_vertices += chunk.nr_vertices;
+		new_loops.back().is_closed = chunk.is_closed;
+		new_vertices.insert(new_vertices.end(), chunk.vertices, chunk.vertices + chunk.nr_vertices);
+		return true;
+	});
+	last_error = stream.get_last_error();
+	if (!success)
+		return false;
+	assign(new_loops, new_vertices);
 	return true;
 }
 
+/// return description of the last error in read
+const std::string& polygon::get_last_error() const
+{
+	return last_error;
+}
+
 /// write polygon to text file
 bool polygon::write(const std::string& file_name) const
 {
 	if (nr_loops() == 0)
 		return false;
 
-	std::ofstream os(file_name);
+	std::ofstream os(file_name, std::ios::binary);
 	if (os.fail())
 		return false;
+	text_writer tw(os);
 
-	// check for simple format
-	if (nr_loops() == 1 && loop_closed(0) && int(loop_color(0).R()) != 0 && int(loop_color(0).B()) != 0 && int(loop_color(0).G()) != 0) {
+	// the simple format stores a single closed loop with the default color black
+	if (nr_loops() == 1 && loop_closed(0) && int(loop_color(0).R()) == 0 && int(loop_color(0).G()) == 0 && int(loop_color(0).B()) == 0) {
 		for (size_t vi = 0; vi < nr_vertices(); ++vi)
-			os << vertex(vi) << std::endl;
-		return true;
+			tw.put(vertex(vi));
 	}
-
 	// format including loops
-	os << nr_loops() << std::endl;
+	else {
+		tw.put(nr_loops());
+		tw.put_char('\n');
+		for (size_t li = 0; li < nr_loops(); ++li) {
+			tw.put(loop_size(li));
+			tw.put_char(' ');
+			tw.put(loop_closed(li) ? 1 : 0);
+			for (unsigned ci = 0; ci < 3; ++ci) {
+				tw.put_char(' ');
+				tw.put(int(loop_color(li)[ci]));
+			}
+			tw.put_char('\n');
+			for (size_t vi = loop_begin(li); vi < loop_end(li); ++vi)
+				tw.put(vertex(vi));
+		}
+	}
+	tw.flush();
+	return !os.fail();
+}
+
+/// replace polygon by the one stored in a binary file, whose vertex block is mapped into memory and used as vertex storage until the first modification
+bool polygon::read_binary(const std::string& file_name)
+{
+	last_error.clear();
+	std::shared_ptr<mapped_file> file(new mapped_file());
+	if (!file->open(file_name)) {
+		last_error = "could not map " + file_name;
+		return false;
+	}
+	if (file->size() < sizeof(binary_polygon_header)) {
+		last_error = file_name + " is too small for a binary polygon file";
+		return false;
+	}
+	binary_polygon_header header;
+	std::memcpy(&header, file->data(), sizeof(header));
+	std::string error;
+	if (!validate_binary_polygon_header(header, file->size(), error)) {
+		last_error = file_name + error;
+		return false;
+	}
+	std::vector<polygon_loop> new_loops;
+	new_loops.reserve(size_t(header.nr_loops));
+	const char* table = file->data() + sizeof(binary_polygon_header);
+	uint64_t first_vertex = 0;
+	for (size_t li = 0; li < header.nr_loops; ++li) {
+		binary_polygon_loop bl;
+		std::memcpy(&bl, table + li*sizeof(binary_polygon_loop), sizeof(bl));
+		if (!validate_binary_polygon_loop(bl, first_vertex, header.nr_vertices)) {
+			last_error = file_name + ": invalid entry of loop " + std::to_string(li);
+			return false;
+		}
+		new_loops.push_back(polygon_loop(size_t(bl.first_vertex), size_t(bl.nr_vertices), clr_type(bl.color[0], bl.color[1], bl.color[2]), bl.is_closed != 0));
+		new_loops.back().orientation = PolygonOrientation(bl.orientation);
+		first_vertex += bl.nr_vertices;
+	}
+	if (first_vertex != header.nr_vertices) {
+		last_error = file_name + ": loops do not cover all vertices";
+		return false;
+	}
+	// orientations are taken from the loop table such that vertices are only paged in on access
+	clear();
+	vertices.map(file, size_t(header.vertex_offset), size_t(header.nr_vertices));
+	assign_loops(new_loops, false);
+	return true;
+}
+
+/// write polygon to binary file
+bool polygon::write_binary(const std::string& file_name) const
+{
+	// the vertices can be mapped from the target file, which must not be truncated while they are read, such that a temporary file replaces the target after writing
+	std::string tmp_file_name = file_name + ".tmp";
+	std::ofstream os(tmp_file_name, std::ios::binary);
+	if (os.fail())
+		return false;
+	binary_polygon_header header;
+	init_binary_polygon_header(header);
+	header.nr_loops = nr_loops();
+	header.nr_vertices = nr_vertices();
+	// align vertex block to 8 bytes
+	header.vertex_offset = (sizeof(binary_polygon_header) + nr_loops()*sizeof(binary_polygon_loop) + 7) / 8 * 8;
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
 	for (size_t li = 0; li < nr_loops(); ++li) {
-		os << loop_size(li) << " " << (loop_closed(li) ? 1 : 0) << " " << int(loop_color(li).R()) << " " << int(loop_color(li).G()) << " " << int(loop_color(li).B()) << std::endl;
-		for (size_t vi = loop_begin(li); vi < loop_end(li); ++vi)
-			os << vertex(vi) << std::endl;
+		binary_polygon_loop bl;
+		std::memset(&bl, 0, sizeof(bl));
+		bl.first_vertex = loop_begin(li);
+		bl.nr_vertices = loop_size(li);
+		for (unsigned ci = 0; ci < 3; ++ci)
+			bl.color[ci] = loop_color(li)[ci];
+		bl.is_closed = loop_closed(li) ? 1 : 0;
+		bl.orientation = uint8_t(loop_orientation(li));
+		os.write(reinterpret_cast<const char*>(&bl), sizeof(bl));
+	}
+	static const char zeros[8] = { 0 };
+	os.write(zeros, std::streamsize(header.vertex_offset - sizeof(binary_polygon_header) - nr_loops()*sizeof(binary_polygon_loop)));
+	if (vertex_data())
+		os.write(reinterpret_cast<const char*>(vertex_data()), std::streamsize(nr_vertices()*sizeof(vtx_type)));
+	else {
+		// gather chunked vertices block by block
+		std::vector<vtx_type> block(vertex_storage::chunk_size);
+		for (size_t vi = 0; vi < nr_vertices(); vi += block.size()) {
+			size_t n = std::min(block.size(), nr_vertices() - vi);
+			copy_vertices(vi, vi + n, &block[0]);
+			os.write(reinterpret_cast<const char*>(&block[0]), std::streamsize(n*sizeof(vtx_type)));
+		}
+	}
+	os.close();
+	if (os.fail()) {
+		std::remove(tmp_file_name.c_str());
+		return false;
+	}
+	// rename does not replace existing files on all platforms
+	if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+		std::remove(file_name.c_str());
+		if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+			std::remove(tmp_file_name.c_str());
+			return false;
+		}
 	}
 	return true;
 }
@@ -208,6 +489,15 @@ PolygonOrientation polygon::loop_orientation(size_t loop_idx) const
 	return loops[loop_idx].orientation; 
 }
 
+/// return signed area enclosed by a closed loop or 0 for open loops
+double polygon::loop_area(size_t loop_idx) const
+{
+	validate_loop_index(loop_idx);
+	if (!loops[loop_idx].is_closed)
+		return 0;
+	return std::isnan(loops[loop_idx].area) ? compute_area(loop_idx) : loops[loop_idx].area;
+}
+
 /// return whether given loop is closed
 bool polygon::loop_closed(size_t loop_idx) const 
 {
@@ -227,7 +517,7 @@ void polygon::set_loop_color(size_t loop_idx, const clr_type& clr)
 {
 	validate_loop_index(loop_idx);
 	loops[loop_idx].color = clr;
-	on_change_loop(loop_idx, PLA_COLOR);
+	notify_loop_change(loop_idx, PLA_COLOR);
 }
 
 /// return the number of vertices in given loop
@@ -241,14 +531,14 @@ size_t polygon::loop_size(size_t loop_idx) const
 size_t polygon::loop_begin(size_t loop_idx) const 
 {
 	validate_loop_index(loop_idx); 
-	return loops[loop_idx].first_vertex;	
+	return loop_offsets.prefix_sum(loop_idx);
 }
 
 /// return end of loop vertex index
 size_t polygon::loop_end(size_t loop_idx) const 
 {
 	validate_loop_index(loop_idx); 
-	return loops[loop_idx].first_vertex + loops[loop_idx].nr_vertices; 
+	return loop_begin(loop_idx) + loops[loop_idx].nr_vertices; 
 }
 
 /// try to close given loop and return whether this was successful
@@ -259,13 +549,7 @@ bool polygon::close_loop(size_t loop_idx) {
 	if (loops[loop_idx].nr_vertices < 3)
 		return false;
 	loops[loop_idx].is_closed = true;
-	int flags = PLA_CLOSED;
-	PolygonOrientation po_new = compute_orientation(loop_idx);
-	if (po_new != loops[loop_idx].orientation) {
-		loops[loop_idx].orientation = po_new;
-		flags += PLA_ORIENTATION;
-	}
-	on_change_loop(loop_idx, flags);
+	notify_loop_change(loop_idx, PLA_CLOSED | update_orientation(loop_idx));
 	return true;
 }
 
@@ -275,12 +559,7 @@ void polygon::open_loop(size_t loop_idx)
 	validate_loop_index(loop_idx);
 	if (loops[loop_idx].is_closed) {
 		loops[loop_idx].is_closed = false;
-		int flags = PLA_CLOSED;
-		if (loops[loop_idx].orientation != PO_UNDEF) {
-			loops[loop_idx].orientation = PO_UNDEF;
-			flags += PLA_ORIENTATION;
-		}
-		on_change_loop(loop_idx, flags);
+		notify_loop_change(loop_idx, PLA_CLOSED | update_orientation(loop_idx));
 	}
 }
 
@@ -290,7 +569,10 @@ size_t polygon::append_loop(const vtx_type& vtx)
 	size_t vtx_idx = vertices.size();
 	polygon_loop loop(vtx_idx, 1);
 	loops.push_back(loop);
+	loop_offsets.push_back(1);
 	vertices.push_back(vtx);
+	if (batch_depth > 0)
+		batch_loop_flags.push_back(0);
 	after_insert_loop(nr_loops()-1);
 	after_insert_vertex(vtx_idx);
 	return vtx_idx;
@@ -302,10 +584,11 @@ void polygon::remove_loop(size_t loop_idx)
 	validate_loop_index(loop_idx);
 	before_remove_loop(loop_idx);
 	before_remove_vertex_range(loop_begin(loop_idx), loop_end(loop_idx));
-	vertices.erase(vertices.begin() + loop_begin(loop_idx), vertices.begin() + loop_end(loop_idx));
-	for (size_t li = loop_idx + 1; li < loops.size(); ++li)
-		loops[li].first_vertex -= loop_size(loop_idx);
+	batch_remove_vertex_range(loop_begin(loop_idx), loop_end(loop_idx));
+	vertices.erase(loop_begin(loop_idx), loop_end(loop_idx));
 	loops.erase(loops.begin() + loop_idx);
+	batch_remove_loop(loop_idx);
+	update_loop_offsets();
 }
 
 /// return number of vertices
@@ -321,19 +604,48 @@ const polygon::vtx_type& polygon::vertex(size_t vtx_idx) const
 	return vertices[vtx_idx]; 
 }
 
+/// return pointer to all vertices if stored contiguously and 0 otherwise
+const polygon::vtx_type* polygon::vertex_data() const
+{
+	return vertices.data();
+}
+
+/// copy vertex range [begin,end) to dst
+void polygon::copy_vertices(size_t begin, size_t end, vtx_type* dst) const
+{
+	assert(begin <= end && end <= nr_vertices());
+	vertices.copy(begin, end, dst);
+}
+
 /// set new vertex location
 void polygon::set_vertex(size_t vtx_idx, const vtx_type& vtx, bool update_orientation)
 { 
 	validate_vertex_index(vtx_idx);
-	vertices[vtx_idx] = vtx;
+	before_change_vertex(vtx_idx);
+	// replace the terms of the two incident edges in the loop area
+	size_t loop_idx = find_loop(vtx_idx);
+	const vtx_type& p0 = vertex(prev_loop_vertex(loop_idx, vtx_idx));
+	const vtx_type& p1 = vertex(next_loop_vertex(loop_idx, vtx_idx));
+	double old_terms = edge_term(p0, vertex(vtx_idx)) + edge_term(vertex(vtx_idx), p1);
+	double new_terms = edge_term(p0, vtx) + edge_term(vtx, p1);
+	vertices.set(vtx_idx, vtx);
+	update_area(loop_idx, 0.5*(new_terms - old_terms), 0.5*(std::abs(old_terms) + std::abs(new_terms)));
+	if (batch_depth > 0) {
+		if (batch_vtx_begin >= batch_vtx_end) {
+			batch_vtx_begin = vtx_idx;
+			batch_vtx_end = vtx_idx + 1;
+		}
+		else {
+			batch_vtx_begin = std::min(batch_vtx_begin, vtx_idx);
+			batch_vtx_end = std::max(batch_vtx_end, vtx_idx + 1);
+		}
+		return;
+	}
 	on_change_vertex(vtx_idx);
 	if (update_orientation) {
-		size_t loop_idx = find_loop(vtx_idx);
-		PolygonOrientation new_po = compute_orientation(loop_idx);
-		if (new_po != loops[loop_idx].orientation) {
-			loops[loop_idx].orientation = new_po;
-			on_change_loop(loop_idx, PLA_ORIENTATION);
-		}
+		int flags = this->update_orientation(loop_idx);
+		if (flags != 0)
+			notify_loop_change(loop_idx, flags);
 	}
 }
 
@@ -341,12 +653,14 @@ void polygon::set_vertex(size_t vtx_idx, const vtx_type& vtx, bool update_orient
 size_t polygon::find_loop(size_t vtx_idx) const
 {
 	validate_vertex_index(vtx_idx);
-	for (size_t li = 0; li < nr_loops(); ++li)
-		if (vtx_idx >= loop_begin(li) && vtx_idx < loop_end(li))
-			return li;
+	// successive queries typically address the same loop, e.g. while dragging
+	if (last_found_loop < nr_loops() && vtx_idx >= loop_begin(last_found_loop) && vtx_idx < loop_end(last_found_loop))
+		return last_found_loop;
+	// search the loop whose vertex range contains the vertex in the prefix sums of the loop sizes
+	last_found_loop = loop_offsets.find(vtx_idx);
 	// not found!!! should never happen
-	assert(0);
-	return size_t(-1);
+	assert(last_found_loop < nr_loops());
+	return last_found_loop;
 }
 
 /// append a new vertex to the given loop and return its index; if no loops exist, create new loop, if no loop is specified append vertex to last loop
@@ -358,68 +672,69 @@ size_t polygon::append_vertex_to_loop(const vtx_type& vtx, size_t loop_idx)
 		loop_idx = nr_loops() - 1;
 	validate_loop_index(loop_idx);
 	size_t vtx_idx = loop_end(loop_idx);
-	if (vtx_idx == vertices.size())
-		vertices.push_back(vtx);
-	else
-		vertices.insert(vertices.begin()+vtx_idx, vtx);
-	after_insert_vertex(vtx_idx);
+	// new vertex splits the edge from the last to the first vertex
+	const vtx_type& p0 = vertex(vtx_idx - 1);
+	const vtx_type& p1 = vertex(loop_begin(loop_idx));
+	double old_term = edge_term(p0, p1);
+	double new_terms = edge_term(p0, vtx) + edge_term(vtx, p1);
+	vertices.insert(vtx_idx, vtx);
 	++loops[loop_idx].nr_vertices;
-	on_change_loop(loop_idx, PLA_SIZE);
-	for (size_t li = loop_idx + 1; li < nr_loops(); ++li) {
-		++loops[li].first_vertex;
-		on_change_loop(li, PLA_BEGIN);
-	}
+	loop_offsets.add(loop_idx, 1);
+	update_area(loop_idx, 0.5*(new_terms - old_term), 0.5*(std::abs(old_term) + std::abs(new_terms)));
+	batch_insert_vertex(vtx_idx);
+	after_insert_vertex(vtx_idx);
+	notify_loop_change(loop_idx, PLA_SIZE | update_orientation(loop_idx));
 	return vtx_idx;
 }
 
 /// insert a new vertex before the given vertex
 void polygon::insert_vertex(const vtx_type& vtx, size_t vtx_idx) 
 {
-	validate_vertex_index(vtx_idx);
-	// add vertex
-	if (vtx_idx == vertices.size())
-		vertices.push_back(vtx);
-	else
-		vertices.insert(vertices.begin()+vtx_idx, vtx);
+	// new vertex belongs to the loop of the vertex it is inserted before
+	size_t loop_idx = find_loop(vtx_idx);
+	// new vertex splits the edge ending in the given vertex
+	const vtx_type& p0 = vertex(prev_loop_vertex(loop_idx, vtx_idx));
+	const vtx_type& p1 = vertex(vtx_idx);
+	double old_term = edge_term(p0, p1);
+	double new_terms = edge_term(p0, vtx) + edge_term(vtx, p1);
+	vertices.insert(vtx_idx, vtx);
+	// update loop before announcing the new vertex such that it can be located in its loop
+	++loops[loop_idx].nr_vertices;
+	loop_offsets.add(loop_idx, 1);
+	update_area(loop_idx, 0.5*(new_terms - old_term), 0.5*(std::abs(old_term) + std::abs(new_terms)));
+	batch_insert_vertex(vtx_idx);
 	after_insert_vertex(vtx_idx);
-	// update loops
-	for (size_t li = 0; li < nr_loops(); ++li)
-		if (loop_begin(li) > vtx_idx) {
-			++loops[li].first_vertex;
-			on_change_loop(li, PLA_BEGIN);
-		}
-		else if (loop_end(li) > vtx_idx) {
-			++loops[li].nr_vertices;
-			on_change_loop(li, PLA_SIZE);
-		}
+	notify_loop_change(loop_idx, PLA_SIZE | update_orientation(loop_idx));
 }
 
 /// remove a vertex, if loop size decreases to 2, loop is marked as open; if loop size decreases to 0, loop is removed
 void polygon::remove_vertex(size_t vtx_idx) 
 {
-	validate_vertex_index(vtx_idx);
+	size_t loop_idx = find_loop(vtx_idx);
+	// edges incident to the vertex are replaced by one edge
+	const vtx_type& p0 = vertex(prev_loop_vertex(loop_idx, vtx_idx));
+	const vtx_type& p1 = vertex(next_loop_vertex(loop_idx, vtx_idx));
+	double old_terms = edge_term(p0, vertex(vtx_idx)) + edge_term(vertex(vtx_idx), p1);
+	double new_term = edge_term(p0, p1);
 	// remove vertex
 	before_remove_vertex(vtx_idx);
-	vertices.erase(vertices.begin()+vtx_idx);
-	// update loops
-	for (size_t li = 0; li < nr_loops(); ++li)
-		if (loop_begin(li) > vtx_idx) {
-			--loops[li].first_vertex;
-			on_change_loop(li, PLA_BEGIN);
-		}
-		else if (loop_end(li) > vtx_idx) {
-			if (loop_size(li) == 1) {
-				before_remove_loop(li);
-				loops.erase(loops.begin() + li);
-				--li;
-			}
-			else {
-				int flags = PLA_SIZE;
-				if (--loops[li].nr_vertices < 3) {
-					loops[li].is_closed = false;
-					flags += PLA_CLOSED;
-				}
-				on_change_loop(li, flags);
-			}
+	batch_remove_vertex_range(vtx_idx, vtx_idx + 1);
+	vertices.erase(vtx_idx, vtx_idx + 1);
+	// update loop
+	if (loop_size(loop_idx) == 1) {
+		before_remove_loop(loop_idx);
+		loops.erase(loops.begin() + loop_idx);
+		batch_remove_loop(loop_idx);
+		update_loop_offsets();
+	}
+	else {
+		int flags = PLA_SIZE;
+		loop_offsets.add(loop_idx, -1);
+		if (--loops[loop_idx].nr_vertices < 3) {
+			loops[loop_idx].is_closed = false;
+			flags += PLA_CLOSED;
 		}
+		update_area(loop_idx, 0.5*(new_term - old_terms), 0.5*(std::abs(old_terms) + std::abs(new_term)));
+		notify_loop_change(loop_idx, flags | update_orientation(loop_idx));
+	}
 }
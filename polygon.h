@@ -1,10 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <cgv/math/fvec.h>
 #include <cgv/media/axis_aligned_box.h>
 #include <cgv/media/color.h>
 #include <cgv/signal/signal.h>
+#include "vertex_storage.h"
+#include "fenwick_tree.h"
 
 /// different polygon orientations (counter clock wise vs clock wise)
 enum PolygonOrientation
@@ -26,16 +29,25 @@ struct polygon_types
 struct polygon_loop : public polygon_types
 {
 	PolygonOrientation orientation;
+	/// index of first vertex, which polygon does not maintain for its own loops as it derives loop begins from the loop sizes
 	size_t first_vertex;
 	size_t nr_vertices;
 	clr_type color;
 	bool is_closed;
+	/// signed area of the loop treated as closed, positive for counter clockwise loops; polygon updates it incrementally and sets it to NaN if it has not been computed yet
+	double area;
+	/// bound on the rounding error of the exact computation and the incremental area updates since, where closed loops whose area does not exceed it have undefined orientation
+	double area_error;
+	/// number of incremental area updates since the last exact computation
+	size_t nr_area_updates;
+	/// whether the last exact computation could not decide the sign of the area, such that further undecided updates wait for the next scheduled recomputation
+	bool area_undecided;
 
 	/// constuct loop 
 	polygon_loop(size_t _fst_vtx, size_t _nr_vts, clr_type _clr = clr_type(0, 0, 0), bool _is_clsd = false);
 };
 
-/// flags for different attributes in a loop 
+/// flags for different attributes in a loop; begin changes implied by size changes of preceding loops are not signaled
 enum PolygonLoopAttributes
 {
 	PLA_ORIENTATION = 1,
@@ -45,6 +57,12 @@ enum PolygonLoopAttributes
 	PLA_CLOSED = 16
 };
 
+/// copy of the loops and vertices of a polygon, which is taken and restored in O(n) and can be handed to other threads
+struct polygon_snapshot : public polygon_types
+{
+	std::vector<polygon_loop> loops;
+	std::vector<vtx_type> vertices;
+};
 
 /// class to store and access a polygon that can contain several loops
 class polygon : public polygon_types
@@ -53,13 +71,49 @@ protected:
 	/// container to store loops
 	std::vector<polygon_loop> loops;
 	/// container to store vertices
-	std::vector<vtx_type> vertices;
+	vertex_storage vertices;
+	/// loop sizes used to compute loop begins and to locate the loop of a vertex in O(log(nr_loops()))
+	fenwick_tree loop_offsets;
+	/// loop index found in last call to find_loop, which is checked first in the next call
+	mutable size_t last_found_loop;
+	/// nesting depth of begin_batch calls
+	size_t batch_depth;
+	/// range of vertices moved during the current batch
+	size_t batch_vtx_begin, batch_vtx_end;
+	/// loop attribute flags collected during the current batch
+	std::vector<int> batch_loop_flags;
+	/// description of the last error in read
+	std::string last_error;
+	/// replace loops and vertices in bulk, where first vertices of loops are recomputed from loop sizes; compute loop orientations and emit on_new_polygon
+	void assign(std::vector<polygon_loop>& new_loops, std::vector<vtx_type>& new_vertices);
+	/// replace loops after vertices have been replaced, optionally compute loop orientations and emit on_new_polygon
+	void assign_loops(std::vector<polygon_loop>& new_loops, bool update_orientations);
+	/// emit on_change_loop or collect flags in case of batch
+	void notify_loop_change(size_t loop_idx, int flags);
+	/// keep batch vertex range valid after insertion of a vertex
+	void batch_insert_vertex(size_t vtx_idx);
+	/// keep batch vertex range valid after removal of vertices
+	void batch_remove_vertex_range(size_t vtx_begin, size_t vtx_end);
+	/// keep batch loop flags valid after removal of a loop
+	void batch_remove_loop(size_t loop_idx);
+	/// rebuild loop offsets after loops have been removed
+	void update_loop_offsets();
 	/// assert that loop index is within valid range
 	void validate_loop_index(size_t loop_idx) const;
 	/// assert that vertex index is within valid range
 	void validate_vertex_index(size_t vtx_idx) const;
-	///  function to compute the orientation of a loop
+	/// return predecessor of vertex within its loop, where also open loops are treated as cyclic
+	size_t prev_loop_vertex(size_t loop_idx, size_t vtx_idx) const;
+	/// return successor of vertex within its loop, where also open loops are treated as cyclic
+	size_t next_loop_vertex(size_t loop_idx, size_t vtx_idx) const;
+	/// compute signed area of loop treated as closed by summation over all edges in double precision and optionally a bound on its rounding error
+	double compute_area(size_t loop_idx, double* error_bound = 0) const;
+	/// add delta to loop area, where magnitude bounds the edge terms involved, and recompute it exactly after as many updates as the loop has vertices or if rounding errors could flip its sign, unless the last exact computation was undecided
+	void update_area(size_t loop_idx, double delta, double magnitude);
+	/// compute the orientation of a loop from the sign of its area, which is undefined for open loops and for closed loops whose area is within the rounding error bound
 	PolygonOrientation compute_orientation(size_t loop_idx) const;
+	/// set orientation of loop from its area and return PLA_ORIENTATION if it changed or 0 otherwise
+	int update_orientation(size_t loop_idx);
 public:
 	/// construct empty polygon
 	polygon();
@@ -67,26 +121,55 @@ public:
 	void generate_circle(size_t nr_vts);
 	/// remove all loops and all vertices
 	void clear();
+	/// return vertex storage mode
+	VertexStorageMode get_vertex_storage_mode() const;
+	/// convert vertex storage, where chunked storage supports vertex insertion and removal in O(log(nr_vertices())) for large polygons
+	void set_vertex_storage_mode(VertexStorageMode mode);
 	/// compute axis aligned bounding box of vertices
 	box_type compute_box() const;
 	/// center and scale polygon into box [-1,1]^2
 	void center_and_scale_to_unit_box();
-	/// read polygon from text file
+	/// replace polygon by the one read from a text file with the block parser of polygon_stream; on failure the polygon is left unchanged and get_last_error() describes the problem
 	bool read(const std::string& file_name);
-	/// write polygon to text file
+	/// replace polygon by the one stored in a binary file, which is mapped into memory such that loading is bounded by page-in speed; the vertex block is used as read only vertex storage until the first modification copies it
+	bool read_binary(const std::string& file_name);
+	/// write polygon to binary file composed of a header (magic "ECGPOLY", version, byte order mark 0x01020304, number of loops, number of vertices and offset of vertex block), a loop table with 24 bytes per loop (first vertex, number of vertices, rgb color, closed flag and orientation) and a block of float32 xy pairs aligned to 8 bytes; the file is written under file_name + ".tmp" and renamed to replace the target, which can be the file the vertices are mapped from
+	bool write_binary(const std::string& file_name) const;
+	/// return description of the last error in read or read_binary, including the line number for text files
+	const std::string& get_last_error() const;
+	/// write polygon to text file through a large buffer with the shortest float representations that are read back exactly; a single closed black loop is written in the simple format
 	bool write(const std::string& file_name) const;
+	/// copy loops and vertices into the snapshot
+	void take_snapshot(polygon_snapshot& snapshot) const;
+	/// replace polygon by the loops and vertices of the snapshot, which is left empty, keep the loop orientations of the snapshot and emit on_new_polygon
+	void assign_snapshot(polygon_snapshot& snapshot);
+	/**@name batched edits, during which vertex location changes and loop attribute changes are collected and signaled once at the end; insertions and removals are still signaled immediately*/
+	//@{
+	/// start a batch, batches can be nested
+	void begin_batch();
+	/// end a batch, if outermost batch ends update orientations and emit on_change_vertex_range and on_change_loop for collected changes
+	void end_batch();
+	/// return whether a batch is active
+	bool in_batch() const;
+	//@}
 	/**@name signals used to inform about changes in the data structure*/
 	//@{
+	/// signal emitted after the polygon has been replaced in bulk, e.g. by read
+	cgv::signal::signal<> on_new_polygon;
 	/// signal emitted after a new loop has been inserted, the argument is index of new loop
 	cgv::signal::signal<size_t> after_insert_loop;
 	/// signal emitted when a loop attribute changes, the first argument is index of changed loop and the second specifies the changed attributes via flags from PolygonLoopAttributes
 	cgv::signal::signal<size_t, int> on_change_loop;
 	/// signal emitted before a loop is removed, the argument is index of to be removed loop
 	cgv::signal::signal<size_t> before_remove_loop;
-	/// signal emitted after a new vertex has been inserted, the argument is index of new vertex
+	/// signal emitted after a new vertex has been inserted and loops have been updated, the argument is index of new vertex
 	cgv::signal::signal<size_t> after_insert_vertex;
+	/// signal emitted before a vertex changes its location, the argument is index of to be changed vertex
+	cgv::signal::signal<size_t> before_change_vertex;
 	/// signal emitted when a vertex changed one of its coordinates, the argument is index of changed vertex
 	cgv::signal::signal<size_t> on_change_vertex;
+	/// signal emitted at the end of a batch in which vertices changed their location, the arguments are begin and end index of a vertex range containing all changed vertices
+	cgv::signal::signal<size_t, size_t> on_change_vertex_range;
 	/// signal emitted before a single vertex is removed, the argument is index of to be removed vertex
 	cgv::signal::signal<size_t> before_remove_vertex;
 	/// signal emitted before a range of vertices is removed, the arguments are begin and end index of to be removed vertex range
@@ -98,6 +181,8 @@ public:
 	size_t nr_loops() const;
 	/// return orientation
 	PolygonOrientation loop_orientation(size_t loop_idx) const;
+	/// return signed area enclosed by a closed loop, which is positive for counter clockwise loops, or 0 for open loops; the area is maintained in O(1) per vertex edit
+	double loop_area(size_t loop_idx) const;
 	/// return whether given loop is closed
 	bool loop_closed(size_t loop_idx) const;
 	/// return loop color
@@ -106,7 +191,7 @@ public:
 	void set_loop_color(size_t loop_idx, const clr_type& clr);
 	/// return the number of vertices in given loop
 	size_t loop_size(size_t loop_idx) const;
-	/// return index of first vertex of given loop
+	/// return index of first vertex of given loop in O(log(nr_loops()))
 	size_t loop_begin(size_t loop_idx) const;
 	/// return end of loop vertex index
 	size_t loop_end(size_t loop_idx) const;
@@ -126,15 +211,31 @@ public:
 	size_t nr_vertices() const;
 	/// read only access to given vertex 
 	const vtx_type& vertex(size_t vtx_idx) const;
-	/// set new vertex location
+	/// return pointer to all vertices if stored contiguously and 0 otherwise
+	const vtx_type* vertex_data() const;
+	/// copy vertex range [begin,end) to dst
+	void copy_vertices(size_t begin, size_t end, vtx_type* dst) const;
+	/// set new vertex location and update the loop area in O(1), orientation is updated at the end of a batch independent of update_orientation
 	void set_vertex(size_t vtx_idx, const vtx_type& vtx, bool update_orientation = true);
-	/// return loop index of given vertex
+	/// return loop index of given vertex in O(log(nr_loops()))
 	size_t find_loop(size_t vtx_idx) const;
 	/// append a new vertex to the given loop and return its index; if no loops exist, create new loop, if no loop is specified append vertex to last loop
 	size_t append_vertex_to_loop(const vtx_type& vtx, size_t loop_idx = size_t(-1));
-	/// insert a new vertex before the given vertex
+	/// insert a new vertex before the given vertex and update loop area and orientation
 	void insert_vertex(const vtx_type& vtx, size_t vtx_idx);
-	/// remove a vertex, if loop size decreases to 2, loop is marked as open; if loop size decreases to 0, loop is removed
+	/// remove a vertex and update loop area and orientation, if loop size decreases to 2, loop is marked as open; if loop size decreases to 0, loop is removed
 	void remove_vertex(size_t vtx_idx);
 	//@}
-};
\ No newline at end of file
+};
+
+/// guard that encloses its life time in a batch of polygon edits
+class polygon_batch
+{
+protected:
+	polygon& poly;
+public:
+	/// begin batch
+	polygon_batch(polygon& _poly);
+	/// end batch
+	~polygon_batch();
+};
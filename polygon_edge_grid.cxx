@@ -0,0 +1,396 @@
+#include "polygon_edge_grid.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/// return cell containing the given location, clamped to the grid
+polygon_edge_grid::cell_type polygon_edge_grid::cell_from_world(const vtx_type& p) const
+{
+	cell_type c;
+	for (int i = 0; i < 2; ++i) {
+		float x = std::floor((p(i) - origin(i))*inv_cell_size);
+		c(i) = x < 0 ? 0 : (x >= float(resolution(i)) ? resolution(i) - 1 : int(x));
+	}
+	return c;
+}
+
+/// return index of first vertex of edge ending in vtx_idx or size_t(-1) for the first vertex of an open loop
+size_t polygon_edge_grid::prev_vertex(size_t vtx_idx) const
+{
+	size_t loop_idx = poly.find_loop(vtx_idx);
+	size_t vbegin = poly.loop_begin(loop_idx);
+	if (vtx_idx > vbegin)
+		return vtx_idx - 1;
+	return poly.loop_closed(loop_idx) ? poly.loop_end(loop_idx) - 1 : size_t(-1);
+}
+
+/// return index of end vertex of edge starting at vtx_idx or size_t(-1) for the last vertex of an open loop
+size_t polygon_edge_grid::next_vertex(size_t vtx_idx) const
+{
+	size_t loop_idx = poly.find_loop(vtx_idx);
+	if (vtx_idx + 1 < poly.loop_end(loop_idx))
+		return vtx_idx + 1;
+	return poly.loop_closed(loop_idx) ? poly.loop_begin(loop_idx) : size_t(-1);
+}
+
+void polygon_edge_grid::insert_vertex(size_t vtx_idx)
+{
+	if (vertex_cell[vtx_idx] != -1)
+		return;
+	cell_type c = cell_from_world(poly.vertex(vtx_idx));
+	vertex_cell[vtx_idx] = c(1)*resolution(0) + c(0);
+	vertex_cells[vertex_cell[vtx_idx]].push_back(vtx_idx);
+}
+
+void polygon_edge_grid::remove_vertex(size_t vtx_idx)
+{
+	if (vertex_cell[vtx_idx] == -1)
+		return;
+	std::vector<size_t>& cell = vertex_cells[vertex_cell[vtx_idx]];
+	*std::find(cell.begin(), cell.end(), vtx_idx) = cell.back();
+	cell.pop_back();
+	vertex_cell[vtx_idx] = -1;
+}
+
+/// set cells to the indices of the cells crossed by the segment from p0 to p1 in the order of traversal, where parts outside of the grid are clamped to the border cells
+void polygon_edge_grid::collect_segment_cells(const vtx_type& p0, const vtx_type& p1, std::vector<int>& cells) const
+{
+	cells.clear();
+	// segment in continuous cell coordinates, which is split where it leaves or enters the grid along an axis such that clamping is linear on each piece
+	double a[2], d[2];
+	for (int i = 0; i < 2; ++i) {
+		a[i] = double(p0(i) - origin(i))*inv_cell_size;
+		d[i] = double(p1(i) - origin(i))*inv_cell_size - a[i];
+	}
+	double ts[6];
+	int nr_ts = 0;
+	ts[nr_ts++] = 0;
+	for (int i = 0; i < 2; ++i) {
+		if (d[i] == 0)
+			continue;
+		for (int bound = 0; bound < 2; ++bound) {
+			double t = (bound*resolution(i) - a[i]) / d[i];
+			if (t > 0 && t < 1)
+				ts[nr_ts++] = t;
+		}
+	}
+	ts[nr_ts++] = 1;
+	std::sort(ts, ts + nr_ts);
+	for (int k = 0; k + 1 < nr_ts; ++k) {
+		double q0[2], q1[2];
+		int c[2], c_end[2], step[2];
+		double t_max[2], t_delta[2];
+		for (int i = 0; i < 2; ++i) {
+			q0[i] = std::min(std::max(a[i] + ts[k] * d[i], 0.0), double(resolution(i)));
+			q1[i] = std::min(std::max(a[i] + ts[k + 1] * d[i], 0.0), double(resolution(i)));
+			c[i] = std::min(int(std::floor(q0[i])), resolution(i) - 1);
+			c_end[i] = std::min(int(std::floor(q1[i])), resolution(i) - 1);
+			step[i] = c_end[i] > c[i] ? 1 : (c_end[i] < c[i] ? -1 : 0);
+			t_max[i] = t_delta[i] = std::numeric_limits<double>::infinity();
+			if (step[i] != 0) {
+				double dq = q1[i] - q0[i];
+				t_delta[i] = step[i] / dq;
+				t_max[i] = ((step[i] > 0 ? c[i] + 1 : c[i]) - q0[i]) / dq;
+			}
+		}
+		// traverse cells in the order of crossing, where both neighbors are taken when the segment passes through a cell corner
+		int idx = c[1] * resolution(0) + c[0];
+		if (cells.empty() || cells.back() != idx)
+			cells.push_back(idx);
+		while (step[0] != 0 || step[1] != 0) {
+			const double eps = 1e-9;
+			int axis = t_max[0] < t_max[1] ? 0 : 1;
+			if (step[0] != 0 && step[1] != 0 && std::abs(t_max[0] - t_max[1]) < eps) {
+				cells.push_back(c[1] * resolution(0) + c[0] + step[0]);
+				cells.push_back((c[1] + step[1])*resolution(0) + c[0]);
+				for (int i = 0; i < 2; ++i) {
+					c[i] += step[i];
+					t_max[i] += t_delta[i];
+				}
+			}
+			else {
+				c[axis] += step[axis];
+				t_max[axis] += t_delta[axis];
+			}
+			for (int i = 0; i < 2; ++i)
+				if (c[i] == c_end[i]) {
+					step[i] = 0;
+					t_max[i] = std::numeric_limits<double>::infinity();
+				}
+			cells.push_back(c[1] * resolution(0) + c[0]);
+		}
+	}
+}
+
+/// store edge ending in vtx_idx in the cells crossed by the segment from p0 to p1 unless already stored
+void polygon_edge_grid::add_edge(size_t vtx_idx, const vtx_type& p0, const vtx_type& p1)
+{
+	if (edge_in_grid[vtx_idx])
+		return;
+	collect_segment_cells(p0, p1, segment_cells);
+	for (size_t i = 0; i < segment_cells.size(); ++i)
+		edge_cells[segment_cells[i]].push_back(vtx_idx);
+	edge_in_grid[vtx_idx] = 1;
+}
+
+/// remove edge ending in vtx_idx from the cells crossed by the segment from p0 to p1 it was stored with, if stored
+void polygon_edge_grid::erase_edge(size_t vtx_idx, const vtx_type& p0, const vtx_type& p1)
+{
+	if (!edge_in_grid[vtx_idx])
+		return;
+	collect_segment_cells(p0, p1, segment_cells);
+	for (size_t i = 0; i < segment_cells.size(); ++i) {
+		std::vector<size_t>& cell = edge_cells[segment_cells[i]];
+		*std::find(cell.begin(), cell.end(), vtx_idx) = cell.back();
+		cell.pop_back();
+	}
+	edge_in_grid[vtx_idx] = 0;
+}
+
+void polygon_edge_grid::insert_edge(size_t vtx_idx)
+{
+	if (vtx_idx == size_t(-1))
+		return;
+	size_t prev_idx = prev_vertex(vtx_idx);
+	if (prev_idx != size_t(-1))
+		add_edge(vtx_idx, poly.vertex(prev_idx), poly.vertex(vtx_idx));
+}
+
+void polygon_edge_grid::remove_edge(size_t vtx_idx)
+{
+	// the start vertex has not moved since the insertion because moves are announced before they happen
+	if (vtx_idx == size_t(-1))
+		return;
+	size_t prev_idx = prev_vertex(vtx_idx);
+	if (prev_idx != size_t(-1))
+		erase_edge(vtx_idx, poly.vertex(prev_idx), poly.vertex(vtx_idx));
+}
+
+/// add delta to all stored vertex indices that are at least vtx_idx
+void polygon_edge_grid::shift_indices(size_t vtx_idx, int delta)
+{
+	for (size_t ci = 0; ci < vertex_cells.size(); ++ci) {
+		for (size_t i = 0; i < vertex_cells[ci].size(); ++i)
+			if (vertex_cells[ci][i] >= vtx_idx)
+				vertex_cells[ci][i] += delta;
+		for (size_t i = 0; i < edge_cells[ci].size(); ++i)
+			if (edge_cells[ci][i] >= vtx_idx)
+				edge_cells[ci][i] += delta;
+	}
+}
+
+/// build grid with about one cell per vertex
+void polygon_edge_grid::rebuild()
+{
+	size_t n = poly.nr_vertices();
+	box_type box = poly.compute_box();
+	vertex_cells.clear();
+	edge_cells.clear();
+	vertex_cell.assign(n, -1);
+	edge_in_grid.assign(n, 0);
+	nr_built_vertices = n;
+	outofdate = false;
+	if (n == 0) {
+		resolution = cell_type(0, 0);
+		return;
+	}
+	vtx_type extent = box.get_extent();
+	float max_extent = std::max(extent(0), extent(1));
+	float cell_size = std::max(std::sqrt(extent(0)*extent(1) / n), max_extent / max_resolution);
+	if (cell_size <= 0)
+		cell_size = 1;
+	origin = box.get_min_pnt();
+	inv_cell_size = 1.0f / cell_size;
+	for (int i = 0; i < 2; ++i)
+		resolution(i) = std::min(std::max(int(std::ceil(extent(i)*inv_cell_size)), 1), int(max_resolution));
+	vertex_cells.resize(size_t(resolution(0))*resolution(1));
+	edge_cells.resize(vertex_cells.size());
+	for (size_t vi = 0; vi < n; ++vi) {
+		insert_vertex(vi);
+		insert_edge(vi);
+	}
+}
+
+void polygon_edge_grid::on_new_polygon()
+{
+	outofdate = true;
+}
+
+void polygon_edge_grid::on_change_loop(size_t loop_idx, int flags)
+{
+	// opening or closing a loop adds or removes its closing edge, which ends in the first vertex
+	if (outofdate || (flags & PLA_CLOSED) == 0)
+		return;
+	size_t vtx_begin = poly.loop_begin(loop_idx), vtx_last = poly.loop_end(loop_idx) - 1;
+	if (poly.loop_closed(loop_idx))
+		add_edge(vtx_begin, poly.vertex(vtx_last), poly.vertex(vtx_begin));
+	else
+		erase_edge(vtx_begin, poly.vertex(vtx_last), poly.vertex(vtx_begin));
+}
+
+void polygon_edge_grid::after_insert_vertex(size_t vtx_idx)
+{
+	// an empty grid or one whose cells are too coarse for the grown polygon is rebuilt
+	if (outofdate || vertex_cells.empty() || poly.nr_vertices() > 2 * nr_built_vertices) {
+		outofdate = true;
+		return;
+	}
+	shift_indices(vtx_idx, 1);
+	vertex_cell.insert(vertex_cell.begin() + vtx_idx, -1);
+	edge_in_grid.insert(edge_in_grid.begin() + vtx_idx, 0);
+	// the new vertex splits the edge between its neighbors
+	size_t prev_idx = prev_vertex(vtx_idx), next_idx = next_vertex(vtx_idx);
+	if (prev_idx != size_t(-1) && next_idx != size_t(-1))
+		erase_edge(next_idx, poly.vertex(prev_idx), poly.vertex(next_idx));
+	insert_vertex(vtx_idx);
+	insert_edge(vtx_idx);
+	insert_edge(next_idx);
+}
+
+void polygon_edge_grid::before_change_vertex(size_t vtx_idx)
+{
+	if (outofdate)
+		return;
+	remove_vertex(vtx_idx);
+	remove_edge(vtx_idx);
+	remove_edge(next_vertex(vtx_idx));
+}
+
+void polygon_edge_grid::on_change_vertex(size_t vtx_idx)
+{
+	if (outofdate)
+		return;
+	insert_vertex(vtx_idx);
+	insert_edge(vtx_idx);
+	insert_edge(next_vertex(vtx_idx));
+}
+
+void polygon_edge_grid::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	for (size_t vi = vtx_begin; vi < vtx_end; ++vi)
+		on_change_vertex(vi);
+}
+
+void polygon_edge_grid::before_remove_vertex(size_t vtx_idx)
+{
+	if (outofdate)
+		return;
+	size_t prev_idx = prev_vertex(vtx_idx), next_idx = next_vertex(vtx_idx);
+	remove_vertex(vtx_idx);
+	remove_edge(vtx_idx);
+	remove_edge(next_idx);
+	shift_indices(vtx_idx + 1, -1);
+	vertex_cell.erase(vertex_cell.begin() + vtx_idx);
+	edge_in_grid.erase(edge_in_grid.begin() + vtx_idx);
+	// the neighbors are connected by a new edge; if the loop is opened afterwards, its closing edge is removed in on_change_loop
+	if (prev_idx != size_t(-1) && next_idx != size_t(-1) && prev_idx != next_idx)
+		add_edge(next_idx > vtx_idx ? next_idx - 1 : next_idx, poly.vertex(prev_idx), poly.vertex(next_idx));
+}
+
+void polygon_edge_grid::before_remove_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	outofdate = true;
+}
+
+/// construct grid and connect to polygon signals
+polygon_edge_grid::polygon_edge_grid(polygon& _poly) : poly(_poly), outofdate(true), inv_cell_size(1), resolution(0, 0), nr_built_vertices(0)
+{
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_edge_grid::on_change_loop);
+	cgv::signal::connect(_poly.after_insert_vertex, this, &polygon_edge_grid::after_insert_vertex);
+	cgv::signal::connect(_poly.before_change_vertex, this, &polygon_edge_grid::before_change_vertex);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_edge_grid::on_change_vertex);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_edge_grid::on_change_vertex_range);
+	cgv::signal::connect(_poly.before_remove_vertex, this, &polygon_edge_grid::before_remove_vertex);
+	cgv::signal::connect(_poly.before_remove_vertex_range, this, &polygon_edge_grid::before_remove_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_edge_grid::on_new_polygon);
+}
+
+/// find closest polygon vertex to p that is less than max_dist appart
+size_t polygon_edge_grid::find_closest_vertex(const vtx_type& p, float max_dist)
+{
+	if (outofdate)
+		rebuild();
+	size_t vtx_idx = size_t(-1);
+	if (vertex_cells.empty())
+		return vtx_idx;
+	float min_dist = 0;
+	cell_type c0 = cell_from_world(p - vtx_type(max_dist, max_dist));
+	cell_type c1 = cell_from_world(p + vtx_type(max_dist, max_dist));
+	for (int y = c0(1); y <= c1(1); ++y)
+		for (int x = c0(0); x <= c1(0); ++x) {
+			const std::vector<size_t>& cell = vertex_cells[y*resolution(0) + x];
+			for (size_t ci = 0; ci < cell.size(); ++ci) {
+				size_t vi = cell[ci];
+				float dist = (poly.vertex(vi) - p).length();
+				if (dist > max_dist)
+					continue;
+				// prefer smaller vertex indices among equally close vertices like a linear scan
+				if (vtx_idx == size_t(-1) || dist < min_dist || (dist == min_dist && vi < vtx_idx)) {
+					min_dist = dist;
+					vtx_idx = vi;
+				}
+			}
+		}
+	return vtx_idx;
+}
+
+/// find closest polygon edge to p that is less than max_dist appart and set edge_point to closest point on found edge
+size_t polygon_edge_grid::find_closest_edge(const vtx_type& p, float max_dist, vtx_type& edge_point)
+{
+	if (outofdate)
+		rebuild();
+	size_t edge_insert_vtx_index = size_t(-1);
+	if (edge_cells.empty())
+		return edge_insert_vtx_index;
+	float min_dist = 0;
+	cell_type c0 = cell_from_world(p - vtx_type(max_dist, max_dist));
+	cell_type c1 = cell_from_world(p + vtx_type(max_dist, max_dist));
+	for (int y = c0(1); y <= c1(1); ++y)
+		for (int x = c0(0); x <= c1(0); ++x) {
+			const std::vector<size_t>& cell = edge_cells[y*resolution(0) + x];
+			for (size_t ci = 0; ci < cell.size(); ++ci) {
+				size_t vi = cell[ci];
+				// within a batch the closing edge of a loop opened by a vertex removal is only removed at the end
+				size_t prev_idx = prev_vertex(vi);
+				if (prev_idx == size_t(-1))
+					continue;
+				const vtx_type& p0 = poly.vertex(prev_idx);
+				const vtx_type& p1 = poly.vertex(vi);
+
+				// compute edge lambda and check that it is in [0,1]
+				vtx_type d = p1 - p0;
+				float lambda = dot(p - p0, d) / dot(d, d);
+				if (!(lambda > 0 && lambda < 1))
+					continue;
+
+				// compute projected point and check distance
+				vtx_type projected_point = p0 + lambda*d;
+				float dist = (projected_point - p).length();
+				if (!(dist < max_dist))
+					continue;
+				if (edge_insert_vtx_index == size_t(-1) || dist < min_dist || (dist == min_dist && vi < edge_insert_vtx_index)) {
+					min_dist = dist;
+					edge_insert_vtx_index = vi;
+					edge_point = projected_point;
+				}
+			}
+		}
+	return edge_insert_vtx_index;
+}
+
+/// append edges stored in the cells covered by the bounding box of the segment from p0 to p1, where edges spanning several cells can be appended more than once
+void polygon_edge_grid::collect_edges(const vtx_type& p0, const vtx_type& p1, std::vector<size_t>& edges)
+{
+	if (outofdate)
+		rebuild();
+	if (edge_cells.empty())
+		return;
+	cell_box_type cb;
+	cb.add_point(cell_from_world(p0));
+	cb.add_point(cell_from_world(p1));
+	for (int y = cb.get_min_pnt()(1); y <= cb.get_max_pnt()(1); ++y)
+		for (int x = cb.get_min_pnt()(0); x <= cb.get_max_pnt()(0); ++x) {
+			const std::vector<size_t>& cell = edge_cells[y*resolution(0) + x];
+			edges.insert(edges.end(), cell.begin(), cell.end());
+		}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "polygon.h"
+
+/// uniform grid over the vertices and edges of a polygon used to accelerate picking, where each edge is stored in the cells it crosses; vertex moves, insertions and removals of single vertices and opening or closing of loops are tracked incrementally through the polygon signals, while bulk changes and growth beyond twice the vertex count of the last build cause a rebuild before the next query
+class polygon_edge_grid : public cgv::signal::tacker, public polygon_types
+{
+public:
+	typedef cgv::math::fvec<int, 2> cell_type;
+	typedef cgv::media::axis_aligned_box<int, 2> cell_box_type;
+	/// maximum number of cells per axis
+	static const int max_resolution = 1024;
+protected:
+	const polygon& poly;
+	/// whether grid needs to be rebuilt before the next query
+	bool outofdate;
+	/// world space region covered by the grid, where cells at the border also store everything outside
+	vtx_type origin;
+	/// inverse of the cell extent
+	float inv_cell_size;
+	/// number of cells per axis
+	cell_type resolution;
+	/// vertex indices per cell
+	std::vector<std::vector<size_t> > vertex_cells;
+	/// edges per cell, each given by the index of its end vertex
+	std::vector<std::vector<size_t> > edge_cells;
+	/// cell of each vertex, -1 for vertices not in grid
+	std::vector<int> vertex_cell;
+	/// whether the edge ending in a vertex is stored in the cells crossed by the segment from its start vertex at the time of insertion, which remain valid as the signals announce vertex moves beforehand
+	std::vector<char> edge_in_grid;
+	/// number of vertices when the grid was built
+	size_t nr_built_vertices;
+	/// cells crossed by the current segment
+	std::vector<int> segment_cells;
+
+	/// return cell containing the given location, clamped to the grid
+	cell_type cell_from_world(const vtx_type& p) const;
+	/// return index of first vertex of edge ending in vtx_idx or size_t(-1) for the first vertex of an open loop
+	size_t prev_vertex(size_t vtx_idx) const;
+	/// return index of end vertex of edge starting at vtx_idx or size_t(-1) for the last vertex of an open loop
+	size_t next_vertex(size_t vtx_idx) const;
+	void insert_vertex(size_t vtx_idx);
+	void remove_vertex(size_t vtx_idx);
+	/// set cells to the indices of the cells crossed by the segment from p0 to p1 in the order of traversal, where parts outside of the grid are clamped to the border cells
+	void collect_segment_cells(const vtx_type& p0, const vtx_type& p1, std::vector<int>& cells) const;
+	/// store edge ending in vtx_idx in the cells crossed by the segment from p0 to p1 unless already stored
+	void add_edge(size_t vtx_idx, const vtx_type& p0, const vtx_type& p1);
+	/// remove edge ending in vtx_idx from the cells crossed by the segment from p0 to p1 it was stored with, if stored
+	void erase_edge(size_t vtx_idx, const vtx_type& p0, const vtx_type& p1);
+	void insert_edge(size_t vtx_idx);
+	void remove_edge(size_t vtx_idx);
+	/// add delta to all stored vertex indices that are at least vtx_idx
+	void shift_indices(size_t vtx_idx, int delta);
+	/// build grid with about one cell per vertex
+	void rebuild();
+
+	/// callbacks used to keep the grid up to date
+	void on_new_polygon();
+	void on_change_loop(size_t loop_idx, int flags);
+	void after_insert_vertex(size_t vtx_idx);
+	void before_change_vertex(size_t vtx_idx);
+	void on_change_vertex(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+	void before_remove_vertex(size_t vtx_idx);
+	void before_remove_vertex_range(size_t vtx_begin, size_t vtx_end);
+public:
+	/// construct grid and connect to polygon signals
+	polygon_edge_grid(polygon& _poly);
+	/// find closest polygon vertex to p that is less than max_dist appart
+	size_t find_closest_vertex(const vtx_type& p, float max_dist);
+	/// find closest polygon edge to p that is less than max_dist appart; return vertex index where edge point needs to be inserted and set edge_point to closest point on found edge
+	size_t find_closest_edge(const vtx_type& p, float max_dist, vtx_type& edge_point);
+	/// append edges stored in the cells covered by the bounding box of the segment from p0 to p1, where edges spanning several cells can be appended more than once
+	void collect_edges(const vtx_type& p0, const vtx_type& p1, std::vector<size_t>& edges);
+};
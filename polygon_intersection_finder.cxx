@@ -0,0 +1,407 @@
+#include "polygon_intersection_finder.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/// return z-component of the cross product of p1-p0 and p2-p0, which is exact for float coordinates of similar magnitude
+static double orientation(double x0, double y0, double x1, double y1, double x2, double y2)
+{
+	return (x1 - x0)*(y2 - y0) - (y1 - y0)*(x2 - x0);
+}
+
+/// return whether p0 is lexicographically smaller than p1
+static bool is_before(double x0, double y0, double x1, double y1)
+{
+	return x0 < x1 || (x0 == x1 && y0 < y1);
+}
+
+/// return whether the point p, which is collinear with the segment from p0 to p1, lies on this segment
+static bool is_on_segment(const polygon_types::vtx_type& p0, const polygon_types::vtx_type& p1, const polygon_types::vtx_type& p)
+{
+	return std::min(p0[0], p1[0]) <= p[0] && p[0] <= std::max(p0[0], p1[0]) &&
+		std::min(p0[1], p1[1]) <= p[1] && p[1] <= std::max(p0[1], p1[1]);
+}
+
+bool polygon_intersection_finder::segment_order::operator () (size_t s0, size_t s1) const
+{
+	if (s0 == s1)
+		return false;
+	double y0 = s0 == size_t(-1) ? finder->sweep_y : finder->segment_y(s0);
+	double y1 = s1 == size_t(-1) ? finder->sweep_y : finder->segment_y(s1);
+	if (y0 != y1)
+		return y0 < y1;
+	// segments through the event are ordered as behind it and the event itself below all of them
+	double k0 = s0 == size_t(-1) ? -std::numeric_limits<double>::infinity() : finder->segments[s0].slope;
+	double k1 = s1 == size_t(-1) ? -std::numeric_limits<double>::infinity() : finder->segments[s1].slope;
+	if (k0 != k1)
+		return k0 < k1;
+	return s0 < s1;
+}
+
+/// return y-coordinate of segment at the current event
+double polygon_intersection_finder::segment_y(size_t s) const
+{
+	// segments through the event use its exact location, as computed crossings are not exactly on them
+	if (through_event[s])
+		return sweep_y;
+	const segment_type& sg = segments[s];
+	if (sg.p0[0] == sg.p1[0])
+		return std::min(std::max(sweep_y, double(sg.p0[1])), double(sg.p1[1]));
+	if (sweep_x <= sg.p0[0])
+		return sg.p0[1];
+	if (sweep_x >= sg.p1[0])
+		return sg.p1[1];
+	return sg.p0[1] + (sweep_x - sg.p0[0])*sg.slope;
+}
+
+/// return whether two edges share a vertex at the given location
+bool polygon_intersection_finder::share_vertex_at(size_t edge0, size_t edge1, double x, double y) const
+{
+	if (edge_start(edge0) == edge1 && poly.vertex(edge1)[0] == x && poly.vertex(edge1)[1] == y)
+		return true;
+	return edge_start(edge1) == edge0 && poly.vertex(edge0)[0] == x && poly.vertex(edge0)[1] == y;
+}
+
+/// append intersection of two edges
+void polygon_intersection_finder::add_intersection(std::vector<polygon_intersection>& result, size_t edge0, size_t edge1, double x, double y) const
+{
+	polygon_intersection pi;
+	pi.edge0 = std::min(edge0, edge1);
+	pi.edge1 = std::max(edge0, edge1);
+	pi.location = vtx_type(float(x), float(y));
+	result.push_back(pi);
+}
+
+/// schedule crossing of two segments that are neighbors in the status, or report it immediately if it is not behind the current event
+void polygon_intersection_finder::check_crossing(size_t s0, size_t s1, std::vector<polygon_intersection>& result)
+{
+	// touching segments are found at the end point events, such that only proper crossings are scheduled
+	if (s0 > s1)
+		std::swap(s0, s1);
+	const segment_type& a = segments[s0];
+	const segment_type& b = segments[s1];
+	double o0 = orientation(a.p0[0], a.p0[1], a.p1[0], a.p1[1], b.p0[0], b.p0[1]);
+	double o1 = orientation(a.p0[0], a.p0[1], a.p1[0], a.p1[1], b.p1[0], b.p1[1]);
+	if (!((o0 < 0 && o1 > 0) || (o0 > 0 && o1 < 0)))
+		return;
+	double o2 = orientation(b.p0[0], b.p0[1], b.p1[0], b.p1[1], a.p0[0], a.p0[1]);
+	double o3 = orientation(b.p0[0], b.p0[1], b.p1[0], b.p1[1], a.p1[0], a.p1[1]);
+	if (!((o2 < 0 && o3 > 0) || (o2 > 0 && o3 < 0)))
+		return;
+	double t = o2 / (o2 - o3);
+	crossing_type c;
+	c.x = a.p0[0] + t*(double(a.p1[0]) - a.p0[0]);
+	c.y = a.p0[1] + t*(double(a.p1[1]) - a.p0[1]);
+	c.s0 = s0;
+	c.s1 = s1;
+	// rounding can place crossings close to the event at or before it
+	if (!is_before(sweep_x, sweep_y, c.x, c.y)) {
+		add_intersection(result, a.edge, b.edge, c.x, c.y);
+		return;
+	}
+	crossings.push_back(c);
+	std::push_heap(crossings.begin(), crossings.end());
+}
+
+/// test edges incident to the moved vertices again against the edges found in the grid
+void polygon_intersection_finder::update_moved_vertices(polygon_edge_grid& grid)
+{
+	std::vector<size_t> edges;
+	for (size_t vi : moved_vertices) {
+		if (edge_start(vi) != size_t(-1))
+			edges.push_back(vi);
+		size_t next = edge_end(vi);
+		if (next != size_t(-1) && edge_start(next) != size_t(-1))
+			edges.push_back(next);
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	auto is_moved = [&edges](size_t edge) { return std::binary_search(edges.begin(), edges.end(), edge); };
+	intersections.erase(std::remove_if(intersections.begin(), intersections.end(),
+		[&](const polygon_intersection& pi) { return is_moved(pi.edge0) || is_moved(pi.edge1); }), intersections.end());
+	size_t nr_kept = intersections.size();
+	for (size_t edge : edges) {
+		size_t vi = edge_start(edge);
+		candidate_edges.clear();
+		grid.collect_edges(poly.vertex(vi), poly.vertex(edge), candidate_edges);
+		std::sort(candidate_edges.begin(), candidate_edges.end());
+		candidate_edges.erase(std::unique(candidate_edges.begin(), candidate_edges.end()), candidate_edges.end());
+		vtx_type location;
+		for (size_t other : candidate_edges) {
+			// pairs of moved edges are tested once
+			if (other == edge || (other < edge && is_moved(other)))
+				continue;
+			if (intersect_edges(edge, other, location))
+				add_intersection(intersections, edge, other, location[0], location[1]);
+		}
+	}
+	// kept intersections stay sorted, such that only the new ones need to be sorted and merged
+	auto edge_pair_less = [](const polygon_intersection& pi0, const polygon_intersection& pi1) {
+		return pi0.edge0 < pi1.edge0 || (pi0.edge0 == pi1.edge0 && pi0.edge1 < pi1.edge1);
+	};
+	std::sort(intersections.begin() + nr_kept, intersections.end(), edge_pair_less);
+	std::inplace_merge(intersections.begin(), intersections.begin() + nr_kept, intersections.end(), edge_pair_less);
+}
+
+void polygon_intersection_finder::on_structure_change(size_t)
+{
+	outofdate = true;
+}
+
+void polygon_intersection_finder::on_new_polygon()
+{
+	outofdate = true;
+}
+
+void polygon_intersection_finder::on_change_loop(size_t loop_idx, int flags)
+{
+	// opening or closing a loop adds or removes its closing edge
+	if ((flags & PLA_CLOSED) != 0)
+		outofdate = true;
+}
+
+void polygon_intersection_finder::on_change_vertex(size_t vtx_idx)
+{
+	if (outofdate)
+		return;
+	moved_vertices.push_back(vtx_idx);
+	// testing many edges through the grid is slower than a new sweep
+	if (moved_vertices.size() > poly.nr_vertices() / 16 + 16) {
+		outofdate = true;
+		moved_vertices.clear();
+	}
+}
+
+void polygon_intersection_finder::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	for (size_t vi = vtx_begin; vi < vtx_end && !outofdate; ++vi)
+		on_change_vertex(vi);
+}
+
+void polygon_intersection_finder::before_remove_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	outofdate = true;
+}
+
+/// construct finder and connect to polygon signals
+polygon_intersection_finder::polygon_intersection_finder(polygon& _poly) : poly(_poly), outofdate(true), sweep_x(0), sweep_y(0), status(segment_order{ this })
+{
+	cgv::signal::connect(_poly.after_insert_loop, this, &polygon_intersection_finder::on_structure_change);
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_intersection_finder::on_change_loop);
+	cgv::signal::connect(_poly.before_remove_loop, this, &polygon_intersection_finder::on_structure_change);
+	cgv::signal::connect(_poly.after_insert_vertex, this, &polygon_intersection_finder::on_structure_change);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_intersection_finder::on_change_vertex);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_intersection_finder::on_change_vertex_range);
+	cgv::signal::connect(_poly.before_remove_vertex, this, &polygon_intersection_finder::on_structure_change);
+	cgv::signal::connect(_poly.before_remove_vertex_range, this, &polygon_intersection_finder::before_remove_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_intersection_finder::on_new_polygon);
+}
+
+/// return start vertex of the edge ending in vtx_idx or size_t(-1) for the first vertex of an open loop
+size_t polygon_intersection_finder::edge_start(size_t edge) const
+{
+	size_t loop_idx = poly.find_loop(edge);
+	size_t vbegin = poly.loop_begin(loop_idx);
+	if (edge > vbegin)
+		return edge - 1;
+	// the closing edge of a closed loop with two vertices coincides with its other edge
+	return poly.loop_closed(loop_idx) && poly.loop_size(loop_idx) > 2 ? poly.loop_end(loop_idx) - 1 : size_t(-1);
+}
+
+/// return end vertex of the edge starting in vtx_idx or size_t(-1) for the last vertex of an open loop
+size_t polygon_intersection_finder::edge_end(size_t vtx_idx) const
+{
+	size_t loop_idx = poly.find_loop(vtx_idx);
+	if (vtx_idx + 1 < poly.loop_end(loop_idx))
+		return vtx_idx + 1;
+	return poly.loop_closed(loop_idx) && poly.loop_size(loop_idx) > 2 ? poly.loop_begin(loop_idx) : size_t(-1);
+}
+
+/// return whether two edges intersect and set location to a common point, where a common vertex of adjacent edges is ignored
+bool polygon_intersection_finder::intersect_edges(size_t edge0, size_t edge1, vtx_type& location) const
+{
+	size_t vi0 = edge_start(edge0), vi1 = edge_start(edge1);
+	if (vi0 == size_t(-1) || vi1 == size_t(-1) || edge0 == edge1)
+		return false;
+	const vtx_type& a0 = poly.vertex(vi0);
+	const vtx_type& a1 = poly.vertex(edge0);
+	const vtx_type& b0 = poly.vertex(vi1);
+	const vtx_type& b1 = poly.vertex(edge1);
+	// degenerate edges are ignored like in the sweep
+	if (a0 == a1 || b0 == b1)
+		return false;
+	double o0 = orientation(a0[0], a0[1], a1[0], a1[1], b0[0], b0[1]);
+	double o1 = orientation(a0[0], a0[1], a1[0], a1[1], b1[0], b1[1]);
+	double o2 = orientation(b0[0], b0[1], b1[0], b1[1], a0[0], a0[1]);
+	double o3 = orientation(b0[0], b0[1], b1[0], b1[1], a1[0], a1[1]);
+	if (((o0 < 0 && o1 > 0) || (o0 > 0 && o1 < 0)) && ((o2 < 0 && o3 > 0) || (o2 > 0 && o3 < 0))) {
+		double t = o2 / (o2 - o3);
+		location = vtx_type(float(a0[0] + t*(double(a1[0]) - a0[0])), float(a0[1] + t*(double(a1[1]) - a0[1])));
+		return true;
+	}
+	// touching or overlapping edges have an end point on the other edge
+	const vtx_type* touch_points[4] = { &b0, &b1, &a0, &a1 };
+	double touch_orientations[4] = { o0, o1, o2, o3 };
+	for (int i = 0; i < 4; ++i) {
+		const vtx_type& p = *touch_points[i];
+		if (touch_orientations[i] != 0 || !(i < 2 ? is_on_segment(a0, a1, p) : is_on_segment(b0, b1, p)))
+			continue;
+		if (share_vertex_at(edge0, edge1, p[0], p[1]))
+			continue;
+		location = p;
+		return true;
+	}
+	return false;
+}
+
+/// find all pairs of intersecting edges with a sweep line and return them sorted by edge pair
+void polygon_intersection_finder::find_intersections(std::vector<polygon_intersection>& result)
+{
+	result.clear();
+	segments.clear();
+	for (size_t edge = 0; edge < poly.nr_vertices(); ++edge) {
+		size_t vi = edge_start(edge);
+		if (vi == size_t(-1))
+			continue;
+		segment_type sg;
+		sg.p0 = poly.vertex(vi);
+		sg.p1 = poly.vertex(edge);
+		if (sg.p0 == sg.p1)
+			continue;
+		if (is_before(sg.p1[0], sg.p1[1], sg.p0[0], sg.p0[1]))
+			std::swap(sg.p0, sg.p1);
+		sg.edge = edge;
+		sg.slope = sg.p0[0] == sg.p1[0] ? std::numeric_limits<double>::infinity() : (double(sg.p1[1]) - sg.p0[1]) / (double(sg.p1[0]) - sg.p0[0]);
+		segments.push_back(sg);
+	}
+	size_t nr_segments = segments.size();
+	end_points.resize(2 * nr_segments);
+	for (size_t s = 0; s < nr_segments; ++s) {
+		end_points[2 * s] = { segments[s].p0, s, true };
+		end_points[2 * s + 1] = { segments[s].p1, s, false };
+	}
+	std::sort(end_points.begin(), end_points.end(), [](const end_point_type& e0, const end_point_type& e1) {
+		return is_before(e0.location[0], e0.location[1], e1.location[0], e1.location[1]);
+	});
+	crossings.clear();
+	status.clear();
+	status_entries.assign(nr_segments, status.end());
+	through_event.assign(nr_segments, false);
+
+	size_t ei = 0;
+	while (ei < end_points.size() || !crossings.empty()) {
+		// next event is the lexicographically smallest end point or crossing
+		if (ei < end_points.size() && (crossings.empty() || !is_before(crossings.front().x, crossings.front().y, end_points[ei].location[0], end_points[ei].location[1]))) {
+			sweep_x = end_points[ei].location[0];
+			sweep_y = end_points[ei].location[1];
+		}
+		else {
+			sweep_x = crossings.front().x;
+			sweep_y = crossings.front().y;
+		}
+		// segments ending or crossing at the event are collected in event_segments and segments starting at it in inserted_segments
+		event_segments.clear();
+		inserted_segments.clear();
+		for (; ei < end_points.size() && end_points[ei].location[0] == sweep_x && end_points[ei].location[1] == sweep_y; ++ei)
+			(end_points[ei].is_start ? inserted_segments : event_segments).push_back(end_points[ei].segment);
+		while (!crossings.empty() && crossings.front().x == sweep_x && crossings.front().y == sweep_y) {
+			event_segments.push_back(crossings.front().s0);
+			event_segments.push_back(crossings.front().s1);
+			std::pop_heap(crossings.begin(), crossings.end());
+			crossings.pop_back();
+		}
+		// segments passing through the event are its neighbors in the status, where a tolerance accounts for the rounding of computed crossings
+		double tolerance = 1e-12 * (std::abs(sweep_x) + std::abs(sweep_y) + 1);
+		auto is_near = [&](size_t s) { return std::abs(segment_y(s) - sweep_y) <= tolerance; };
+		auto position = status.lower_bound(size_t(-1));
+		for (auto iter = position; iter != status.end() && is_near(*iter); ++iter)
+			event_segments.push_back(*iter);
+		for (auto iter = position; iter != status.begin() && is_near(*std::prev(iter)); --iter)
+			event_segments.push_back(*std::prev(iter));
+		std::sort(event_segments.begin(), event_segments.end());
+		event_segments.erase(std::unique(event_segments.begin(), event_segments.end()), event_segments.end());
+
+		// all segments at the event meet in it
+		size_t nr_event_segments = event_segments.size();
+		event_segments.insert(event_segments.end(), inserted_segments.begin(), inserted_segments.end());
+		for (size_t i = 0; i < event_segments.size(); ++i)
+			for (size_t j = i + 1; j < event_segments.size(); ++j) {
+				size_t e0 = segments[event_segments[i]].edge, e1 = segments[event_segments[j]].edge;
+				if (e0 != e1 && !share_vertex_at(e0, e1, sweep_x, sweep_y))
+					add_intersection(result, e0, e1, sweep_x, sweep_y);
+			}
+		event_segments.resize(nr_event_segments);
+
+		// segments continuing behind the event are inserted again in their order behind it
+		for (size_t s : event_segments) {
+			if (status_entries[s] != status.end()) {
+				status.erase(status_entries[s]);
+				status_entries[s] = status.end();
+			}
+			if (is_before(sweep_x, sweep_y, segments[s].p1[0], segments[s].p1[1]))
+				inserted_segments.push_back(s);
+		}
+		std::sort(inserted_segments.begin(), inserted_segments.end());
+		inserted_segments.erase(std::unique(inserted_segments.begin(), inserted_segments.end()), inserted_segments.end());
+		for (size_t s : inserted_segments)
+			through_event[s] = true;
+		for (size_t s : inserted_segments)
+			status_entries[s] = status.insert(s).first;
+		if (inserted_segments.empty()) {
+			position = status.lower_bound(size_t(-1));
+			if (position != status.begin() && position != status.end())
+				check_crossing(*std::prev(position), *position, result);
+		}
+		else {
+			// only the lowest and highest inserted segments get new neighbors
+			for (size_t s : inserted_segments) {
+				auto iter = status_entries[s];
+				if (iter != status.begin() && !through_event[*std::prev(iter)])
+					check_crossing(*std::prev(iter), s, result);
+				if (std::next(iter) != status.end() && !through_event[*std::next(iter)])
+					check_crossing(s, *std::next(iter), result);
+			}
+		}
+		for (size_t s : inserted_segments)
+			through_event[s] = false;
+	}
+	std::sort(result.begin(), result.end(), [](const polygon_intersection& pi0, const polygon_intersection& pi1) {
+		return pi0.edge0 < pi1.edge0 || (pi0.edge0 == pi1.edge0 && pi0.edge1 < pi1.edge1);
+	});
+	result.erase(std::unique(result.begin(), result.end(), [](const polygon_intersection& pi0, const polygon_intersection& pi1) {
+		return pi0.edge0 == pi1.edge0 && pi0.edge1 == pi1.edge1;
+	}), result.end());
+}
+
+/// append intersections of the given edge with all other edges that are found in the edge grid
+void polygon_intersection_finder::find_edge_intersections(size_t edge, polygon_edge_grid& grid, std::vector<polygon_intersection>& result)
+{
+	size_t vi = edge_start(edge);
+	if (vi == size_t(-1))
+		return;
+	candidate_edges.clear();
+	grid.collect_edges(poly.vertex(vi), poly.vertex(edge), candidate_edges);
+	std::sort(candidate_edges.begin(), candidate_edges.end());
+	candidate_edges.erase(std::unique(candidate_edges.begin(), candidate_edges.end()), candidate_edges.end());
+	vtx_type location;
+	for (size_t other : candidate_edges)
+		if (intersect_edges(edge, other, location))
+			add_intersection(result, edge, other, location[0], location[1]);
+}
+
+/// bring intersections up to date, where after vertex moves only the incident edges are tested through the edge grid
+void polygon_intersection_finder::update(polygon_edge_grid& grid)
+{
+	if (outofdate)
+		find_intersections(intersections);
+	else if (!moved_vertices.empty())
+		update_moved_vertices(grid);
+	outofdate = false;
+	moved_vertices.clear();
+}
+
+/// return intersections found by the last update
+const std::vector<polygon_intersection>& polygon_intersection_finder::get_intersections() const
+{
+	return intersections;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <set>
+#include "polygon.h"
+#include "polygon_edge_grid.h"
+
+/// intersection of two polygon edges, each given by the index of its end vertex with edge0 < edge1
+struct polygon_intersection
+{
+	size_t edge0;
+	size_t edge1;
+	polygon_types::vtx_type location;
+};
+
+/// finds pairs of intersecting edges over all loops of a polygon, where edges sharing a vertex only count if they also meet elsewhere; the full search is a Bentley-Ottmann sweep in O((n+k) log n) for k intersections, while moved vertices only cause the edges incident to them to be tested again against the edges found in the edge grid
+class polygon_intersection_finder : public cgv::signal::tacker, public polygon_types
+{
+protected:
+	const polygon& poly;
+	/// intersections found by the last update
+	std::vector<polygon_intersection> intersections;
+	/// whether all intersections need to be searched again
+	bool outofdate;
+	/// vertices moved since the last update
+	std::vector<size_t> moved_vertices;
+
+	/**@name sweep state with segments directed from their lexicographically smaller end point*/
+	//@{
+	struct segment_type
+	{
+		vtx_type p0, p1;
+		size_t edge;
+		double slope;
+	};
+	std::vector<segment_type> segments;
+	/// end point events of the segments
+	struct end_point_type
+	{
+		vtx_type location;
+		size_t segment;
+		bool is_start;
+	};
+	std::vector<end_point_type> end_points;
+	/// crossing events as location and segment pair, ordered such that the next event is on top
+	struct crossing_type
+	{
+		double x, y;
+		size_t s0, s1;
+		bool operator < (const crossing_type& c) const { return x > c.x || (x == c.x && y > c.y); }
+	};
+	std::vector<crossing_type> crossings;
+	/// current event at which segments are compared, where segments through it are flagged
+	double sweep_x, sweep_y;
+	std::vector<bool> through_event;
+	/// orders segments by their y-coordinate at the current event and segments through it by slope, where size_t(-1) denotes the event itself
+	struct segment_order
+	{
+		const polygon_intersection_finder* finder;
+		bool operator () (size_t s0, size_t s1) const;
+	};
+	std::set<size_t, segment_order> status;
+	std::vector<std::set<size_t, segment_order>::iterator> status_entries;
+	std::vector<size_t> event_segments, inserted_segments;
+	std::vector<size_t> candidate_edges;
+	//@}
+
+	/// return y-coordinate of segment at the current event
+	double segment_y(size_t s) const;
+	/// return whether two edges share a vertex at the given location
+	bool share_vertex_at(size_t edge0, size_t edge1, double x, double y) const;
+	/// append intersection of two edges
+	void add_intersection(std::vector<polygon_intersection>& result, size_t edge0, size_t edge1, double x, double y) const;
+	/// schedule crossing of two segments that are neighbors in the status, or report it immediately if it is not behind the current event
+	void check_crossing(size_t s0, size_t s1, std::vector<polygon_intersection>& result);
+	/// test edges incident to the moved vertices again against the edges found in the grid
+	void update_moved_vertices(polygon_edge_grid& grid);
+
+	/// callbacks used to collect changes
+	void on_structure_change(size_t);
+	void on_new_polygon();
+	void on_change_loop(size_t loop_idx, int flags);
+	void on_change_vertex(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+	void before_remove_vertex_range(size_t vtx_begin, size_t vtx_end);
+public:
+	/// construct finder and connect to polygon signals
+	polygon_intersection_finder(polygon& _poly);
+	/// return start vertex of the edge ending in vtx_idx or size_t(-1) for the first vertex of an open loop
+	size_t edge_start(size_t edge) const;
+	/// return end vertex of the edge starting in vtx_idx or size_t(-1) for the last vertex of an open loop
+	size_t edge_end(size_t vtx_idx) const;
+	/// return whether two edges intersect and set location to a common point, where a common vertex of adjacent edges is ignored
+	bool intersect_edges(size_t edge0, size_t edge1, vtx_type& location) const;
+	/// find all pairs of intersecting edges with a sweep line and return them sorted by edge pair
+	void find_intersections(std::vector<polygon_intersection>& result);
+	/// append intersections of the given edge with all other edges that are found in the edge grid
+	void find_edge_intersections(size_t edge, polygon_edge_grid& grid, std::vector<polygon_intersection>& result);
+	/// bring intersections up to date, where after vertex moves only the incident edges are tested through the edge grid
+	void update(polygon_edge_grid& grid);
+	/// return intersections found by the last update
+	const std::vector<polygon_intersection>& get_intersections() const;
+};
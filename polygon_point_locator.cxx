@@ -0,0 +1,534 @@
+#include "polygon_point_locator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POLYGON_POINT_LOCATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+/// return sum of windings of the entries in the given blocks whose y-range contains py and whose crossing with the row at py lies right of px
+int polygon_point_locator::count_crossings_scalar(const entry_block_type* blocks, size_t nr_blocks, float px, float py)
+{
+	int w = 0;
+	for (size_t bi = 0; bi < nr_blocks; ++bi) {
+		const entry_block_type& b = blocks[bi];
+		for (int i = 0; i < 4; ++i)
+			if (b.y_min[i] <= py && py < b.y_max[i] && b.x[i] + (py - b.y_min[i])*b.dxdy[i] > px)
+				w += b.winding[i];
+	}
+	return w;
+}
+
+/// return sum of windings of the given right edges whose y-range contains py
+int polygon_point_locator::count_spans_scalar(const right_edge_type* edges, size_t nr_edges, float py)
+{
+	int w = 0;
+	for (size_t i = 0; i < nr_edges; ++i)
+		if (edges[i].y_min <= py && py < edges[i].y_max)
+			w += edges[i].winding;
+	return w;
+}
+
+#ifdef POLYGON_POINT_LOCATOR_SSE2
+static int horizontal_sum(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(v);
+}
+
+/// same as count_crossings_scalar with the four entries of a block tested at once
+int polygon_point_locator::count_crossings_sse2(const entry_block_type* blocks, size_t nr_blocks, float px, float py)
+{
+	__m128 vpx = _mm_set1_ps(px), vpy = _mm_set1_ps(py);
+	__m128i acc = _mm_setzero_si128();
+	for (size_t bi = 0; bi < nr_blocks; ++bi) {
+		const entry_block_type& b = blocks[bi];
+		__m128 lo = _mm_loadu_ps(b.y_min);
+		__m128 span = _mm_and_ps(_mm_cmple_ps(lo, vpy), _mm_cmplt_ps(vpy, _mm_loadu_ps(b.y_max)));
+		__m128 xc = _mm_add_ps(_mm_loadu_ps(b.x), _mm_mul_ps(_mm_sub_ps(vpy, lo), _mm_loadu_ps(b.dxdy)));
+		__m128 mask = _mm_and_ps(span, _mm_cmpgt_ps(xc, vpx));
+		acc = _mm_add_epi32(acc, _mm_and_si128(_mm_castps_si128(mask), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.winding))));
+	}
+	return horizontal_sum(acc);
+}
+
+/// same as count_spans_scalar with four right edges transposed into registers at once and the remainder processed in scalar code
+int polygon_point_locator::count_spans_sse2(const right_edge_type* edges, size_t nr_edges, float py)
+{
+	static_assert(sizeof(right_edge_type) == 16, "right edges are transposed as four floats");
+	__m128 vpy = _mm_set1_ps(py);
+	__m128i acc = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 4 <= nr_edges; i += 4) {
+		const float* ptr = &edges[i].y_min;
+		__m128 lo = _mm_loadu_ps(ptr), hi = _mm_loadu_ps(ptr + 4), w = _mm_loadu_ps(ptr + 8), l = _mm_loadu_ps(ptr + 12);
+		_MM_TRANSPOSE4_PS(lo, hi, w, l);
+		__m128 span = _mm_and_ps(_mm_cmple_ps(lo, vpy), _mm_cmplt_ps(vpy, hi));
+		acc = _mm_add_epi32(acc, _mm_and_si128(_mm_castps_si128(span), _mm_castps_si128(w)));
+	}
+	return horizontal_sum(acc) + count_spans_scalar(edges + i, nr_edges - i, py);
+}
+#endif
+
+/// return slab containing y, which needs to be in [y_min,y_max)
+int polygon_point_locator::slab_index(float y) const
+{
+	return std::min(int((y - origin_y)*inv_slab_height), nr_slabs - 1);
+}
+
+/// return cell column containing x clamped to the columns
+int polygon_point_locator::column_index(float x) const
+{
+	double c = std::floor((x - origin_x)*inv_cell_width);
+	return c < 0 ? 0 : (c >= nr_cols ? nr_cols - 1 : int(c));
+}
+
+/// return left border of given column
+double polygon_point_locator::column_border(int col) const
+{
+	return origin_x + col*cell_width;
+}
+
+/// append entry of edge to the last entry block, where a new block is started after every four entries
+void polygon_point_locator::append_entry(const edge_type& e, size_t entry_idx)
+{
+	size_t i = entry_idx % 4;
+	if (i == 0) {
+		entry_block_type b;
+		for (int j = 0; j < 4; ++j) {
+			b.y_min[j] = std::numeric_limits<float>::infinity();
+			b.y_max[j] = -std::numeric_limits<float>::infinity();
+			b.x[j] = b.dxdy[j] = 0;
+			b.winding[j] = 0;
+		}
+		entry_blocks.push_back(b);
+		entry_loops.resize(entry_loops.size() + 4, 0);
+	}
+	entry_block_type& b = entry_blocks.back();
+	b.y_min[i] = float(e.y_lower);
+	b.y_max[i] = float(e.y_upper);
+	b.x[i] = float(e.x_lower);
+	b.dxdy[i] = float((e.x_upper - e.x_lower) / (e.y_upper - e.y_lower));
+	b.winding[i] = e.winding;
+	entry_loops[entry_loops.size() - 4 + i] = e.loop;
+}
+
+/// return right edge entry of edge
+polygon_point_locator::right_edge_type polygon_point_locator::make_right_edge(const edge_type& e)
+{
+	right_edge_type re;
+	re.y_min = float(e.y_lower);
+	re.y_max = float(e.y_upper);
+	re.winding = e.winding;
+	re.loop = e.loop;
+	return re;
+}
+
+/// rebuild slabs and cells from all closed loops
+void polygon_point_locator::rebuild()
+{
+	outofdate = false;
+	edges.clear();
+	entry_blocks.clear();
+	entry_loops.clear();
+	right_edges.clear();
+	cells.clear();
+	nr_slabs = 0;
+	nr_cols = 0;
+	// open loops have undefined orientation and do not bound an area, horizontal edges never cross the rays cast from the points
+	double x_min = std::numeric_limits<double>::infinity(), x_max = -x_min, sum_dy = 0;
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		if (poly.loop_orientation(li) == PO_UNDEF)
+			continue;
+		size_t vi_last = poly.loop_end(li) - 1;
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi) {
+			const vtx_type& p0 = poly.vertex(vi_last);
+			const vtx_type& p1 = poly.vertex(vi);
+			vi_last = vi;
+			if (p0(1) == p1(1))
+				continue;
+			edge_type e;
+			e.winding = p0(1) < p1(1) ? 1 : -1;
+			const vtx_type& lower = e.winding > 0 ? p0 : p1;
+			const vtx_type& upper = e.winding > 0 ? p1 : p0;
+			e.x_lower = lower(0);
+			e.y_lower = lower(1);
+			e.x_upper = upper(0);
+			e.y_upper = upper(1);
+			e.loop = uint32_t(li);
+			x_min = std::min(x_min, std::min(e.x_lower, e.x_upper));
+			x_max = std::max(x_max, std::max(e.x_lower, e.x_upper));
+			if (edges.empty() || e.y_lower < y_min)
+				y_min = float(e.y_lower);
+			if (edges.empty() || e.y_upper > y_max)
+				y_max = float(e.y_upper);
+			sum_dy += e.y_upper - e.y_lower;
+			edges.push_back(e);
+		}
+	}
+	if (edges.empty())
+		return;
+
+	// slabs are chosen such that edges are split into about three times as many entries and cells such that each holds a few entries
+	size_t n = edges.size();
+	double extent_y = double(y_max) - y_min, extent_x = x_max - x_min;
+	nr_slabs = int(std::min(std::min(3.0 * n * extent_y / sum_dy, 2.0 * n), 65536.0));
+	nr_slabs = std::max(nr_slabs, 1);
+	double nr_entries_per_slab = sum_dy / extent_y + double(n) / nr_slabs;
+	nr_cols = std::max(std::min(int(nr_entries_per_slab / 4), 256), 1);
+	nr_cols = std::max(std::min(nr_cols, int((4 * n + 1024) / nr_slabs)), 1);
+	if (extent_x == 0)
+		nr_cols = 1;
+	origin_x = x_min;
+	origin_y = y_min;
+	slab_height = extent_y / nr_slabs;
+	inv_slab_height = nr_slabs / extent_y;
+	cell_width = extent_x > 0 ? extent_x / nr_cols : 1;
+	inv_cell_width = 1 / cell_width;
+	// margins exceed the rounding errors of slab and column indices such that classified edges are valid for all points assigned to a cell
+	margin_y = 1e-9*(std::abs(y_min) + std::abs(y_max) + extent_y);
+	margin_x = 1e-9*(std::abs(x_min) + std::abs(x_max) + extent_x);
+
+	// collect the part of each edge within each slab with its range of overlapped columns, where edges right of this range are right of the cells
+	struct slab_entry_type
+	{
+		uint32_t edge;
+		int slab;
+		int col_begin, col_end;
+		bool full;
+	};
+	std::vector<slab_entry_type> slab_entries;
+	for (size_t ei = 0; ei < n; ++ei) {
+		const edge_type& e = edges[ei];
+		int s_begin = std::max(int(std::floor((e.y_lower - margin_y - origin_y)*inv_slab_height)), 0);
+		int s_end = std::min(int(std::floor((e.y_upper + margin_y - origin_y)*inv_slab_height)), nr_slabs - 1);
+		double dxdy = (e.x_upper - e.x_lower) / (e.y_upper - e.y_lower);
+		for (int s = s_begin; s <= s_end; ++s) {
+			double sy0 = origin_y + s*slab_height - margin_y, sy1 = origin_y + (s + 1)*slab_height + margin_y;
+			if (!(e.y_lower <= sy1 && e.y_upper > sy0))
+				continue;
+			double ya = std::max(e.y_lower, sy0), yb = std::min(e.y_upper, sy1);
+			double xa = e.x_lower + (ya - e.y_lower)*dxdy, xb = e.x_lower + (yb - e.y_lower)*dxdy;
+			double ex_min = std::min(xa, xb) - margin_x, ex_max = std::max(xa, xb) + margin_x;
+			slab_entry_type se;
+			se.edge = uint32_t(ei);
+			se.slab = s;
+			se.full = e.y_lower <= sy0 && e.y_upper >= sy1;
+			// first column whose right border is not left of the edge and last column whose left border is not right of it
+			se.col_begin = column_index(float(ex_min));
+			while (se.col_begin > 0 && ex_min <= column_border(se.col_begin))
+				--se.col_begin;
+			while (se.col_begin + 1 < nr_cols && ex_min > column_border(se.col_begin + 1))
+				++se.col_begin;
+			se.col_end = column_index(float(ex_max));
+			while (se.col_end + 1 < nr_cols && ex_max >= column_border(se.col_end + 1))
+				++se.col_end;
+			while (se.col_end > se.col_begin && ex_max < column_border(se.col_end))
+				--se.col_end;
+			slab_entries.push_back(se);
+		}
+	}
+	// edges right of a cell are a prefix of the slab lists sorted by decreasing first column
+	std::sort(slab_entries.begin(), slab_entries.end(), [](const slab_entry_type& se0, const slab_entry_type& se1) {
+		return se0.slab < se1.slab || (se0.slab == se1.slab && se0.col_begin > se1.col_begin);
+	});
+
+	cells.resize(size_t(nr_slabs)*nr_cols);
+	std::vector<std::vector<uint32_t> > cell_entries(nr_cols);
+	size_t si = 0;
+	for (int s = 0; s < nr_slabs; ++s) {
+		size_t si_end = si;
+		while (si_end < slab_entries.size() && slab_entries[si_end].slab == s)
+			++si_end;
+		cell_type* slab_cells = &cells[size_t(s)*nr_cols];
+		// entries of the cells in this slab
+		for (int c = 0; c < nr_cols; ++c)
+			cell_entries[c].clear();
+		for (size_t i = si; i < si_end; ++i)
+			for (int c = slab_entries[i].col_begin; c <= slab_entries[i].col_end; ++c)
+				cell_entries[c].push_back(uint32_t(i));
+		for (int c = 0; c < nr_cols; ++c) {
+			slab_cells[c].block_begin = uint32_t(entry_blocks.size());
+			for (size_t i = 0; i < cell_entries[c].size(); ++i)
+				append_entry(edges[slab_entries[cell_entries[c][i]].edge], i);
+			slab_cells[c].block_end = uint32_t(entry_blocks.size());
+		}
+		// lists of edges spanning the slab and of edges ending within it
+		uint32_t full_begin = uint32_t(right_edges.size());
+		for (size_t i = si; i < si_end; ++i)
+			if (slab_entries[i].full)
+				right_edges.push_back(make_right_edge(edges[slab_entries[i].edge]));
+		uint32_t partial_begin = uint32_t(right_edges.size());
+		for (size_t i = si; i < si_end; ++i)
+			if (!slab_entries[i].full)
+				right_edges.push_back(make_right_edge(edges[slab_entries[i].edge]));
+		// count edges right of each cell and sum up the windings of those spanning the slab
+		uint32_t nr_full = 0, nr_partial = 0;
+		int offset = 0;
+		size_t i = si;
+		for (int c = nr_cols - 1; c >= 0; --c) {
+			for (; i < si_end && slab_entries[i].col_begin > c; ++i) {
+				if (slab_entries[i].full) {
+					++nr_full;
+					offset += edges[slab_entries[i].edge].winding;
+				}
+				else
+					++nr_partial;
+			}
+			slab_cells[c].offset = offset;
+			slab_cells[c].full_begin = full_begin;
+			slab_cells[c].full_end = full_begin + nr_full;
+			slab_cells[c].partial_begin = partial_begin;
+			slab_cells[c].partial_end = partial_begin + nr_partial;
+		}
+		si = si_end;
+	}
+}
+
+/// return index of cell containing p or size_t(-1) if p is above or below all edges
+size_t polygon_point_locator::find_cell(const vtx_type& p) const
+{
+	if (nr_slabs == 0 || !(p(1) >= y_min && p(1) < y_max))
+		return size_t(-1);
+	return size_t(slab_index(p(1)))*nr_cols + column_index(p(0));
+}
+
+/// return winding number of p by testing the entries of its cell
+int polygon_point_locator::compute_winding_number(const vtx_type& p) const
+{
+	size_t ci = find_cell(p);
+	if (ci == size_t(-1))
+		return 0;
+	const cell_type& cell = cells[ci];
+	const entry_block_type* blocks = entry_blocks.empty() ? 0 : &entry_blocks[cell.block_begin];
+	const right_edge_type* partial_edges = right_edges.empty() ? 0 : &right_edges[0] + cell.partial_begin;
+#ifdef POLYGON_POINT_LOCATOR_SSE2
+	if (use_simd)
+		return cell.offset +
+			count_crossings_sse2(blocks, cell.block_end - cell.block_begin, p(0), p(1)) +
+			count_spans_sse2(partial_edges, cell.partial_end - cell.partial_begin, p(1));
+#endif
+	return cell.offset +
+		count_crossings_scalar(blocks, cell.block_end - cell.block_begin, p(0), p(1)) +
+		count_spans_scalar(partial_edges, cell.partial_end - cell.partial_begin, p(1));
+}
+
+/// compute winding numbers of a batch of points, where the cells and entries of subsequent points are prefetched to hide memory latency
+void polygon_point_locator::compute_winding_number_batch(const vtx_type* points, size_t nr_points, int* windings) const
+{
+	// cells are fetched two steps ahead of the points that are tested and entries one step ahead
+	const size_t distance = 8;
+	for (size_t i = 0; i < nr_points; ++i) {
+#ifdef POLYGON_POINT_LOCATOR_SSE2
+		if (i + 2 * distance < nr_points) {
+			size_t ci = find_cell(points[i + 2 * distance]);
+			if (ci != size_t(-1))
+				_mm_prefetch(reinterpret_cast<const char*>(&cells[ci]), _MM_HINT_T0);
+		}
+		if (i + distance < nr_points) {
+			size_t ci = find_cell(points[i + distance]);
+			if (ci != size_t(-1)) {
+				const cell_type& cell = cells[ci];
+				if (cell.block_begin < cell.block_end)
+					_mm_prefetch(reinterpret_cast<const char*>(&entry_blocks[cell.block_begin]), _MM_HINT_T0);
+				if (cell.partial_begin < cell.partial_end)
+					_mm_prefetch(reinterpret_cast<const char*>(&right_edges[cell.partial_begin]), _MM_HINT_T0);
+			}
+		}
+#endif
+		windings[i] = compute_winding_number(points[i]);
+	}
+}
+
+/// classify a batch of points by their winding numbers
+void polygon_point_locator::classify_point_batch(const vtx_type* points, size_t nr_points, cgv::type::uint8_type* inside) const
+{
+	const size_t batch_size = 256;
+	int windings[batch_size];
+	for (size_t begin = 0; begin < nr_points; begin += batch_size) {
+		size_t n = std::min(batch_size, nr_points - begin);
+		compute_winding_number_batch(points + begin, n, windings);
+		for (size_t i = 0; i < n; ++i)
+			inside[begin + i] = is_inside(windings[i]) ? 1 : 0;
+	}
+}
+
+/// return whether winding number is inside according to the fill rule
+bool polygon_point_locator::is_inside(int winding) const
+{
+	if (fill_rule == FR_EVEN_ODD)
+		return (winding & 1) != 0;
+	return winding != 0;
+}
+
+void polygon_point_locator::on_structure_change(size_t)
+{
+	outofdate = true;
+}
+
+void polygon_point_locator::on_new_polygon()
+{
+	outofdate = true;
+}
+
+void polygon_point_locator::on_change_loop(size_t loop_idx, int flags)
+{
+	if ((flags & ~PLA_COLOR) != 0)
+		outofdate = true;
+}
+
+void polygon_point_locator::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	outofdate = true;
+}
+
+/// construct locator and connect to polygon signals
+polygon_point_locator::polygon_point_locator(polygon& _poly) : poly(_poly), fill_rule(FR_EVEN_ODD), outofdate(true), nr_slabs(0), nr_cols(0)
+{
+#ifdef POLYGON_POINT_LOCATOR_SSE2
+	use_simd = true;
+#else
+	use_simd = false;
+#endif
+	cgv::signal::connect(_poly.after_insert_loop, this, &polygon_point_locator::on_structure_change);
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_point_locator::on_change_loop);
+	cgv::signal::connect(_poly.before_remove_loop, this, &polygon_point_locator::on_structure_change);
+	cgv::signal::connect(_poly.after_insert_vertex, this, &polygon_point_locator::on_structure_change);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_point_locator::on_structure_change);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_point_locator::on_change_vertex_range);
+	cgv::signal::connect(_poly.before_remove_vertex, this, &polygon_point_locator::on_structure_change);
+	cgv::signal::connect(_poly.before_remove_vertex_range, this, &polygon_point_locator::on_change_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_point_locator::on_new_polygon);
+}
+
+/// release worker threads
+polygon_point_locator::~polygon_point_locator()
+{
+}
+
+/// set fill rule used to classify points
+void polygon_point_locator::set_fill_rule(FillRule _fill_rule)
+{
+	fill_rule = _fill_rule;
+}
+
+/// set whether the crossing tests use sse2; return false if not supported
+bool polygon_point_locator::set_use_simd(bool use)
+{
+#ifndef POLYGON_POINT_LOCATOR_SSE2
+	if (use)
+		return false;
+#endif
+	use_simd = use;
+	return true;
+}
+
+/// return winding number of p
+int polygon_point_locator::winding_number(const vtx_type& p)
+{
+	if (outofdate)
+		rebuild();
+	return compute_winding_number(p);
+}
+
+/// return whether p is inside according to the fill rule
+bool polygon_point_locator::is_inside(const vtx_type& p)
+{
+	return is_inside(winding_number(p));
+}
+
+/// return the loop with the smallest area among the loops with nonzero winding number around p or size_t(-1) if p is outside of all loops
+size_t polygon_point_locator::find_containing_loop(const vtx_type& p)
+{
+	if (outofdate)
+		rebuild();
+	size_t ci = find_cell(p);
+	if (ci == size_t(-1))
+		return size_t(-1);
+	const cell_type& cell = cells[ci];
+	// accumulate winding numbers per loop over the same entries as compute_winding_number
+	std::vector<std::pair<uint32_t, int> > loop_windings;
+	auto add_winding = [&loop_windings](uint32_t loop, int winding) {
+		for (auto& lw : loop_windings)
+			if (lw.first == loop) {
+				lw.second += winding;
+				return;
+			}
+		loop_windings.push_back(std::make_pair(loop, winding));
+	};
+	for (size_t i = cell.full_begin; i < cell.full_end; ++i)
+		add_winding(right_edges[i].loop, right_edges[i].winding);
+	for (size_t i = cell.partial_begin; i < cell.partial_end; ++i)
+		if (right_edges[i].y_min <= p(1) && p(1) < right_edges[i].y_max)
+			add_winding(right_edges[i].loop, right_edges[i].winding);
+	for (size_t bi = cell.block_begin; bi < cell.block_end; ++bi) {
+		const entry_block_type& b = entry_blocks[bi];
+		for (int i = 0; i < 4; ++i)
+			if (b.y_min[i] <= p(1) && p(1) < b.y_max[i] && b.x[i] + (p(1) - b.y_min[i])*b.dxdy[i] > p(0))
+				add_winding(entry_loops[4 * bi + i], b.winding[i]);
+	}
+	size_t loop_idx = size_t(-1);
+	double min_area = 0;
+	for (const auto& lw : loop_windings) {
+		if (lw.second == 0)
+			continue;
+		double area = std::abs(poly.loop_area(lw.first));
+		if (loop_idx == size_t(-1) || area < min_area || (area == min_area && lw.first < loop_idx)) {
+			loop_idx = lw.first;
+			min_area = area;
+		}
+	}
+	return loop_idx;
+}
+
+/// compute winding numbers of nr_points points
+void polygon_point_locator::compute_winding_numbers(const vtx_type* points, size_t nr_points, int* windings)
+{
+	if (outofdate)
+		rebuild();
+	compute_winding_number_batch(points, nr_points, windings);
+}
+
+/// set inside[i] to 1 for points inside according to the fill rule and to 0 otherwise
+void polygon_point_locator::classify_points(const vtx_type* points, size_t nr_points, cgv::type::uint8_type* inside)
+{
+	if (outofdate)
+		rebuild();
+	classify_point_batch(points, nr_points, inside);
+}
+
+/// compute containing loops of nr_points points as in find_containing_loop
+void polygon_point_locator::find_containing_loops(const vtx_type* points, size_t nr_points, size_t* loops)
+{
+	for (size_t i = 0; i < nr_points; ++i)
+		loops[i] = find_containing_loop(points[i]);
+}
+
+/// compute winding numbers with the points split into chunks processed in parallel
+void polygon_point_locator::compute_winding_numbers_parallel(const vtx_type* points, size_t nr_points, int* windings)
+{
+	if (outofdate)
+		rebuild();
+	if (!pool)
+		pool.reset(new thread_pool());
+	pool->parallel_for((nr_points + chunk_size - 1) / chunk_size, [&](size_t chunk_idx) {
+		size_t begin = chunk_idx*chunk_size;
+		compute_winding_number_batch(points + begin, std::min(size_t(chunk_size), nr_points - begin), windings + begin);
+	});
+}
+
+/// classify points with the points split into chunks processed in parallel
+void polygon_point_locator::classify_points_parallel(const vtx_type* points, size_t nr_points, cgv::type::uint8_type* inside)
+{
+	if (outofdate)
+		rebuild();
+	if (!pool)
+		pool.reset(new thread_pool());
+	pool->parallel_for((nr_points + chunk_size - 1) / chunk_size, [&](size_t chunk_idx) {
+		size_t begin = chunk_idx*chunk_size;
+		classify_point_batch(points + begin, std::min(size_t(chunk_size), nr_points - begin), inside + begin);
+	});
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include "polygon.h"
+#include "polygon_raster_engine.h"
+#include "thread_pool.h"
+
+/// classifies batches of points against the closed loops of a polygon, where counter clockwise loops contribute +1 and clockwise loops -1 to the winding number; the edges are binned into horizontal slabs split into cells, such that a point only tests the edges overlapping its cell and the edges to its right that end within the slab, while edges spanning the slab to the right of the cell contribute a precomputed winding offset; the index is rebuilt lazily after the polygon changed
+class polygon_point_locator : public cgv::signal::tacker, public polygon_types
+{
+protected:
+	const polygon& poly;
+	FillRule fill_rule;
+	/// whether the crossing tests use sse2
+	bool use_simd;
+	/// whether the index needs to be rebuilt before the next query
+	bool outofdate;
+
+	/// non horizontal edge of a closed loop with winding +1 if it points upward and -1 otherwise
+	struct edge_type
+	{
+		double x_lower, y_lower, x_upper, y_upper;
+		int winding;
+		uint32_t loop;
+	};
+	std::vector<edge_type> edges;
+	/// region covered by the slabs in y and by the cells in x
+	double origin_x, origin_y, cell_width, slab_height;
+	double inv_cell_width, inv_slab_height;
+	/// margins by which the extents of edges are enlarged when classified against slabs and cells
+	double margin_x, margin_y;
+	float y_min, y_max;
+	int nr_slabs, nr_cols;
+
+	/// four entries of edges overlapping a cell in structure of arrays layout, where unused entries never cross
+	struct entry_block_type
+	{
+		float y_min[4], y_max[4], x[4], dxdy[4];
+		int32_t winding[4];
+	};
+	std::vector<entry_block_type> entry_blocks;
+	/// loop of each entry
+	std::vector<uint32_t> entry_loops;
+	/// edge right of a cell, which is tested only for spanning the y-coordinate of the point
+	struct right_edge_type
+	{
+		float y_min, y_max;
+		int32_t winding;
+		uint32_t loop;
+	};
+	/// per slab list of edges spanning the slab followed by a list of edges ending within it, each sorted by decreasing first overlapped column such that the edges right of a cell are a prefix
+	std::vector<right_edge_type> right_edges;
+	/// cell with its range of entry blocks, the sum of windings of edges right of it that span its slab and its prefixes of the right edge lists
+	struct cell_type
+	{
+		uint32_t block_begin, block_end;
+		int32_t offset;
+		uint32_t full_begin, full_end;
+		uint32_t partial_begin, partial_end;
+	};
+	std::vector<cell_type> cells;
+
+	/// pool used by the parallel batch queries, which is created on first use
+	std::unique_ptr<thread_pool> pool;
+	/// number of points processed by one task of the parallel batch queries
+	static const size_t chunk_size = 4096;
+
+	/// return sum of windings of the entries in the given blocks whose y-range contains py and whose crossing with the row at py lies right of px
+	static int count_crossings_scalar(const entry_block_type* blocks, size_t nr_blocks, float px, float py);
+	static int count_crossings_sse2(const entry_block_type* blocks, size_t nr_blocks, float px, float py);
+	/// return sum of windings of the given right edges whose y-range contains py
+	static int count_spans_scalar(const right_edge_type* edges, size_t nr_edges, float py);
+	static int count_spans_sse2(const right_edge_type* edges, size_t nr_edges, float py);
+	/// return slab containing y, which needs to be in [y_min,y_max)
+	int slab_index(float y) const;
+	/// return cell column containing x clamped to the columns
+	int column_index(float x) const;
+	/// return left border of given column
+	double column_border(int col) const;
+	/// append entry of edge to the last entry block, where a new block is started after every four entries
+	void append_entry(const edge_type& e, size_t entry_idx);
+	/// return right edge entry of edge
+	static right_edge_type make_right_edge(const edge_type& e);
+	/// rebuild slabs and cells from all closed loops
+	void rebuild();
+	/// return index of cell containing p or size_t(-1) if p is above or below all edges
+	size_t find_cell(const vtx_type& p) const;
+	/// return winding number of p by testing the entries of its cell
+	int compute_winding_number(const vtx_type& p) const;
+	/// compute winding numbers of a batch of points, where the cells and entries of subsequent points are prefetched to hide memory latency
+	void compute_winding_number_batch(const vtx_type* points, size_t nr_points, int* windings) const;
+	/// classify a batch of points by their winding numbers
+	void classify_point_batch(const vtx_type* points, size_t nr_points, cgv::type::uint8_type* inside) const;
+	/// return whether winding number is inside according to the fill rule
+	bool is_inside(int winding) const;
+
+	/// callbacks used to detect changes of the polygon
+	void on_structure_change(size_t);
+	void on_new_polygon();
+	void on_change_loop(size_t loop_idx, int flags);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+public:
+	/// construct locator and connect to polygon signals
+	polygon_point_locator(polygon& _poly);
+	/// release worker threads
+	~polygon_point_locator();
+	/// set fill rule used to classify points
+	void set_fill_rule(FillRule _fill_rule);
+	/// set whether the crossing tests use sse2; return false if not supported
+	bool set_use_simd(bool use);
+	/// return winding number of p
+	int winding_number(const vtx_type& p);
+	/// return whether p is inside according to the fill rule
+	bool is_inside(const vtx_type& p);
+	/// return the loop with the smallest area among the loops with nonzero winding number around p or size_t(-1) if p is outside of all loops
+	size_t find_containing_loop(const vtx_type& p);
+	/// compute winding numbers of nr_points points
+	void compute_winding_numbers(const vtx_type* points, size_t nr_points, int* windings);
+	/// set inside[i] to 1 for points inside according to the fill rule and to 0 otherwise
+	void classify_points(const vtx_type* points, size_t nr_points, cgv::type::uint8_type* inside);
+	/// compute containing loops of nr_points points as in find_containing_loop
+	void find_containing_loops(const vtx_type* points, size_t nr_points, size_t* loops);
+	/// compute winding numbers with the points split into chunks processed in parallel
+	void compute_winding_numbers_parallel(const vtx_type* points, size_t nr_points, int* windings);
+	/// classify points with the points split into chunks processed in parallel
+	void classify_points_parallel(const vtx_type* points, size_t nr_points, cgv::type::uint8_type* inside);
+};
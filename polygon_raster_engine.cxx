@@ -0,0 +1,1414 @@
+#include "polygon_raster_engine.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+bool polygon_raster_engine::is_cancelled() const
+{
+	return cancel_flag != 0 && cancel_flag->load(std::memory_order_relaxed);
+}
+
+bool polygon_raster_engine::validate_pixel_location(const pixel_type& p) const 
+{
+	return p(0) >= 0 && p(0) < int(img_width) && p(1) >= 0 && p(1) < int(img_height); 
+}
+
+size_t polygon_raster_engine::linear_index(const pixel_type& p) const 
+{
+	return img_width*(p(1) - img_row_offset) + p(0); 
+}
+
+polygon_raster_engine::pixel_type polygon_raster_engine::round(const vtx_type& p) 
+{ 
+	return pixel_type(int(floor(p(0) + 0.5f)), int(floor(p(1) + 0.5f))); 
+}
+
+void polygon_raster_engine::set_pixel(const pixel_type& p, const clr_type& c) 
+{ 
+	if (validate_pixel_location(p)) 
+		img[linear_index(p)] = c; 
+}
+
+const polygon_raster_engine::clr_type& polygon_raster_engine::get_pixel(const pixel_type& p) const 
+{ 
+	return img[linear_index(p)]; 
+}
+
+polygon_raster_engine::vtx_type polygon_raster_engine::pixel_from_world(const vtx_type& p) const 
+{ 
+	return vtx_type(float(img_width), float(img_height))*(p - img_extent.get_min_pnt()) / img_extent.get_extent(); 
+}
+
+polygon_raster_engine::vtx_type polygon_raster_engine::world_from_pixel(const vtx_type& p) const 
+{ 
+	return p*img_extent.get_extent() / vtx_type(float(img_width), float(img_height)) + img_extent.get_min_pnt(); 
+}
+
+void polygon_raster_engine::clear_image() 
+{ 
+	clear_image(pixel_box_type(pixel_type(0, 0), pixel_type(int(img_width) - 1, int(img_height) - 1)));
+}
+
+void polygon_raster_engine::clear_image(const pixel_box_type& region)
+{
+	int x0 = region.get_min_pnt()(0);
+	size_t nr_pixels = region.get_max_pnt()(0) - x0 + 1;
+	for (int y = region.get_min_pnt()(1); y <= region.get_max_pnt()(1); ++y)
+		raster_kernels::fill_row(&img[linear_index(pixel_type(x0, y))], nr_pixels, bg_pattern[(x0 + y) & 1]);
+}
+
+void polygon_raster_engine::prepare_patterns()
+{
+	bg_pattern[0] = raster_pattern(bg_clr[0], bg_clr[1]);
+	bg_pattern[1] = raster_pattern(bg_clr[1], bg_clr[0]);
+	fg_pattern = raster_pattern(fg_clr, fg_clr);
+}
+
+void polygon_raster_engine::add_dirty_box(const box_type& box)
+{
+	if (!box.is_valid())
+		return;
+	vtx_type p0 = pixel_from_world(box.get_min_pnt());
+	vtx_type p1 = pixel_from_world(box.get_max_pnt());
+	// one pixel margin accounts for rounding of crossings to pixel centers
+	float x0 = std::max(std::floor(p0(0)) - 1, 0.0f), y0 = std::max(std::floor(p0(1)) - 1, 0.0f);
+	float x1 = std::min(std::floor(p1(0)) + 1, float(img_width) - 1), y1 = std::min(std::floor(p1(1)) + 1, float(img_height) - 1);
+	if (x0 > x1 || y0 > y1)
+		return;
+	dirty_region.add_point(pixel_type(int(x0), int(y0)));
+	dirty_region.add_point(pixel_type(int(x1), int(y1)));
+}
+
+void polygon_raster_engine::add_dirty_vertex(size_t vtx_idx)
+{
+	size_t loop_idx = poly.find_loop(vtx_idx);
+	size_t vbegin = poly.loop_begin(loop_idx), vend = poly.loop_end(loop_idx);
+	box_type box;
+	box.invalidate();
+	box.add_point(poly.vertex(vtx_idx));
+	box.add_point(poly.vertex(vtx_idx > vbegin ? vtx_idx - 1 : vend - 1));
+	box.add_point(poly.vertex(vtx_idx + 1 < vend ? vtx_idx + 1 : vbegin));
+	add_dirty_box(box);
+}
+
+void polygon_raster_engine::add_dirty_loop(size_t loop_idx)
+{
+	box_type box;
+	box.invalidate();
+	for (size_t vi = poly.loop_begin(loop_idx); vi < poly.loop_end(loop_idx); ++vi)
+		box.add_point(poly.vertex(vi));
+	add_dirty_box(box);
+}
+
+void polygon_raster_engine::on_change_loop(size_t loop_idx, int flags)
+{
+	// closing, opening or reorienting a loop changes the area covered by all of its edges
+	if ((flags & (PLA_CLOSED | PLA_ORIENTATION)) != 0)
+		add_dirty_loop(loop_idx);
+}
+
+void polygon_raster_engine::on_vertex_signal(size_t vtx_idx)
+{
+	add_dirty_vertex(vtx_idx);
+}
+
+void polygon_raster_engine::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	box_type box;
+	box.invalidate();
+	for (size_t vi = vtx_begin; vi < vtx_end; ++vi)
+		box.add_point(poly.vertex(vi));
+	add_dirty_box(box);
+	// edges to vertices outside of the range start at the first and last range vertex of each loop
+	size_t loop_end_idx = poly.find_loop(vtx_end - 1) + 1;
+	for (size_t li = poly.find_loop(vtx_begin); li < loop_end_idx; ++li) {
+		add_dirty_vertex(std::max(vtx_begin, poly.loop_begin(li)));
+		add_dirty_vertex(std::min(vtx_end, poly.loop_end(li)) - 1);
+	}
+}
+
+void polygon_raster_engine::before_remove_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	box_type box;
+	box.invalidate();
+	for (size_t vi = vtx_begin; vi < vtx_end; ++vi)
+		box.add_point(poly.vertex(vi));
+	add_dirty_box(box);
+}
+
+void polygon_raster_engine::on_new_polygon()
+{
+	dirty_region.add_point(pixel_type(0, 0));
+	dirty_region.add_point(pixel_type(int(img_width) - 1, int(img_height) - 1));
+}
+
+int polygon_raster_engine::compute_crossing(const edge_type& e, int row) const
+{
+	float x = e.x0 + (float(row) + 0.5f - e.y0)*e.dxdy;
+	// pixel centers x+0.5 >= crossing are right of the edge; clamp before integer conversion
+	float x_px = std::ceil(x - 0.5f);
+	if (x_px < 0)
+		return 0;
+	if (x_px > float(img_width))
+		return int(img_width);
+	return int(x_px);
+}
+
+bool polygon_raster_engine::is_inside(int winding) const
+{
+	if (fill_rule == FR_EVEN_ODD)
+		return (winding & 1) != 0;
+	return winding != 0;
+}
+
+bool polygon_raster_engine::prepare_edge(const vtx_type& q0, const vtx_type& q1, int row_begin, int row_end, edge_type& e) const
+{
+	vtx_type p0 = pixel_from_world(q0);
+	vtx_type p1 = pixel_from_world(q1);
+	e.winding = 1;
+	if (p0(1) > p1(1)) {
+		std::swap(p0, p1);
+		e.winding = -1;
+	}
+	// rows whose center lies in [p0(1),p1(1)), which excludes horizontal edges
+	float edge_row_begin = std::max(std::ceil(p0(1) - 0.5f), float(row_begin));
+	float edge_row_end = std::min(std::ceil(p1(1) - 0.5f), float(row_end));
+	if (edge_row_begin >= edge_row_end)
+		return false;
+	e.row_begin = int(edge_row_begin);
+	e.row_end = int(edge_row_end);
+	e.x0 = p0(0);
+	e.y0 = p0(1);
+	e.dxdy = (p1(0) - p0(0)) / (p1(1) - p0(1));
+	// conservative range of crossing columns with one pixel margin for rounding
+	float x_min = std::min(p0(0), p1(0)), x_max = std::max(p0(0), p1(0));
+	e.x_begin = int(std::min(std::max(std::ceil(x_min - 0.5f) - 1, 0.0f), float(img_width)));
+	e.x_end = int(std::min(std::max(std::ceil(x_max - 0.5f) + 1, 0.0f), float(img_width)));
+	return true;
+}
+
+void polygon_raster_engine::add_table_edge(const vtx_type& q0, const vtx_type& q1, int row_begin, int row_end)
+{
+	edge_type e;
+	if (!prepare_edge(q0, q1, row_begin, row_end, e))
+		return;
+	next_edge.push_back(edge_table[e.row_begin]);
+	edge_table[e.row_begin] = edges.size();
+	edges.push_back(e);
+}
+
+void polygon_raster_engine::build_edge_table(int row_begin, int row_end)
+{
+	edges.clear();
+	edge_table.assign(img_height, size_t(-1));
+	next_edge.clear();
+	if (edge_subset) {
+		for (size_t i = 0; i < edge_subset->size(); ++i)
+			add_table_edge(sparse_edges[(*edge_subset)[i]].q0, sparse_edges[(*edge_subset)[i]].q1, row_begin, row_end);
+		return;
+	}
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		// open loops have undefined orientation and do not bound an area; for the nonzero rule
+		// CW loops contribute negative winding and therefore cut holes into CCW loops
+		if (poly.loop_orientation(li) == PO_UNDEF)
+			continue;
+		size_t vi_last = poly.loop_end(li) - 1;
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi) {
+			add_table_edge(poly.vertex(vi_last), poly.vertex(vi), row_begin, row_end);
+			vi_last = vi;
+		}
+	}
+}
+
+void polygon_raster_engine::fill_span(int row, int x_begin, int x_end, const raster_pattern& pattern)
+{
+	raster_kernels::fill_row(&img[linear_index(pixel_type(x_begin, row))], x_end - x_begin, pattern);
+}
+
+void polygon_raster_engine::scan_convert(const pixel_box_type& region)
+{
+	int x_min = region.get_min_pnt()(0), x_max = region.get_max_pnt()(0) + 1;
+	active_edges.clear();
+	for (int y = region.get_min_pnt()(1); y <= region.get_max_pnt()(1); ++y) {
+		if (is_cancelled())
+			return;
+		// remove edges ending before this row and update crossings of remaining ones
+		size_t nr_active = 0;
+		for (size_t ai = 0; ai < active_edges.size(); ++ai) {
+			const edge_type& e = edges[active_edges[ai].edge_idx];
+			if (e.row_end <= y)
+				continue;
+			active_edges[nr_active] = active_edges[ai];
+			active_edges[nr_active].x = compute_crossing(e, y);
+			++nr_active;
+		}
+		active_edges.resize(nr_active);
+		// activate edges starting in this row
+		for (size_t ei = edge_table[y]; ei != size_t(-1); ei = next_edge[ei]) {
+			crossing_type c;
+			c.x = compute_crossing(edges[ei], y);
+			c.winding = edges[ei].winding;
+			c.edge_idx = ei;
+			active_edges.push_back(c);
+		}
+		// crossings change little from row to row, such that insertion sort is close to linear
+		for (size_t ai = 1; ai < active_edges.size(); ++ai) {
+			crossing_type c = active_edges[ai];
+			size_t aj = ai;
+			for (; aj > 0 && active_edges[aj - 1].x > c.x; --aj)
+				active_edges[aj] = active_edges[aj - 1];
+			active_edges[aj] = c;
+		}
+		// fill spans between crossings that are inside
+		int winding = 0;
+		for (size_t ai = 0; ai + 1 < active_edges.size(); ++ai) {
+			winding += active_edges[ai].winding;
+			if (!is_inside(winding))
+				continue;
+			int x_begin = std::max(active_edges[ai].x, x_min);
+			int x_end = std::min(active_edges[ai + 1].x, x_max);
+			if (x_begin < x_end)
+				fill_span(y, x_begin, x_end, fg_pattern);
+		}
+	}
+}
+
+void polygon_raster_engine::add_coverage_edge(const vtx_type& q0, const vtx_type& q1, int row_begin, int row_end)
+{
+	coverage_edge_type e;
+	e.p0 = pixel_from_world(q0);
+	e.p1 = pixel_from_world(q1);
+	e.winding = 1;
+	if (e.p0(1) > e.p1(1)) {
+		std::swap(e.p0, e.p1);
+		e.winding = -1;
+	}
+	// rows overlapped by the open interval (p0(1),p1(1)), which excludes horizontal edges
+	float edge_row_begin = std::max(std::floor(e.p0(1)), float(row_begin));
+	float edge_row_end = std::min(std::ceil(e.p1(1)), float(row_end));
+	if (edge_row_begin >= edge_row_end || e.p0(1) == e.p1(1))
+		return;
+	e.row_begin = int(edge_row_begin);
+	e.row_end = int(edge_row_end);
+	e.dxdy = (e.p1(0) - e.p0(0)) / (e.p1(1) - e.p0(1));
+	next_edge.push_back(edge_table[e.row_begin - row_begin]);
+	edge_table[e.row_begin - row_begin] = coverage_edges.size();
+	coverage_edges.push_back(e);
+}
+
+void polygon_raster_engine::build_coverage_edge_table(int row_begin, int row_end)
+{
+	coverage_edges.clear();
+	edge_table.assign(std::max(row_end - row_begin, 0), size_t(-1));
+	next_edge.clear();
+	if (edge_subset) {
+		for (size_t i = 0; i < edge_subset->size(); ++i)
+			add_coverage_edge(sparse_edges[(*edge_subset)[i]].q0, sparse_edges[(*edge_subset)[i]].q1, row_begin, row_end);
+		return;
+	}
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		if (poly.loop_orientation(li) == PO_UNDEF)
+			continue;
+		size_t vi_last = poly.loop_end(li) - 1;
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi) {
+			add_coverage_edge(poly.vertex(vi_last), poly.vertex(vi), row_begin, row_end);
+			vi_last = vi;
+		}
+	}
+}
+
+void polygon_raster_engine::accumulate_segment(float* acc, float xa, float xb, float d)
+{
+	// distribute the area left of the segment over the pixels it passes, such that the prefix sum over a row
+	// yields the signed coverage of each pixel
+	float x0 = std::min(xa, xb), x1 = std::max(xa, xb);
+	float x0_floor = std::floor(x0), x1_ceil = std::ceil(x1);
+	int x0i = int(x0_floor), x1i = int(x1_ceil);
+	if (x1i <= x0i + 1) {
+		// segment within a single pixel column
+		float xm = 0.5f*(xa + xb) - x0_floor;
+		acc[x0i] += d - d*xm;
+		acc[x0i + 1] += d*xm;
+		return;
+	}
+	float s = 1.0f / (x1 - x0);
+	float x0f = x0 - x0_floor;
+	float a0 = 0.5f*s*(1 - x0f)*(1 - x0f);
+	float x1f = x1 - x1_ceil + 1;
+	float am = 0.5f*s*x1f*x1f;
+	acc[x0i] += d*a0;
+	if (x1i == x0i + 2)
+		acc[x0i + 1] += d*(1 - a0 - am);
+	else {
+		float a1 = s*(1.5f - x0f);
+		acc[x0i + 1] += d*(a1 - a0);
+		for (int xi = x0i + 2; xi < x1i - 1; ++xi)
+			acc[xi] += d*s;
+		float a2 = a1 + float(x1i - x0i - 3)*s;
+		acc[x1i - 1] += d*(1 - a2 - am);
+	}
+	acc[x1i] += d*am;
+}
+
+void polygon_raster_engine::accumulate_clipped_segment(float* acc, float xa, float xb, float d, float x_min, float x_max)
+{
+	// parts left of x_min cover the whole row and are moved onto x_min, parts right of x_max do not matter and are moved onto x_max
+	float t_split[4] = { 0, 0, 0, 1 };
+	int n = 1;
+	if (xa != xb) {
+		float t_min = (x_min - xa) / (xb - xa), t_max = (x_max - xa) / (xb - xa);
+		if (t_min > t_max)
+			std::swap(t_min, t_max);
+		if (t_min > 0 && t_min < 1)
+			t_split[n++] = t_min;
+		if (t_max > 0 && t_max < 1)
+			t_split[n++] = t_max;
+	}
+	t_split[n] = 1;
+	for (int i = 0; i < n; ++i) {
+		float x_begin = std::min(std::max(xa + t_split[i] * (xb - xa), x_min), x_max);
+		float x_end = std::min(std::max(xa + t_split[i + 1] * (xb - xa), x_min), x_max);
+		accumulate_segment(acc, x_begin, x_end, d*(t_split[i + 1] - t_split[i]));
+	}
+}
+
+float polygon_raster_engine::coverage_from_area(float area) const
+{
+	area = std::abs(area);
+	if (fill_rule == FR_EVEN_ODD) {
+		area = std::fmod(area, 2.0f);
+		if (area > 1)
+			area = 2 - area;
+		return area;
+	}
+	return std::min(area, 1.0f);
+}
+
+void polygon_raster_engine::blend_coverage_row(clr_type* row, int x, int y, const float* acc, size_t width)
+{
+	// single prefix sum pass converts area contributions to coverage
+	float area = 0;
+	for (size_t xi = 0; xi < width; ++xi) {
+		area += acc[xi];
+		const clr_type& bg = bg_clr[(x + xi + y) & 1];
+		int alpha = int(coverage_from_area(area)*255 + 0.5f);
+		if (alpha <= 0)
+			row[xi] = bg;
+		else if (alpha >= 255)
+			row[xi] = fg_clr;
+		else
+			row[xi] = blend_foreground(bg, alpha);
+	}
+}
+
+polygon_raster_engine::clr_type polygon_raster_engine::blend_foreground(const clr_type& bg, int alpha) const
+{
+	clr_type c;
+	for (unsigned ci = 0; ci < 3; ++ci)
+		c[ci] = cgv::type::uint8_type((int(bg[ci])*(255 - alpha) + int(fg_clr[ci])*alpha + 127) / 255);
+	return c;
+}
+
+void polygon_raster_engine::rasterize_region_analytic(const pixel_box_type& region)
+{
+	build_coverage_edge_table(region.get_min_pnt()(1), region.get_max_pnt()(1) + 1);
+	rasterize_rows_analytic(region);
+}
+
+void polygon_raster_engine::rasterize_rows_analytic(const pixel_box_type& region)
+{
+	int x_min = region.get_min_pnt()(0), x_max = region.get_max_pnt()(0) + 1;
+	int y_min = region.get_min_pnt()(1), y_max = region.get_max_pnt()(1) + 1;
+	size_t width = x_max - x_min;
+	// one extra entry for the right region border and one as guard for contributions to the right neighbor
+	coverage_row.resize(width + 2);
+	std::vector<size_t> active;
+	for (int y = y_min; y < y_max; ++y) {
+		if (is_cancelled())
+			return;
+		size_t nr_active = 0;
+		for (size_t ai = 0; ai < active.size(); ++ai)
+			if (coverage_edges[active[ai]].row_end > y)
+				active[nr_active++] = active[ai];
+		active.resize(nr_active);
+		for (size_t ei = edge_table[y - y_min]; ei != size_t(-1); ei = next_edge[ei])
+			active.push_back(ei);
+		clr_type* row = &img[linear_index(pixel_type(x_min, y))];
+		if (active.empty()) {
+			raster_kernels::fill_row(row, width, bg_pattern[(x_min + y) & 1]);
+			continue;
+		}
+		std::fill(coverage_row.begin(), coverage_row.end(), 0.0f);
+		for (size_t ai = 0; ai < active.size(); ++ai) {
+			const coverage_edge_type& e = coverage_edges[active[ai]];
+			float ya = std::max(e.p0(1), float(y)), yb = std::min(e.p1(1), float(y + 1));
+			float xa = e.p0(0) + (ya - e.p0(1))*e.dxdy - x_min;
+			float xb = e.p0(0) + (yb - e.p0(1))*e.dxdy - x_min;
+			accumulate_clipped_segment(&coverage_row[0], xa, xb, (yb - ya)*e.winding, 0, float(width));
+		}
+		blend_coverage_row(row, x_min, y, &coverage_row[0], width);
+	}
+}
+
+int polygon_raster_engine::compute_filter_taps(float offset, int* shifts, float* weights) const
+{
+	if (resolve_filter == RF_BOX) {
+		shifts[0] = 0;
+		weights[0] = 1;
+		return 1;
+	}
+	// a sample at offset within pixel q is at distance offset - 0.5 - d from the center of pixel q + d
+	int nr_taps = 0;
+	for (int d = -1; d <= 1; ++d) {
+		float w = 1 - std::abs(offset - 0.5f - float(d));
+		if (w <= 0)
+			continue;
+		shifts[nr_taps] = d;
+		weights[nr_taps++] = w;
+	}
+	return nr_taps;
+}
+
+void polygon_raster_engine::prepare_sample_rows()
+{
+	static const float rotated_grid[4][2] = { { 0.375f, 0.125f }, { 0.875f, 0.375f }, { 0.125f, 0.625f }, { 0.625f, 0.875f } };
+	sample_rows.clear();
+	int n = sample_pattern == SP_GRID_2X2 ? 2 : 4;
+	for (int r = 0; r < n; ++r) {
+		sample_row_type sr;
+		if (sample_pattern == SP_ROTATED_GRID) {
+			sr.y = rotated_grid[r][1];
+			sr.nr_samples = 1;
+			sr.x[0] = rotated_grid[r][0];
+		}
+		else {
+			sr.y = (r + 0.5f) / n;
+			sr.nr_samples = n;
+			for (int c = 0; c < n; ++c)
+				sr.x[c] = (c + 0.5f) / n;
+		}
+		int y_shift[3], x_shift[3];
+		float y_weight[3], x_weight[3];
+		int nr_y_taps = compute_filter_taps(sr.y, y_shift, y_weight);
+		for (int m = 0; m <= sr.nr_samples; ++m) {
+			// a border at floor(x) + f with m samples left of f starts the samples of pixel floor(x) + 1 for these and of pixel floor(x) for the others,
+			// whose taps go to the accumulator columns shifted by one
+			float weights[3][4] = { { 0 } };
+			for (int si = 0; si < sr.nr_samples; ++si) {
+				int nr_x_taps = compute_filter_taps(sr.x[si], x_shift, x_weight);
+				for (int ty = 0; ty < nr_y_taps; ++ty)
+					for (int tx = 0; tx < nr_x_taps; ++tx)
+						weights[y_shift[ty] + 1][(si < m ? 1 : 0) + 1 + x_shift[tx]] += y_weight[ty] * x_weight[tx];
+			}
+			sr.nr_deltas[m] = 0;
+			for (int dy = 0; dy < 3; ++dy)
+				for (int dx = 0; dx < 4; ++dx)
+					if (weights[dy][dx] != 0) {
+						int i = sr.nr_deltas[m]++;
+						sr.delta_row[m][i] = dy - 1;
+						sr.delta_column[m][i] = dx;
+						sr.delta_weight[m][i] = weights[dy][dx];
+					}
+		}
+		sample_rows.push_back(sr);
+	}
+	nr_samples_per_pixel = sample_pattern == SP_ROTATED_GRID ? 4 : n*n;
+}
+
+polygon_raster_engine::sample_accumulator_type& polygon_raster_engine::get_sample_accumulator(int y)
+{
+	return sample_accumulators[(y % 3 + 3) % 3];
+}
+
+void polygon_raster_engine::add_sample_delta(sample_accumulator_type& acc, int column, float delta)
+{
+	acc.deltas[column] += delta;
+	if (!acc.touched[column]) {
+		acc.touched[column] = 1;
+		acc.columns.push_back(column);
+	}
+}
+
+void polygon_raster_engine::accumulate_sample_border(const sample_row_type& sr, int y, float x, float sign)
+{
+	float x_floor = std::floor(x), f = x - x_floor;
+	int m = 0;
+	while (m < sr.nr_samples && sr.x[m] < f)
+		++m;
+	int column = int(x_floor);
+	for (int i = 0; i < sr.nr_deltas[m]; ++i)
+		add_sample_delta(get_sample_accumulator(y + sr.delta_row[m][i]), column + sr.delta_column[m][i], sign*sr.delta_weight[m][i]);
+}
+
+void polygon_raster_engine::accumulate_sample_span(const sample_row_type& sr, int y, float xa, float xb, int nr_cols)
+{
+	// samples left of the processed columns belong to column 0 and samples right of them are dropped, which is the same as clamping the span
+	xa = std::min(std::max(xa, 0.0f), float(nr_cols));
+	xb = std::min(std::max(xb, 0.0f), float(nr_cols));
+	if (xa >= xb)
+		return;
+	accumulate_sample_border(sr, y, xa, 1.0f);
+	accumulate_sample_border(sr, y, xb, -1.0f);
+}
+
+void polygon_raster_engine::write_sample_run(int y, int x_begin, int x_end, float count)
+{
+	int alpha = int(count*255 / nr_samples_per_pixel + 0.5f);
+	if (alpha <= 0)
+		fill_span(y, x_begin, x_end, bg_pattern[(x_begin + y) & 1]);
+	else if (alpha >= 255)
+		fill_span(y, x_begin, x_end, fg_pattern);
+	else {
+		clr_type c[2] = { blend_foreground(bg_clr[(x_begin + y) & 1], alpha), blend_foreground(bg_clr[(x_begin + y + 1) & 1], alpha) };
+		// runs of partially covered pixels are mostly short, such that preparing a pattern only pays off for long runs
+		if (x_end - x_begin <= 8) {
+			clr_type* row = &img[linear_index(pixel_type(x_begin, y))];
+			for (int x = 0; x < x_end - x_begin; ++x)
+				row[x] = c[x & 1];
+		}
+		else
+			fill_span(y, x_begin, x_end, raster_pattern(c[0], c[1]));
+	}
+}
+
+void polygon_raster_engine::resolve_sample_row(sample_accumulator_type& acc, int y, int base_x, int x_min, int x_max, bool write)
+{
+	std::sort(acc.columns.begin(), acc.columns.end());
+	// the filtered count is constant between touched columns, such that runs are written with the row kernels
+	float count = 0;
+	int x = x_min;
+	for (size_t i = 0; i < acc.columns.size(); ++i) {
+		int column = acc.columns[i];
+		int px = base_x + column - 1;
+		if (px > x) {
+			if (write && x < x_max)
+				write_sample_run(y, x, std::min(px, x_max), count);
+			x = px;
+		}
+		count += acc.deltas[column];
+		acc.deltas[column] = 0;
+		acc.touched[column] = 0;
+	}
+	if (write && x < x_max)
+		write_sample_run(y, x, x_max, count);
+	acc.columns.clear();
+}
+
+int polygon_raster_engine::sample_margin() const
+{
+	return resolve_filter == RF_TENT ? 1 : 0;
+}
+
+void polygon_raster_engine::rasterize_region_supersampled(const pixel_box_type& region)
+{
+	prepare_sample_rows();
+	build_coverage_edge_table(region.get_min_pnt()(1) - sample_margin(), region.get_max_pnt()(1) + 1 + sample_margin());
+	rasterize_rows_supersampled(region);
+}
+
+void polygon_raster_engine::rasterize_rows_supersampled(const pixel_box_type& region)
+{
+	int x_min = region.get_min_pnt()(0), x_max = region.get_max_pnt()(0) + 1;
+	int y_min = region.get_min_pnt()(1), y_max = region.get_max_pnt()(1) + 1;
+	// the tent filter reaches the samples of the pixels around the region, which are taken from the polygon also beyond the image
+	int margin = sample_margin();
+	int base_x = x_min - margin, nr_cols = x_max - x_min + 2 * margin;
+	int row_begin = y_min - margin, row_end = y_max + margin;
+	for (int i = 0; i < 3; ++i) {
+		sample_accumulators[i].deltas.assign(nr_cols + 3, 0.0f);
+		sample_accumulators[i].touched.assign(nr_cols + 3, 0);
+		sample_accumulators[i].columns.clear();
+	}
+	// crossings stay sorted from one sample row to the next up to a few swaps, while edges starting in a row wait until their first sample row
+	sample_crossings.clear();
+	std::vector<size_t> pending;
+	for (int y = row_begin; y < row_end; ++y) {
+		if (is_cancelled())
+			return;
+		for (size_t ei = edge_table[y - row_begin]; ei != size_t(-1); ei = next_edge[ei])
+			pending.push_back(ei);
+		for (size_t ri = 0; ri < sample_rows.size(); ++ri) {
+			const sample_row_type& sr = sample_rows[ri];
+			float ys = float(y) + sr.y;
+			size_t nr_crossings = 0;
+			for (size_t ci = 0; ci < sample_crossings.size(); ++ci)
+				if (coverage_edges[sample_crossings[ci].edge_idx].p1(1) > ys)
+					sample_crossings[nr_crossings++] = sample_crossings[ci];
+			sample_crossings.resize(nr_crossings);
+			size_t nr_pending = 0;
+			for (size_t pi = 0; pi < pending.size(); ++pi) {
+				const coverage_edge_type& e = coverage_edges[pending[pi]];
+				if (e.p1(1) <= ys)
+					continue;
+				if (e.p0(1) > ys) {
+					pending[nr_pending++] = pending[pi];
+					continue;
+				}
+				sample_crossing_type c;
+				c.winding = int(e.winding);
+				c.edge_idx = pending[pi];
+				sample_crossings.push_back(c);
+			}
+			pending.resize(nr_pending);
+			for (size_t ci = 0; ci < sample_crossings.size(); ++ci) {
+				const coverage_edge_type& e = coverage_edges[sample_crossings[ci].edge_idx];
+				sample_crossings[ci].x = e.p0(0) + (ys - e.p0(1))*e.dxdy - base_x;
+			}
+			for (size_t ci = 1; ci < sample_crossings.size(); ++ci) {
+				sample_crossing_type c = sample_crossings[ci];
+				size_t cj = ci;
+				for (; cj > 0 && sample_crossings[cj - 1].x > c.x; --cj)
+					sample_crossings[cj] = sample_crossings[cj - 1];
+				sample_crossings[cj] = c;
+			}
+			int winding = 0;
+			for (size_t ci = 0; ci + 1 < sample_crossings.size(); ++ci) {
+				winding += sample_crossings[ci].winding;
+				if (is_inside(winding))
+					accumulate_sample_span(sr, y, sample_crossings[ci].x, sample_crossings[ci + 1].x, nr_cols);
+			}
+		}
+		// after the samples of row y no further samples reach row y - margin
+		int y_done = y - margin;
+		resolve_sample_row(get_sample_accumulator(y_done), y_done, base_x, x_min, x_max, y_done >= y_min);
+	}
+}
+
+void polygon_raster_engine::rasterize_region(const pixel_box_type& region)
+{
+	if (raster_mode == RM_DISTANCE) {
+		rasterize_distance_field();
+		return;
+	}
+	prepare_patterns();
+	// the tent filter spreads changed samples into the neighboring pixels
+	pixel_box_type changed_region = region;
+	if (raster_mode == RM_SUPERSAMPLED && resolve_filter == RF_TENT) {
+		changed_region.add_point(pixel_type(std::max(region.get_min_pnt()(0) - 1, 0), std::max(region.get_min_pnt()(1) - 1, 0)));
+		changed_region.add_point(pixel_type(std::min(region.get_max_pnt()(0) + 1, int(img_width) - 1), std::min(region.get_max_pnt()(1) + 1, int(img_height) - 1)));
+	}
+	rasterize_pixels(changed_region);
+	upload_region.add_point(changed_region.get_min_pnt());
+	upload_region.add_point(changed_region.get_max_pnt());
+}
+
+void polygon_raster_engine::rasterize_pixels(const pixel_box_type& region)
+{
+	if (raster_mode == RM_SUPERSAMPLED)
+		rasterize_region_supersampled(region);
+	else if (raster_mode == RM_ANALYTIC)
+		rasterize_region_analytic(region);
+	else if (use_tiled_rasterization)
+		rasterize_region_tiled(region);
+	else {
+		clear_image(region);
+		build_edge_table(region.get_min_pnt()(1), region.get_max_pnt()(1) + 1);
+		scan_convert(region);
+	}
+}
+
+int polygon_raster_engine::tile_column(const pixel_box_type& region, int x) const
+{
+	if (x < region.get_min_pnt()(0))
+		return 0;
+	if (x > region.get_max_pnt()(0))
+		return nr_tile_cols;
+	return x / tile_size - region.get_min_pnt()(0) / tile_size;
+}
+
+void polygon_raster_engine::bin_band(const pixel_box_type& region, int band_idx)
+{
+	tile_type* band_tiles = &tiles[band_idx*nr_tile_cols];
+	int y_begin = band_tiles[0].region.get_min_pnt()(1);
+	int y_end = band_tiles[0].region.get_max_pnt()(1) + 1;
+	for (int c = 0; c < nr_tile_cols; ++c) {
+		band_tiles[c].edges.clear();
+		band_tiles[c].winding_offsets.assign(y_end - y_begin, 0);
+	}
+	const std::vector<size_t>& band = band_edges[band_idx];
+	for (size_t bi = 0; bi < band.size(); ++bi) {
+		const edge_type& e = edges[band[bi]];
+		// tiles right of x_begin and left of x_end can be crossed by the edge
+		int c_begin = tile_column(region, e.x_begin);
+		int c_left = e.x_end <= region.get_min_pnt()(0) ? 0 : std::min(tile_column(region, e.x_end - 1) + 1, nr_tile_cols);
+		for (int c = c_begin; c < c_left; ++c)
+			band_tiles[c].edges.push_back(band[bi]);
+		// for all tiles further right the edge is left of the tile
+		if (c_left < nr_tile_cols) {
+			std::vector<int>& offsets = band_tiles[c_left].winding_offsets;
+			for (int y = std::max(e.row_begin, y_begin); y < std::min(e.row_end, y_end); ++y)
+				offsets[y - y_begin] += e.winding;
+		}
+	}
+	// propagate winding offsets to the right
+	for (int c = 1; c < nr_tile_cols; ++c)
+		for (size_t ri = 0; ri < band_tiles[c].winding_offsets.size(); ++ri)
+			band_tiles[c].winding_offsets[ri] += band_tiles[c - 1].winding_offsets[ri];
+}
+
+void polygon_raster_engine::rasterize_tile(size_t tile_idx)
+{
+	if (is_cancelled())
+		return;
+	tile_type& tile = tiles[tile_idx];
+	clear_image(tile.region);
+	int x_begin = tile.region.get_min_pnt()(0), x_end = tile.region.get_max_pnt()(0) + 1;
+	// process edges in order of their first row with a tile local active edge list
+	std::sort(tile.edges.begin(), tile.edges.end(), [this](size_t ei, size_t ej) { return edges[ei].row_begin < edges[ej].row_begin; });
+	std::vector<size_t> active;
+	std::vector<std::pair<int, int> > crossings;
+	size_t next_ti = 0;
+	for (int y = tile.region.get_min_pnt()(1); y <= tile.region.get_max_pnt()(1); ++y) {
+		size_t nr_active = 0;
+		for (size_t ai = 0; ai < active.size(); ++ai)
+			if (edges[active[ai]].row_end > y)
+				active[nr_active++] = active[ai];
+		active.resize(nr_active);
+		for (; next_ti < tile.edges.size() && edges[tile.edges[next_ti]].row_begin <= y; ++next_ti)
+			if (edges[tile.edges[next_ti]].row_end > y)
+				active.push_back(tile.edges[next_ti]);
+		int winding = tile.winding_offsets[y - tile.region.get_min_pnt()(1)];
+		crossings.clear();
+		for (size_t ai = 0; ai < active.size(); ++ai) {
+			const edge_type& e = edges[active[ai]];
+			// same crossing computation as scan_convert such that both paths produce identical images
+			int x = compute_crossing(e, y);
+			if (x <= x_begin)
+				winding += e.winding;
+			else if (x < x_end)
+				crossings.push_back(std::make_pair(x, e.winding));
+		}
+		std::sort(crossings.begin(), crossings.end());
+		int x = x_begin;
+		for (size_t ci = 0; ci < crossings.size(); ++ci) {
+			if (is_inside(winding) && x < crossings[ci].first)
+				fill_span(y, x, crossings[ci].first, fg_pattern);
+			winding += crossings[ci].second;
+			x = crossings[ci].first;
+		}
+		if (is_inside(winding) && x < x_end)
+			fill_span(y, x, x_end, fg_pattern);
+	}
+}
+
+void polygon_raster_engine::rasterize_region_tiled(const pixel_box_type& region)
+{
+	build_edge_table(region.get_min_pnt()(1), region.get_max_pnt()(1) + 1);
+	// tiles are aligned to a global grid and clipped to the region
+	int x0 = region.get_min_pnt()(0), y0 = region.get_min_pnt()(1);
+	int x1 = region.get_max_pnt()(0) + 1, y1 = region.get_max_pnt()(1) + 1;
+	nr_tile_cols = (x1 - 1) / tile_size - x0 / tile_size + 1;
+	nr_tile_rows = (y1 - 1) / tile_size - y0 / tile_size + 1;
+	tiles.resize(nr_tile_cols*nr_tile_rows);
+	for (int r = 0; r < nr_tile_rows; ++r)
+		for (int c = 0; c < nr_tile_cols; ++c) {
+			int tx = (x0 / tile_size + c)*tile_size, ty = (y0 / tile_size + r)*tile_size;
+			tiles[r*nr_tile_cols + c].region = pixel_box_type(
+				pixel_type(std::max(tx, x0), std::max(ty, y0)),
+				pixel_type(std::min(tx + tile_size, x1) - 1, std::min(ty + tile_size, y1) - 1));
+		}
+	// sort edges into tile rows
+	band_edges.resize(nr_tile_rows);
+	for (int r = 0; r < nr_tile_rows; ++r)
+		band_edges[r].clear();
+	for (size_t ei = 0; ei < edges.size(); ++ei) {
+		int r_begin = edges[ei].row_begin / tile_size - y0 / tile_size;
+		int r_end = (edges[ei].row_end - 1) / tile_size - y0 / tile_size;
+		for (int r = r_begin; r <= r_end; ++r)
+			band_edges[r].push_back(ei);
+	}
+	if (!pool)
+		pool.reset(new thread_pool());
+	pool->parallel_for(nr_tile_rows, [&](size_t r) { bin_band(region, int(r)); });
+	pool->parallel_for(tiles.size(), [this](size_t ti) { rasterize_tile(ti); });
+}
+
+void polygon_raster_engine::accumulate_stream_edge(const vtx_type& q0, const vtx_type& q1)
+{
+	if (raster_mode == RM_ANALYTIC) {
+		vtx_type p0 = pixel_from_world(q0);
+		vtx_type p1 = pixel_from_world(q1);
+		float winding = 1;
+		if (p0(1) > p1(1)) {
+			std::swap(p0, p1);
+			winding = -1;
+		}
+		if (p0(1) == p1(1))
+			return;
+		int row_begin = int(std::min(std::max(std::floor(p0(1)), 0.0f), float(img_height)));
+		int row_end = int(std::min(std::max(std::ceil(p1(1)), 0.0f), float(img_height)));
+		float dxdy = (p1(0) - p0(0)) / (p1(1) - p0(1));
+		size_t stride = img_width + 2;
+		for (int y = row_begin; y < row_end; ++y) {
+			float ya = std::max(p0(1), float(y)), yb = std::min(p1(1), float(y + 1));
+			float xa = p0(0) + (ya - p0(1))*dxdy;
+			float xb = p0(0) + (yb - p0(1))*dxdy;
+			accumulate_clipped_segment(&area_deltas[y*stride], xa, xb, (yb - ya)*winding, 0, float(img_width));
+		}
+		return;
+	}
+	edge_type e;
+	if (!prepare_edge(q0, q1, 0, int(img_height), e))
+		return;
+	// crossings right of the image fall into the extra column of each row
+	size_t stride = img_width + 1;
+	for (int y = e.row_begin; y < e.row_end; ++y)
+		winding_deltas[y*stride + compute_crossing(e, y)] += e.winding;
+}
+
+bool polygon_raster_engine::rasterize_stream(polygon_stream& stream, const std::string& file_name)
+{
+	if (raster_mode == RM_SUPERSAMPLED) {
+		last_error = file_name + ": supersampled rasterization of polygon streams is not supported";
+		return false;
+	}
+	prepare_patterns();
+	bool analytic = raster_mode == RM_ANALYTIC;
+	if (analytic)
+		area_deltas.assign(img_height*(img_width + 2), 0.0f);
+	else
+		winding_deltas.assign(img_height*(img_width + 1), 0);
+	// edges are accumulated independently of each other, such that only the first and the previous vertex of the current loop need to be kept
+	bool accumulate_loop = false;
+	vtx_type first_vtx, last_vtx;
+	bool success = stream.read(file_name, [&](const polygon_chunk& chunk) {
+		if (chunk.begins_loop) {
+			// loops that turn out to have less than three vertices in their last chunk contribute canceling edges
+			accumulate_loop = chunk.is_closed;
+			first_vtx = last_vtx = chunk.vertices[0];
+		}
+		if (!accumulate_loop)
+			return true;
+		for (size_t vi = 0; vi < chunk.nr_vertices; ++vi) {
+			accumulate_stream_edge(last_vtx, chunk.vertices[vi]);
+			last_vtx = chunk.vertices[vi];
+		}
+		if (chunk.ends_loop)
+			accumulate_stream_edge(last_vtx, first_vtx);
+		return true;
+	});
+	if (success && raster_mode == RM_DISTANCE)
+		compute_distance_field();
+	else if (success) {
+		// prefix sums along the rows yield winding numbers or coverage
+		int width = int(img_width);
+		for (int y = 0; y < int(img_height); ++y) {
+			clr_type* row = &img[linear_index(pixel_type(0, y))];
+			if (analytic) {
+				blend_coverage_row(row, 0, y, &area_deltas[y*(img_width + 2)], img_width);
+				continue;
+			}
+			raster_kernels::fill_row(row, img_width, bg_pattern[y & 1]);
+			const int* deltas = &winding_deltas[y*(img_width + 1)];
+			int winding = 0, span_begin = -1;
+			for (int x = 0; x < width; ++x) {
+				winding += deltas[x];
+				bool inside = is_inside(winding);
+				if (inside && span_begin == -1)
+					span_begin = x;
+				else if (!inside && span_begin != -1) {
+					fill_span(y, span_begin, x, fg_pattern);
+					span_begin = -1;
+				}
+			}
+			if (span_begin != -1)
+				fill_span(y, span_begin, width, fg_pattern);
+		}
+	}
+	if (!success)
+		last_error = stream.get_last_error();
+	else {
+		dirty_region.invalidate();
+		upload_region.add_point(pixel_type(0, 0));
+		upload_region.add_point(pixel_type(int(img_width) - 1, int(img_height) - 1));
+	}
+	// release accumulation buffers, which are as large as the image
+	std::vector<int>().swap(winding_deltas);
+	std::vector<float>().swap(area_deltas);
+	return success;
+}
+
+void polygon_raster_engine::initialize_column_distances(int row_begin, int row_end)
+{
+	const float inf = std::numeric_limits<float>::infinity();
+	for (int y = row_begin; y < row_end; ++y) {
+		const int* deltas = &winding_deltas[y*(img_width + 1)];
+		float* outside_dist = &column_distances[0][y*img_width];
+		float* inside_dist = &column_distances[1][y*img_width];
+		int winding = 0;
+		for (size_t x = 0; x < img_width; ++x) {
+			winding += deltas[x];
+			bool inside = is_inside(winding);
+			outside_dist[x] = inside ? inf : 0.0f;
+			inside_dist[x] = inside ? 0.0f : inf;
+		}
+	}
+}
+
+void polygon_raster_engine::compute_column_distances(int col_begin, int col_end)
+{
+	// both sweeps run along whole rows of the strip, such that memory is accessed contiguously
+	for (int i = 0; i < 2; ++i) {
+		float* g = &column_distances[i][0];
+		for (size_t y = 1; y < img_height; ++y)
+			for (int x = col_begin; x < col_end; ++x)
+				g[y*img_width + x] = std::min(g[y*img_width + x], g[(y - 1)*img_width + x] + 1.0f);
+		for (size_t y = img_height - 1; y-- > 0; )
+			for (int x = col_begin; x < col_end; ++x)
+				g[y*img_width + x] = std::min(g[y*img_width + x], g[(y + 1)*img_width + x] + 1.0f);
+	}
+}
+
+void polygon_raster_engine::distance_transform(float* g, size_t n, float sqr_scale, std::vector<int>& v, std::vector<double>& z, std::vector<float>& f)
+{
+	f.assign(g, g + n);
+	v.resize(n);
+	z.resize(n);
+	// v holds the parabolas of the lower envelope and z[k] the location from which parabola v[k] is lowest
+	int k = -1;
+	for (int q = 0; q < int(n); ++q) {
+		if (f[q] == std::numeric_limits<float>::infinity())
+			continue;
+		double s = -std::numeric_limits<double>::infinity();
+		while (k >= 0) {
+			int r = v[k];
+			s = ((f[q] + sqr_scale*double(q)*q) - (f[r] + sqr_scale*double(r)*r)) / (2.0*sqr_scale*(q - r));
+			if (s > z[k])
+				break;
+			--k;
+			s = -std::numeric_limits<double>::infinity();
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+	}
+	if (k == -1)
+		return;
+	int last = k;
+	k = 0;
+	for (int x = 0; x < int(n); ++x) {
+		while (k < last && z[k + 1] < x)
+			++k;
+		float d = float(x - v[k]);
+		g[x] = sqr_scale*d*d + f[v[k]];
+	}
+}
+
+void polygon_raster_engine::compute_row_distances(int row_begin, int row_end)
+{
+	vtx_type pixel_size = img_extent.get_extent() / vtx_type(float(img_width), float(img_height));
+	float sqr_scale = pixel_size(0)*pixel_size(0);
+	float half_pixel = 0.5f*std::min(pixel_size(0), pixel_size(1));
+	std::vector<int> v;
+	std::vector<double> z;
+	std::vector<float> f;
+	for (int y = row_begin; y < row_end; ++y) {
+		float* dist[2] = { &column_distances[0][y*img_width], &column_distances[1][y*img_width] };
+		for (int i = 0; i < 2; ++i) {
+			for (size_t x = 0; x < img_width; ++x) {
+				float d = dist[i][x]*pixel_size(1);
+				dist[i][x] = d*d;
+			}
+			distance_transform(dist[i], img_width, sqr_scale, v, z, f);
+		}
+		// pixels inside have distance zero to the closest pixel inside
+		float* row = &distances[y*img_width];
+		for (size_t x = 0; x < img_width; ++x) {
+			if (dist[1][x] == 0)
+				row[x] = dist[0][x] == std::numeric_limits<float>::infinity() ? -FLT_MAX : half_pixel - std::sqrt(dist[0][x]);
+			else
+				row[x] = dist[1][x] == std::numeric_limits<float>::infinity() ? FLT_MAX : std::sqrt(dist[1][x]) - half_pixel;
+		}
+	}
+}
+
+void polygon_raster_engine::color_map_distances(int row_begin, int row_end)
+{
+	// saturation grows with the distance from the boundary and isolines darken the colors periodically
+	static const float colors[2][3] = { { 0.9f, 0.6f, 0.3f }, { 0.4f, 0.7f, 0.95f } };
+	const float two_pi = 6.2831853f;
+	vtx_type extent = img_extent.get_extent();
+	float falloff = 4.0f / std::max(extent(0), extent(1));
+	float pixel_size = extent(0) / img_width;
+	for (int y = row_begin; y < row_end; ++y) {
+		const float* row = &distances[y*img_width];
+		clr_type* pixels = &img[y*img_width];
+		for (size_t x = 0; x < img_width; ++x) {
+			float d = row[x];
+			const float* c = colors[d < 0 ? 1 : 0];
+			float a = std::abs(d);
+			float shade = (1.0f - 0.7f*std::exp(-falloff*a))*(0.85f + 0.15f*std::cos(two_pi*a / isoline_spacing));
+			// the boundary itself is drawn in white
+			float w = a < pixel_size ? 1.0f - a / pixel_size : 0.0f;
+			for (unsigned ci = 0; ci < 3; ++ci)
+				pixels[x][ci] = cgv::type::uint8_type(255.0f*std::min((1 - w)*c[ci]*shade + w, 1.0f));
+		}
+	}
+}
+
+void polygon_raster_engine::compute_distance_field()
+{
+	size_t nr_pixels = img_width*img_height;
+	distances.resize(nr_pixels);
+	if (nr_pixels == 0)
+		return;
+	for (int i = 0; i < 2; ++i)
+		column_distances[i].resize(nr_pixels);
+	if (!pool)
+		pool.reset(new thread_pool());
+	int nr_row_bands = int((img_height + tile_size - 1) / tile_size);
+	int nr_col_strips = int((img_width + tile_size - 1) / tile_size);
+	pool->parallel_for(nr_row_bands, [this](size_t b) {
+		initialize_column_distances(int(b)*tile_size, std::min(int(b + 1)*tile_size, int(img_height)));
+	});
+	if (!is_cancelled())
+		pool->parallel_for(nr_col_strips, [this](size_t s) {
+			compute_column_distances(int(s)*tile_size, std::min(int(s + 1)*tile_size, int(img_width)));
+		});
+	pool->parallel_for(nr_row_bands, [this](size_t b) {
+		if (is_cancelled())
+			return;
+		int row_begin = int(b)*tile_size, row_end = std::min(int(b + 1)*tile_size, int(img_height));
+		compute_row_distances(row_begin, row_end);
+		color_map_distances(row_begin, row_end);
+	});
+	// release buffers, which are as large as the image
+	for (int i = 0; i < 2; ++i)
+		std::vector<float>().swap(column_distances[i]);
+}
+
+void polygon_raster_engine::rasterize_distance_field()
+{
+	// the distances of all pixels can change with any edge, such that the whole image is recomputed
+	winding_deltas.assign(img_height*(img_width + 1), 0);
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		if (poly.loop_orientation(li) == PO_UNDEF)
+			continue;
+		size_t vi_last = poly.loop_end(li) - 1;
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi) {
+			accumulate_stream_edge(poly.vertex(vi_last), poly.vertex(vi));
+			vi_last = vi;
+		}
+	}
+	compute_distance_field();
+	std::vector<int>().swap(winding_deltas);
+	dirty_region.invalidate();
+	upload_region.add_point(pixel_type(0, 0));
+	upload_region.add_point(pixel_type(int(img_width) - 1, int(img_height) - 1));
+}
+
+void polygon_raster_engine::rasterize_polygon()
+{
+	dirty_region.invalidate();
+	rasterize_region(pixel_box_type(pixel_type(0, 0), pixel_type(int(img_width) - 1, int(img_height) - 1)));
+}
+
+bool polygon_raster_engine::rasterize_tiles(sparse_tile_image& target)
+{
+	if (raster_mode == RM_DISTANCE)
+		return false;
+	target.set_colors(bg_clr[0], bg_clr[1], fg_clr);
+	int ts = target.get_tile_size();
+	int nr_cols = int(target.get_nr_tile_cols()), nr_rows = int(target.get_nr_tile_rows());
+	// the rasterization paths work at the resolution of the target on a window of one tile row, while the dense image is put aside
+	std::vector<clr_type> dense_img;
+	dense_img.swap(img);
+	size_t dense_width = img_width, dense_height = img_height;
+	img_width = target.get_width();
+	img_height = target.get_height();
+	prepare_patterns();
+	// collect edges of closed loops in pixel coordinates and sort them into the tile rows they influence
+	sparse_edges.clear();
+	sparse_band_edges.resize(nr_rows);
+	for (int r = 0; r < nr_rows; ++r)
+		sparse_band_edges[r].clear();
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		if (poly.loop_orientation(li) == PO_UNDEF)
+			continue;
+		size_t vi_last = poly.loop_end(li) - 1;
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi) {
+			sparse_edge_type e;
+			e.q0 = poly.vertex(vi_last);
+			e.q1 = poly.vertex(vi);
+			e.p0 = pixel_from_world(e.q0);
+			e.p1 = pixel_from_world(e.q1);
+			vi_last = vi;
+			e.winding = 1;
+			if (e.p0(1) > e.p1(1)) {
+				std::swap(e.p0, e.p1);
+				e.winding = -1;
+			}
+			float r_begin = std::floor((e.p0(1) - edge_influence) / ts), r_end = std::floor((e.p1(1) + edge_influence) / ts);
+			if (r_end < 0 || r_begin >= nr_rows)
+				continue;
+			for (int r = std::max(int(r_begin), 0); r <= std::min(int(r_end), nr_rows - 1); ++r)
+				sparse_band_edges[r].push_back(sparse_edges.size());
+			sparse_edges.push_back(e);
+		}
+	}
+	if (raster_mode == RM_SUPERSAMPLED)
+		prepare_sample_rows();
+	bool cancelled = false;
+	for (int r = 0; r < nr_rows; ++r) {
+		if (is_cancelled()) {
+			cancelled = true;
+			break;
+		}
+		int y0 = r*ts, y1 = std::min(y0 + ts, int(img_height));
+		const std::vector<size_t>& band = sparse_band_edges[r];
+		// flag tiles that the edges clipped to the influenced rows come close to and record crossings with the center row of the band
+		touched_tiles.assign(nr_cols, 0);
+		band_crossings.clear();
+		float yc = 0.5f*(y0 + y1);
+		for (size_t bi = 0; bi < band.size(); ++bi) {
+			const sparse_edge_type& e = sparse_edges[band[bi]];
+			float ya = std::max(e.p0(1), float(y0 - edge_influence)), yb = std::min(e.p1(1), float(y1 + edge_influence));
+			float xa = e.p0(0), xb = e.p1(0);
+			if (e.p1(1) > e.p0(1)) {
+				float dxdy = (e.p1(0) - e.p0(0)) / (e.p1(1) - e.p0(1));
+				xa = e.p0(0) + (ya - e.p0(1))*dxdy;
+				xb = e.p0(0) + (yb - e.p0(1))*dxdy;
+			}
+			float x_min = std::min(xa, xb) - edge_influence, x_max = std::max(xa, xb) + edge_influence;
+			float c_begin = std::floor(x_min / ts), c_end = std::floor(x_max / ts);
+			if (c_end >= 0 && c_begin < nr_cols)
+				std::fill(touched_tiles.begin() + std::max(int(c_begin), 0), touched_tiles.begin() + std::min(int(c_end), nr_cols - 1) + 1, 1);
+			if (e.p0(1) <= yc && yc < e.p1(1))
+				band_crossings.push_back(std::make_pair(e.p0(0) + (yc - e.p0(1))*(e.p1(0) - e.p0(0)) / (e.p1(1) - e.p0(1)), e.winding));
+		}
+		std::sort(band_crossings.begin(), band_crossings.end());
+		// the edge table of the tile row is built once from its edges and shared by all runs of touched tiles
+		edge_subset = &band;
+		if (raster_mode == RM_SUPERSAMPLED)
+			build_coverage_edge_table(y0 - sample_margin(), y1 + sample_margin());
+		else if (raster_mode == RM_ANALYTIC)
+			build_coverage_edge_table(y0, y1);
+		else
+			build_edge_table(y0, y1);
+		edge_subset = 0;
+		// untouched tiles are uniform with the winding number at their center, while runs of touched tiles are rasterized into the window
+		img_row_offset = y0;
+		size_t ci = 0;
+		int winding = 0;
+		for (int c = 0; c < nr_cols; ) {
+			if (!touched_tiles[c]) {
+				float xc = (c + 0.5f)*ts;
+				for (; ci < band_crossings.size() && band_crossings[ci].first < xc; ++ci)
+					winding += band_crossings[ci].second;
+				target.set_tile_uniform(c, r, is_inside(winding) ? TS_FOREGROUND : TS_BACKGROUND);
+				++c;
+				continue;
+			}
+			int c_end = c + 1;
+			while (c_end < nr_cols && touched_tiles[c_end])
+				++c_end;
+			int x0 = c*ts, x1 = std::min(c_end*ts, int(img_width));
+			if (img.size() < size_t(img_width)*(y1 - y0))
+				img.resize(size_t(img_width)*(y1 - y0));
+			pixel_box_type run(pixel_type(x0, y0), pixel_type(x1 - 1, y1 - 1));
+			if (raster_mode == RM_SUPERSAMPLED)
+				rasterize_rows_supersampled(run);
+			else if (raster_mode == RM_ANALYTIC)
+				rasterize_rows_analytic(run);
+			else {
+				clear_image(run);
+				scan_convert(run);
+			}
+			for (; c < c_end; ++c) {
+				clr_type* dst = target.materialize_tile(c, r);
+				int tx0 = c*ts, w = std::min(tx0 + ts, int(img_width)) - tx0;
+				for (int y = y0; y < y1; ++y, dst += w)
+					std::copy(&img[linear_index(pixel_type(tx0, y))], &img[linear_index(pixel_type(tx0, y))] + w, dst);
+			}
+		}
+	}
+	if (is_cancelled())
+		cancelled = true;
+	img_row_offset = 0;
+	img_width = dense_width;
+	img_height = dense_height;
+	img.swap(dense_img);
+	return !cancelled;
+}
+
+void polygon_raster_engine::rasterize_dirty_region()
+{
+	if (!dirty_region.is_valid())
+		return;
+	pixel_box_type region = dirty_region;
+	dirty_region.invalidate();
+	rasterize_region(region);
+}
+
+void polygon_raster_engine::reallocate_image()
+{
+	img.resize(img_width*img_height);
+	dirty_region.invalidate();
+	prepare_patterns();
+	clear_image();
+	upload_region.invalidate();
+}
+
+/// construct from polygon and attach to its signals in order to track the dirty region
+polygon_raster_engine::polygon_raster_engine(polygon& _poly) : poly(_poly)
+{
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_raster_engine::on_change_loop);
+	cgv::signal::connect(_poly.after_insert_vertex, this, &polygon_raster_engine::on_vertex_signal);
+	cgv::signal::connect(_poly.before_change_vertex, this, &polygon_raster_engine::on_vertex_signal);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_raster_engine::on_vertex_signal);
+	cgv::signal::connect(_poly.before_remove_vertex, this, &polygon_raster_engine::on_vertex_signal);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_raster_engine::on_change_vertex_range);
+	cgv::signal::connect(_poly.before_remove_vertex_range, this, &polygon_raster_engine::before_remove_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_raster_engine::on_new_polygon);
+
+	bg_clr[0] = clr_type(255, 230, 230);
+	bg_clr[1] = clr_type(230, 255, 230);
+	fg_clr = clr_type(255, 0, 0);
+	img_width = img_height = 64;
+	img_row_offset = 0;
+	img_extent.ref_min_pnt() = vtx_type(-2, -2);
+	img_extent.ref_max_pnt() = vtx_type(2, 2);
+	fill_rule = FR_EVEN_ODD;
+	use_tiled_rasterization = false;
+	raster_mode = RM_ALIASED;
+	isoline_spacing = 0.1f;
+	sample_pattern = SP_GRID_4X4;
+	resolve_filter = RF_BOX;
+	nr_samples_per_pixel = 16;
+	cancel_flag = 0;
+	nr_tile_cols = nr_tile_rows = 0;
+	edge_subset = 0;
+	reallocate_image();
+}
+
+/// release image and worker threads
+polygon_raster_engine::~polygon_raster_engine()
+{
+}
+
+/// set image resolution, which clears the image
+void polygon_raster_engine::set_image_size(size_t width, size_t height)
+{
+	img_width = width;
+	img_height = height;
+	reallocate_image();
+}
+
+/// return image width in pixels
+size_t polygon_raster_engine::get_image_width() const
+{
+	return img_width;
+}
+
+/// return image height in pixels
+size_t polygon_raster_engine::get_image_height() const
+{
+	return img_height;
+}
+
+/// return pixels in row major order starting with the bottom row
+const std::vector<polygon_raster_engine::clr_type>& polygon_raster_engine::get_image() const
+{
+	return img;
+}
+
+/// return region of the image changed by rasterizations since the last call and reset it
+polygon_raster_engine::pixel_box_type polygon_raster_engine::take_changed_region()
+{
+	pixel_box_type region = upload_region;
+	upload_region.invalidate();
+	return region;
+}
+
+/// return description of the last error in rasterize_stream
+const std::string& polygon_raster_engine::get_last_error() const
+{
+	return last_error;
+}
+
+/// return signed distances of the last rasterization in distance mode in the same layout as the image
+const std::vector<float>& polygon_raster_engine::get_distances() const
+{
+	return distances;
+}
+
+/// set distance between the isolines of the preview in distance mode
+void polygon_raster_engine::set_isoline_spacing(float spacing)
+{
+	isoline_spacing = spacing;
+}
+
+/// set rectangle in world coordinates covered by the image, which invalidates the whole image
+void polygon_raster_engine::set_image_extent(const box_type& extent)
+{
+	img_extent = extent;
+	on_new_polygon();
+}
+
+/// set fill rule used by subsequent rasterizations
+void polygon_raster_engine::set_fill_rule(FillRule _fill_rule)
+{
+	fill_rule = _fill_rule;
+}
+
+/// set raster mode used by subsequent rasterizations
+void polygon_raster_engine::set_raster_mode(RasterMode _raster_mode)
+{
+	raster_mode = _raster_mode;
+}
+
+/// set whether subsequent aliased rasterizations are processed in parallel tiles
+void polygon_raster_engine::set_use_tiled_rasterization(bool use)
+{
+	use_tiled_rasterization = use;
+}
+
+/// set sample pattern used by subsequent supersampled rasterizations
+void polygon_raster_engine::set_sample_pattern(SamplePattern pattern)
+{
+	sample_pattern = pattern;
+}
+
+/// set filter used by subsequent supersampled rasterizations
+void polygon_raster_engine::set_resolve_filter(ResolveFilter filter)
+{
+	resolve_filter = filter;
+}
+
+/// copy settings into the given struct
+void polygon_raster_engine::get_settings(raster_settings& settings) const
+{
+	settings.img_extent = img_extent;
+	settings.fill_rule = fill_rule;
+	settings.raster_mode = raster_mode;
+	settings.use_tiled_rasterization = use_tiled_rasterization;
+	settings.bg_clr[0] = bg_clr[0];
+	settings.bg_clr[1] = bg_clr[1];
+	settings.fg_clr = fg_clr;
+	settings.isoline_spacing = isoline_spacing;
+	settings.sample_pattern = sample_pattern;
+	settings.resolve_filter = resolve_filter;
+}
+
+/// replace settings, where a changed image extent invalidates the whole image
+void polygon_raster_engine::set_settings(const raster_settings& settings)
+{
+	if (!(settings.img_extent.get_min_pnt() == img_extent.get_min_pnt() && settings.img_extent.get_max_pnt() == img_extent.get_max_pnt()))
+		set_image_extent(settings.img_extent);
+	fill_rule = settings.fill_rule;
+	raster_mode = settings.raster_mode;
+	use_tiled_rasterization = settings.use_tiled_rasterization;
+	bg_clr[0] = settings.bg_clr[0];
+	bg_clr[1] = settings.bg_clr[1];
+	fg_clr = settings.fg_clr;
+	isoline_spacing = settings.isoline_spacing;
+	sample_pattern = settings.sample_pattern;
+	resolve_filter = settings.resolve_filter;
+}
+
+/// set flag polled during rasterization or 0, where a rasterization stopped by the flag leaves the rasterized region incomplete
+void polygon_raster_engine::set_cancel_flag(const std::atomic<bool>* flag)
+{
+	cancel_flag = flag;
+}
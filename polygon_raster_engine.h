@@ -0,0 +1,378 @@
+#pragma once
+
+#include <atomic>
+#include "polygon.h"
+#include "polygon_stream.h"
+#include "thread_pool.h"
+#include "raster_kernels.h"
+#include "sparse_tile_image.h"
+
+/// rules used to decide from the winding number whether a pixel is inside the polygon
+enum FillRule
+{
+	FR_EVEN_ODD,
+	FR_NONZERO
+};
+
+/// modes of rasterization: aliased sets pixels whose center is inside, analytic blends with the exact fraction of the pixel area covered by the polygon, distance computes the signed distance field of the polygon boundary and shows it color mapped, supersampled blends with the filtered fraction of inside samples
+enum RasterMode
+{
+	RM_ALIASED,
+	RM_ANALYTIC,
+	RM_DISTANCE,
+	RM_SUPERSAMPLED
+};
+
+/// sample locations per pixel used in supersampled mode
+enum SamplePattern
+{
+	SP_GRID_2X2,
+	SP_GRID_4X4,
+	SP_ROTATED_GRID
+};
+
+/// filters used to resolve the samples to pixels in supersampled mode: box averages the samples of a pixel, tent weights the samples within one pixel of its center by their distance
+enum ResolveFilter
+{
+	RF_BOX,
+	RF_TENT
+};
+
+/// settings of a raster engine, which are copied to engines that rasterize snapshots of the polygon
+struct raster_settings : public polygon_types
+{
+	box_type img_extent;
+	FillRule fill_rule;
+	RasterMode raster_mode;
+	bool use_tiled_rasterization;
+	clr_type bg_clr[2];
+	clr_type fg_clr;
+	float isoline_spacing;
+	SamplePattern sample_pattern;
+	ResolveFilter resolve_filter;
+};
+
+/// gui independent rasterizer of the closed loops of a polygon into an rgb image, which tracks the image region invalidated by polygon changes through the polygon signals
+class polygon_raster_engine : public cgv::signal::tacker, public polygon_types
+{
+public:
+	typedef cgv::math::fvec<int, 2> pixel_type;
+	typedef cgv::media::axis_aligned_box<int, 2> pixel_box_type;
+protected:
+	const polygon& poly;
+	clr_type bg_clr[2];
+	clr_type fg_clr;
+	/// row patterns of the background checker board starting with bg_clr[0] or bg_clr[1] and of the foreground color
+	raster_pattern bg_pattern[2], fg_pattern;
+	/// update row patterns from colors
+	void prepare_patterns();
+	/// region of the image that changed since the last upload, which is reset by the consumer of the image such as a texture
+	pixel_box_type upload_region;
+	std::vector<clr_type> img;
+	size_t img_width, img_height;
+	/// first image row stored in img, which is only nonzero while a sparse tile image is rasterized through a window of one tile row
+	int img_row_offset;
+	box_type img_extent;
+	FillRule fill_rule;
+
+	/// edge in pixel coordinates prepared for scan conversion, rows [row_begin,row_end) are crossed at pixel columns in [x_begin,x_end]
+	struct edge_type
+	{
+		float x0, y0, dxdy;
+		int row_begin, row_end;
+		int x_begin, x_end;
+		int winding;
+	};
+	/// crossing of an active edge with the current row, pixels with x-index >= x are right of the edge
+	struct crossing_type
+	{
+		int x;
+		int winding;
+		size_t edge_idx;
+	};
+	/// all edges of closed loops
+	std::vector<edge_type> edges;
+	/// per row index of first edge starting in this row, further edges are chained via next_edge
+	std::vector<size_t> edge_table;
+	std::vector<size_t> next_edge;
+	/// edges crossing the current row sorted by crossing location
+	std::vector<crossing_type> active_edges;
+	/// compute the pixel column of the crossing of an edge with the center of the given row
+	int compute_crossing(const edge_type& e, int row) const;
+	/// decide from winding number whether a pixel is inside
+	bool is_inside(int winding) const;
+	/// prepare the edge from q0 to q1 given in world coordinates for the rows [row_begin,row_end) and return whether it crosses the center of one of them
+	bool prepare_edge(const vtx_type& q0, const vtx_type& q1, int row_begin, int row_end, edge_type& e) const;
+	/// prepare the edge from q0 to q1 for the rows [row_begin,row_end) and add it to the edge table if it crosses one of them
+	void add_table_edge(const vtx_type& q0, const vtx_type& q1, int row_begin, int row_end);
+	/// build edge table from all closed loops of the polygon, or from the edge subset if set, restricted to rows [row_begin,row_end)
+	void build_edge_table(int row_begin, int row_end);
+	/// fill pixels [x_begin,x_end) of given row with pattern
+	void fill_span(int row, int x_begin, int x_end, const raster_pattern& pattern);
+	/// scan convert the rows of the region with the active edge list and fill only pixels inside of region
+	void scan_convert(const pixel_box_type& region);
+
+	/**@name analytic coverage rasterization*/
+	//@{
+	RasterMode raster_mode;
+	/// edge in pixel coordinates with p0 below p1 crossing rows [row_begin,row_end)
+	struct coverage_edge_type
+	{
+		vtx_type p0, p1;
+		float dxdy;
+		int row_begin, row_end;
+		float winding;
+	};
+	std::vector<coverage_edge_type> coverage_edges;
+	/// signed area contributions per pixel of the current row, whose prefix sum gives the coverage
+	std::vector<float> coverage_row;
+	/// add the edge from q0 to q1 given in world coordinates to the coverage edge table if it overlaps one of the rows [row_begin,row_end)
+	void add_coverage_edge(const vtx_type& q0, const vtx_type& q1, int row_begin, int row_end);
+	/// build per row chained lists of coverage edges from all closed loops, or from the edge subset if set, restricted to rows [row_begin,row_end), where the lists are indexed relative to row_begin and the rows may extend beyond the image
+	void build_coverage_edge_table(int row_begin, int row_end);
+	/// accumulate signed area of a line segment within one row into acc, where x is relative to the row start in [0,width] and acc has width+2 entries
+	void accumulate_segment(float* acc, float xa, float xb, float d);
+	/// clamp segment to [x_min,x_max] by splitting it at the borders and accumulate the pieces
+	void accumulate_clipped_segment(float* acc, float xa, float xb, float d, float x_min, float x_max);
+	/// map accumulated signed area to coverage in [0,1] according to fill rule
+	float coverage_from_area(float area) const;
+	/// convert accumulated signed areas of width pixels starting at pixel (x,y) to coverage and blend foreground over background into row
+	void blend_coverage_row(clr_type* row, int x, int y, const float* acc, size_t width);
+	/// return foreground blended over the background color with alpha in [0,255]
+	clr_type blend_foreground(const clr_type& bg, int alpha) const;
+	/// compute coverage and blend foreground over background in the given region
+	void rasterize_region_analytic(const pixel_box_type& region);
+	/// compute coverage in the given region from the coverage edge table built for its rows
+	void rasterize_rows_analytic(const pixel_box_type& region);
+	//@}
+
+	/**@name supersampled rasterization*/
+	//@{
+	SamplePattern sample_pattern;
+	ResolveFilter resolve_filter;
+	/// samples of one row within a pixel at increasing offsets and the deltas added to the accumulators at a span border, which only depend on the number m of samples left of the border within its pixel; delta i of m is added in pixel row y + delta_row[m][i] at column floor(x) + delta_column[m][i]
+	struct sample_row_type
+	{
+		float y;
+		int nr_samples;
+		float x[4];
+		int nr_deltas[5];
+		int delta_row[5][8];
+		int delta_column[5][8];
+		float delta_weight[5][8];
+	};
+	std::vector<sample_row_type> sample_rows;
+	/// number of samples per pixel, which is also the sum of filter weights received by each pixel
+	int nr_samples_per_pixel;
+	/// per pixel row changes of the filtered sample count at the touched pixel columns, whose prefix sums are constant between touched columns
+	struct sample_accumulator_type
+	{
+		std::vector<float> deltas;
+		std::vector<char> touched;
+		std::vector<int> columns;
+	};
+	/// accumulators of three successive pixel rows, such that the tent filter can reach the neighboring rows
+	sample_accumulator_type sample_accumulators[3];
+	/// crossing of an edge with the current sample row relative to the first processed pixel column
+	struct sample_crossing_type
+	{
+		float x;
+		int winding;
+		size_t edge_idx;
+	};
+	/// crossings of the active edges with the current sample row sorted by location
+	std::vector<sample_crossing_type> sample_crossings;
+	/// compute filter taps of a sample at offset within its pixel and return their number
+	int compute_filter_taps(float offset, int* shifts, float* weights) const;
+	/// prepare sample rows for the current pattern and filter
+	void prepare_sample_rows();
+	/// return accumulator of a pixel row
+	sample_accumulator_type& get_sample_accumulator(int y);
+	/// add delta at column index of an accumulator
+	static void add_sample_delta(sample_accumulator_type& acc, int column, float delta);
+	/// add the deltas of a span border at x in [0,nr_cols] relative to the first processed pixel column with the given sign
+	void accumulate_sample_border(const sample_row_type& sr, int y, float x, float sign);
+	/// accumulate the samples of a sample row in pixel row y that lie in [xa,xb) given relative to the first of nr_cols processed pixel columns
+	void accumulate_sample_span(const sample_row_type& sr, int y, float xa, float xb, int nr_cols);
+	/// write pixels [x_begin,x_end) of row y with constant filtered sample count
+	void write_sample_run(int y, int x_begin, int x_end, float count);
+	/// write pixels [x_min,x_max) of row y from the accumulator whose column indices start at pixel base_x - 1 and reset it, where nothing is written if write is false
+	void resolve_sample_row(sample_accumulator_type& acc, int y, int base_x, int x_min, int x_max, bool write);
+	/// return number of pixel rows and columns around a region whose samples reach the region through the filter
+	int sample_margin() const;
+	/// rasterize the given region by accumulating spans of inside samples per row and resolving them with the filter
+	void rasterize_region_supersampled(const pixel_box_type& region);
+	/// rasterize the given region from prepared sample rows and the coverage edge table built for its rows extended by the sample margin
+	void rasterize_rows_supersampled(const pixel_box_type& region);
+	//@}
+
+	/**@name rasterization of polygon streams*/
+	//@{
+	/// per row changes of the winding number at each pixel and one extra column, whose prefix sums give the winding numbers of all pixels independent of the edge order
+	std::vector<int> winding_deltas;
+	/// per row signed area contributions with two extra columns as in coverage_row, used in analytic mode
+	std::vector<float> area_deltas;
+	/// accumulate the edge from q0 to q1 given in world coordinates into the buffer of the current raster mode
+	void accumulate_stream_edge(const vtx_type& q0, const vtx_type& q1);
+	//@}
+
+	/**@name signed distance field*/
+	//@{
+	/// per pixel signed distance in world units from the pixel center to the polygon boundary, negative inside; pixels without any pixel of the other side get +-FLT_MAX
+	std::vector<float> distances;
+	/// distance between the isolines of the color mapped preview in world units
+	float isoline_spacing;
+	/// per pixel vertical distance in rows to the closest pixel center outside and inside, which is infinite if the column has no such pixel
+	std::vector<float> column_distances[2];
+	/// classify the pixels of the rows [row_begin,row_end) with the prefix sums of the winding deltas and set their column distances to zero on the respective side
+	void initialize_column_distances(int row_begin, int row_end);
+	/// propagate column distances downward and upward through the columns [col_begin,col_end)
+	void compute_column_distances(int col_begin, int col_end);
+	/// replace the n samples of g by min_q sqr_scale*(x-q)^2 + g(q) with the lower envelope of parabolas of Felzenszwalb and Huttenlocher in O(n), where infinite samples are skipped
+	static void distance_transform(float* g, size_t n, float sqr_scale, std::vector<int>& v, std::vector<double>& z, std::vector<float>& f);
+	/// compute signed distances of the rows [row_begin,row_end) from the column distances, where the boundary is assumed half a pixel from the closest pixel center of the other side
+	void compute_row_distances(int row_begin, int row_end);
+	/// map signed distances of the rows [row_begin,row_end) to the preview image
+	void color_map_distances(int row_begin, int row_end);
+	/// compute signed distances and preview of the whole image from the accumulated winding deltas
+	void compute_distance_field();
+	/// accumulate all closed loops into winding deltas and compute the distance field
+	void rasterize_distance_field();
+	//@}
+
+	/**@name tiled rasterization*/
+	//@{
+	/// whether to rasterize tiles in parallel, which produces the same image as the single threaded path
+	bool use_tiled_rasterization;
+	/// edge length of square tiles
+	static const int tile_size = 64;
+	/// tile of the current region with the edges that can cross it and the winding numbers of its rows at its left border due to edges passing left of the tile
+	struct tile_type
+	{
+		pixel_box_type region;
+		std::vector<size_t> edges;
+		std::vector<int> winding_offsets;
+	};
+	/// number of tile columns and tile rows in the current region
+	int nr_tile_cols, nr_tile_rows;
+	std::vector<tile_type> tiles;
+	/// per tile row the indices of edges crossing one of its rows
+	std::vector<std::vector<size_t> > band_edges;
+	/// pool used to process tiles, which is created on first use
+	std::unique_ptr<thread_pool> pool;
+	/// return index of tile column containing pixel column x relative to region, clamped to [0,nr_tile_cols]
+	int tile_column(const pixel_box_type& region, int x) const;
+	/// collect edges and winding offsets of the tiles in one tile row
+	void bin_band(const pixel_box_type& region, int band_idx);
+	/// clear and fill one tile
+	void rasterize_tile(size_t tile_idx);
+	/// clear and rasterize the given region tile by tile in parallel
+	void rasterize_region_tiled(const pixel_box_type& region);
+	//@}
+	/**@name rasterization into sparse tile images*/
+	//@{
+	/// distance in pixels up to which edges influence pixels in any raster mode, such that tiles farther away from all edges are uniform
+	static const int edge_influence = 2;
+	/// edge in pixel coordinates with p0 below p1 used to classify the tiles of a sparse tile image together with its end points q0 and q1 in world coordinates and loop order
+	struct sparse_edge_type
+	{
+		vtx_type p0, p1;
+		int winding;
+		vtx_type q0, q1;
+	};
+	/// edges of closed loops collected for the sparse tile image
+	std::vector<sparse_edge_type> sparse_edges;
+	/// per tile row of the sparse tile image the indices of edges that influence one of its rows
+	std::vector<std::vector<size_t> > sparse_band_edges;
+	/// indices of the sparse edges from which the edge tables are built instead of from all closed loops, which is only set while the edge tables of a tile row are built
+	const std::vector<size_t>* edge_subset;
+	/// flags of the tiles in the current tile row that are influenced by edges
+	std::vector<char> touched_tiles;
+	/// crossings of the edges with the center row of the current tile row as location and winding
+	std::vector<std::pair<float, int> > band_crossings;
+	//@}
+	/// clear and rasterize exactly the pixels of the region in the current raster mode other than distance mode
+	void rasterize_pixels(const pixel_box_type& region);
+	/// description of the last error in rasterize_stream or in an image export of a derived class
+	std::string last_error;
+	/// flag polled during rasterization, which stops early once it is set
+	const std::atomic<bool>* cancel_flag;
+	/// return whether the cancel flag is set
+	bool is_cancelled() const;
+	bool validate_pixel_location(const pixel_type& p) const;
+	size_t linear_index(const pixel_type& p) const;
+	static pixel_type round(const vtx_type& p);
+	void set_pixel(const pixel_type& p, const clr_type& c);
+	const clr_type& get_pixel(const pixel_type& p) const;
+	vtx_type pixel_from_world(const vtx_type& p) const;
+	vtx_type world_from_pixel(const vtx_type& p) const;
+	void clear_image(const pixel_box_type& region);
+	/// resize image to current dimensions and clear it
+	virtual void reallocate_image();
+
+	/// region of the image that is out of date with respect to the polygon in inclusive pixel indices
+	pixel_box_type dirty_region;
+	/// extend dirty region by the pixels covered by the given box in world coordinates
+	void add_dirty_box(const box_type& box);
+	/// extend dirty region by the two edges incident to the given vertex
+	void add_dirty_vertex(size_t vtx_idx);
+	/// extend dirty region by all edges of given loop
+	void add_dirty_loop(size_t loop_idx);
+	/// callbacks attached to the signals of the polygon
+	void on_change_loop(size_t loop_idx, int flags);
+	void on_vertex_signal(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+	void before_remove_vertex_range(size_t vtx_begin, size_t vtx_end);
+	void on_new_polygon();
+public:
+	/// construct from polygon and attach to its signals in order to track the dirty region
+	polygon_raster_engine(polygon& _poly);
+	/// release image and worker threads
+	virtual ~polygon_raster_engine();
+	/// set image resolution, which clears the image
+	void set_image_size(size_t width, size_t height);
+	/// return image width in pixels
+	size_t get_image_width() const;
+	/// return image height in pixels
+	size_t get_image_height() const;
+	/// return pixels in row major order starting with the bottom row
+	const std::vector<clr_type>& get_image() const;
+	/// return region of the image changed by rasterizations since the last call and reset it
+	pixel_box_type take_changed_region();
+	/// return signed distances of the last rasterization in distance mode in the same layout as the image
+	const std::vector<float>& get_distances() const;
+	/// set distance between the isolines of the preview in distance mode
+	void set_isoline_spacing(float spacing);
+	/// set rectangle in world coordinates covered by the image, which invalidates the whole image
+	void set_image_extent(const box_type& extent);
+	/// set fill rule used by subsequent rasterizations
+	void set_fill_rule(FillRule _fill_rule);
+	/// set raster mode used by subsequent rasterizations
+	void set_raster_mode(RasterMode _raster_mode);
+	/// set whether subsequent aliased rasterizations are processed in parallel tiles
+	void set_use_tiled_rasterization(bool use);
+	/// set sample pattern used by subsequent supersampled rasterizations
+	void set_sample_pattern(SamplePattern pattern);
+	/// set filter used by subsequent supersampled rasterizations
+	void set_resolve_filter(ResolveFilter filter);
+	/// fill the whole image with the background checker board
+	void clear_image();
+	/// copy settings into the given struct
+	void get_settings(raster_settings& settings) const;
+	/// replace settings, where a changed image extent invalidates the whole image
+	void set_settings(const raster_settings& settings);
+	/// set flag polled during rasterization or 0, where a rasterization stopped by the flag leaves the rasterized region incomplete
+	void set_cancel_flag(const std::atomic<bool>* flag);
+	/// clear and rasterize the given region
+	void rasterize_region(const pixel_box_type& region);
+	/// clear and rasterize the complete image
+	void rasterize_polygon();
+	/// rasterize the closed loops over the image extent into a sparse tile image of arbitrary resolution one tile row at a time, where only tiles within a few pixels of an edge are rasterized and materialized while all other tiles are set uniform according to the winding number at their center; the dense image is left unchanged and false is returned in distance mode, which needs the whole image, or if cancelled
+	bool rasterize_tiles(sparse_tile_image& target);
+	/// rasterize the closed loops of a text or binary polygon file read chunk by chunk through the given stream into the whole image, where memory use depends on the image size only; returns false in supersampled mode, which would need a buffer per sample, or if reading failed, as described by get_last_error()
+	bool rasterize_stream(polygon_stream& stream, const std::string& file_name);
+	/// return description of the last error in rasterize_stream or in an image export of a derived class
+	const std::string& get_last_error() const;
+	/// clear and rasterize the region invalidated by polygon changes since the last rasterization
+	void rasterize_dirty_region();
+};
@@ -0,0 +1,137 @@
+#include "polygon_raster_worker.h"
+
+/// return whether box a contains box b
+static bool contains(const polygon_raster_worker::pixel_box_type& a, const polygon_raster_worker::pixel_box_type& b)
+{
+	return a.get_min_pnt()(0) <= b.get_min_pnt()(0) && a.get_min_pnt()(1) <= b.get_min_pnt()(1) &&
+		a.get_max_pnt()(0) >= b.get_max_pnt()(0) && a.get_max_pnt()(1) >= b.get_max_pnt()(1);
+}
+
+/// main function of the worker thread
+void polygon_raster_worker::work()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		job_condition.wait(lock, [this] { return terminate || has_job; });
+		if (terminate)
+			return;
+		polygon_snapshot snapshot;
+		std::swap(snapshot, job_snapshot);
+		raster_settings settings = job_settings;
+		pixel_box_type region = job_region;
+		has_job = false;
+		busy = true;
+		running_region = region;
+		cancel = false;
+		lock.unlock();
+
+		snapshot_poly.assign_snapshot(snapshot);
+		engine.set_settings(settings);
+		engine.rasterize_region(region);
+		bool completed = !cancel;
+		bool with_distances = settings.raster_mode == RM_DISTANCE;
+		pixel_box_type changed_region = engine.take_changed_region();
+		if (completed) {
+			staging_img = engine.get_image();
+			if (with_distances)
+				staging_distances = engine.get_distances();
+		}
+
+		lock.lock();
+		busy = false;
+		if (completed) {
+			completed_img.swap(staging_img);
+			has_completed_distances = with_distances;
+			if (with_distances)
+				completed_distances.swap(staging_distances);
+			if (!has_completed)
+				completed_region.invalidate();
+			completed_region.add_point(changed_region.get_min_pnt());
+			completed_region.add_point(changed_region.get_max_pnt());
+			has_completed = true;
+		}
+		// a cancelled job leaves its region incomplete, which the next job needs to rasterize again
+		else if (has_job) {
+			job_region.add_point(region.get_min_pnt());
+			job_region.add_point(region.get_max_pnt());
+		}
+		idle_condition.notify_all();
+	}
+}
+
+/// start worker thread
+polygon_raster_worker::polygon_raster_worker() : engine(snapshot_poly), has_job(false), busy(false), cancel(false), has_completed(false), has_completed_distances(false), terminate(false)
+{
+	engine.set_cancel_flag(&cancel);
+	thread = std::thread(&polygon_raster_worker::work, this);
+}
+
+/// cancel running job and join worker thread
+polygon_raster_worker::~polygon_raster_worker()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		terminate = true;
+		cancel = true;
+	}
+	job_condition.notify_all();
+	thread.join();
+}
+
+/// drop pending job, cancel running job, wait until the worker is idle and resize the image, which is cleared
+void polygon_raster_worker::set_image_size(size_t width, size_t height)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	has_job = false;
+	cancel = true;
+	idle_condition.wait(lock, [this] { return !busy; });
+	// the worker waits for a job and cannot access the engine until the lock is released
+	engine.set_image_size(width, height);
+	engine.take_changed_region();
+	has_completed = false;
+	has_completed_distances = false;
+	completed_region.invalidate();
+}
+
+/// take snapshot of the polygon and schedule rasterization of the region with the given settings, where a pending job is replaced and its region merged
+void polygon_raster_worker::submit(const polygon& poly, const pixel_box_type& region, const raster_settings& settings)
+{
+	// the snapshot is taken outside of the lock and replaces the previous one in O(1)
+	polygon_snapshot snapshot;
+	poly.take_snapshot(snapshot);
+	std::lock_guard<std::mutex> lock(mutex);
+	std::swap(snapshot, job_snapshot);
+	job_settings = settings;
+	if (!has_job)
+		job_region = region;
+	else {
+		job_region.add_point(region.get_min_pnt());
+		job_region.add_point(region.get_max_pnt());
+	}
+	has_job = true;
+	// the result of a running job whose region is covered would be overwritten anyway; otherwise it completes such that the image keeps up during continuous edits
+	if (busy && contains(job_region, running_region))
+		cancel = true;
+	job_condition.notify_one();
+}
+
+/// return whether a job is running or pending
+bool polygon_raster_worker::is_busy()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return busy || has_job;
+}
+
+/// if an image has been completed since the last call, swap it with img, which needs to have the same size, set region to the pixels that changed and return true; if the image was rasterized in distance mode, its signed distances are swapped with distances
+bool polygon_raster_worker::present(std::vector<clr_type>& img, std::vector<float>& distances, pixel_box_type& region)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!has_completed)
+		return false;
+	img.swap(completed_img);
+	if (has_completed_distances)
+		distances.swap(completed_distances);
+	region = completed_region;
+	has_completed = false;
+	return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "polygon_raster_engine.h"
+
+/// rasterizes snapshots of a polygon on a background thread; a new job cancels the running job if it covers its region and otherwise waits for it, and completed images are handed over by swapping them with the front image of the consumer
+class polygon_raster_worker : public polygon_types
+{
+public:
+	typedef polygon_raster_engine::pixel_box_type pixel_box_type;
+protected:
+	/// polygon restored from the snapshot of the running job and the engine rasterizing it, which are only accessed by the worker thread while it is busy
+	polygon snapshot_poly;
+	polygon_raster_engine engine;
+	/// pending job
+	bool has_job;
+	polygon_snapshot job_snapshot;
+	raster_settings job_settings;
+	pixel_box_type job_region;
+	/// whether a job is running and its region
+	bool busy;
+	pixel_box_type running_region;
+	/// flag polled by the engine to stop the running job
+	std::atomic<bool> cancel;
+	/// completed image waiting to be presented and the region in which it differs from the previously presented image
+	bool has_completed;
+	std::vector<clr_type> completed_img;
+	pixel_box_type completed_region;
+	/// signed distances of the completed image if it was rasterized in distance mode
+	bool has_completed_distances;
+	std::vector<float> completed_distances;
+	/// copies of the engine image and distances made outside of the lock before they are exchanged with the completed ones
+	std::vector<clr_type> staging_img;
+	std::vector<float> staging_distances;
+	bool terminate;
+	std::mutex mutex;
+	std::condition_variable job_condition, idle_condition;
+	std::thread thread;
+	/// main function of the worker thread
+	void work();
+public:
+	/// start worker thread
+	polygon_raster_worker();
+	/// cancel running job and join worker thread
+	~polygon_raster_worker();
+	/// drop pending job, cancel running job, wait until the worker is idle and resize the image, which is cleared
+	void set_image_size(size_t width, size_t height);
+	/// take snapshot of the polygon and schedule rasterization of the region with the given settings, where a pending job is replaced and its region merged
+	void submit(const polygon& poly, const pixel_box_type& region, const raster_settings& settings);
+	/// return whether a job is running or pending
+	bool is_busy();
+	/// if an image has been completed since the last call, swap it with img, which needs to have the same size, set region to the pixels that changed and return true; if the image was rasterized in distance mode, its signed distances are swapped with distances
+	bool present(std::vector<clr_type>& img, std::vector<float>& distances, pixel_box_type& region);
+};
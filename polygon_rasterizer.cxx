@@ -1,76 +1,34 @@
 #include "polygon_rasterizer.h"
 #include <cgv/gui/key_event.h>
+#include <cgv/signal/rebind.h>
 #include <cgv_gl/gl/gl.h>
+#include <algorithm>
 
-bool polygon_rasterizer::validate_pixel_location(const pixel_type& p) const 
-{
-	return p(0) >= 0 && p(0) < int(img_width) && p(1) >= 0 && p(1) < int(img_height); 
-}
-
-size_t polygon_rasterizer::linear_index(const pixel_type& p) const 
-{
-	return img_width*p(1) + p(0); 
-}
-
-polygon_rasterizer::pixel_type polygon_rasterizer::round(const vtx_type& p) 
-{ 
-	return pixel_type(int(floor(p(0) + 0.5f)), int(floor(p(1) + 0.5f))); 
-}
-
-void polygon_rasterizer::set_pixel(const pixel_type& p, const clr_type& c) 
-{ 
-	if (validate_pixel_location(p)) 
-		img[linear_index(p)] = c; 
-}
-
-const polygon_rasterizer::clr_type& polygon_rasterizer::get_pixel(const pixel_type& p) const 
-{ 
-	return img[linear_index(p)]; 
-}
-
-polygon_rasterizer::vtx_type polygon_rasterizer::pixel_from_world(const vtx_type& p) const 
-{ 
-	return vtx_type(float(img_width), float(img_height))*(p - img_extent.get_min_pnt()) / img_extent.get_extent(); 
-}
-
-polygon_rasterizer::vtx_type polygon_rasterizer::world_from_pixel(const vtx_type& p) const 
-{ 
-	return p*img_extent.get_extent() / vtx_type(float(img_width), float(img_height)) + img_extent.get_min_pnt(); 
-}
-
-void polygon_rasterizer::clear_image() 
-{ 
-	for (size_t y = 0; y<img_height; ++y)
-		for (size_t x = 0; x<img_width; ++x)
-			img[linear_index(pixel_type(x,y))] = bg_clr[(x+y)&1];
-}
-
-void polygon_rasterizer::rasterize_polygon()
+/// resize image and recreate texture before the next frame
+void polygon_rasterizer::reallocate_image()
 {
-	clear_image();
-	for (size_t vi = 0; vi < poly.nr_vertices(); ++vi)
-		set_pixel(pixel_from_world(poly.vertex(vi)), fg_clr);
+	polygon_raster_engine::reallocate_image();
+	worker.set_image_size(img_width, img_height);
 	tex_outofdate = true;
 }
 
-void polygon_rasterizer::reallocate_image()
+/// schedule rasterization of the whole image after a change of the settings
+void polygon_rasterizer::invalidate_image()
 {
-	img.resize(img_width*img_height);
-	clear_image();
-	tex_outofdate = true;
+	if (use_worker_thread)
+		on_new_polygon();
+	else
+		rasterize_polygon();
 }
 
-polygon_rasterizer::polygon_rasterizer(const polygon& _poly) : node("polygon_rasterizer"), poly(_poly)
+polygon_rasterizer::polygon_rasterizer(polygon& _poly) : node("polygon_rasterizer"), polygon_raster_engine(_poly)
 {
-	bg_clr[0] = clr_type(255, 230, 230);
-	bg_clr[1] = clr_type(230, 255, 230);
-	fg_clr = clr_type(255, 0, 0);
 	tex.set_mag_filter(cgv::render::TF_NEAREST);
-	img_width = img_height = 64;
-	img_extent.ref_min_pnt() = vtx_type(-2, -2);
-	img_extent.ref_max_pnt() = vtx_type(2, 2);
 	synch_img_dimensions = true;
-	reallocate_image();
+	use_worker_thread = true;
+	img_written_directly = false;
+	export_width = export_height = 16384;
+	worker.set_image_size(img_width, img_height);
 	tex_outofdate = true;
 }
 
@@ -82,6 +40,35 @@ std::string polygon_rasterizer::get_type_name() const
 
 void polygon_rasterizer::init_frame(cgv::render::context& ctx)
 {
+	// polygon changes are collected in the dirty region and rasterized once per frame
+	if (use_worker_thread) {
+		// the worker rasterizes a snapshot of the polygon and only complete images are swapped into img, such that edits never show up half rasterized
+		if (dirty_region.is_valid()) {
+			raster_settings settings;
+			get_settings(settings);
+			worker.submit(poly, dirty_region, settings);
+			dirty_region.invalidate();
+		}
+		// changes of img that are pending for upload do not come from the worker, whose next image differs from img outside of its changed region
+		if (upload_region.is_valid())
+			img_written_directly = true;
+		pixel_box_type region;
+		if (worker.present(img, distances, region)) {
+			if (img_written_directly) {
+				region = pixel_box_type(pixel_type(0, 0), pixel_type(int(img_width) - 1, int(img_height) - 1));
+				img_written_directly = false;
+			}
+			if (region.is_valid()) {
+				upload_region.add_point(region.get_min_pnt());
+				upload_region.add_point(region.get_max_pnt());
+			}
+		}
+		// poll for the result of the running job in the next frame
+		if (worker.is_busy())
+			post_redraw();
+	}
+	else
+		rasterize_dirty_region();
 	if (tex_outofdate) {
 		if (tex.is_created())
 			tex.destruct(ctx);
@@ -91,7 +78,35 @@ void polygon_rasterizer::init_frame(cgv::render::context& ctx)
 		cgv::data::data_view dv(&df, &img[0]);
 		tex.create(ctx, dv);
 		tex_outofdate = false;
+		upload_region.invalidate();
+	}
+	else if (upload_region.is_valid())
+		upload_sub_image(ctx);
+}
+
+void polygon_rasterizer::upload_sub_image(cgv::render::context& ctx)
+{
+	int x0 = upload_region.get_min_pnt()(0), y0 = upload_region.get_min_pnt()(1);
+	size_t w = upload_region.get_max_pnt()(0) - x0 + 1, h = upload_region.get_max_pnt()(1) - y0 + 1;
+	upload_region.invalidate();
+	// rows spanning the whole image are contiguous, otherwise copy the region into the staging buffer
+	const clr_type* data_ptr = &img[linear_index(pixel_type(x0, y0))];
+	if (w != img_width) {
+		upload_buffer.resize(w*h);
+		for (size_t y = 0; y < h; ++y)
+			std::copy(data_ptr + y*img_width, data_ptr + y*img_width + w, upload_buffer.begin() + y*w);
+		data_ptr = &upload_buffer[0];
 	}
+	cgv::data::data_format df("uint8[R,G,B]");
+	df.set_width(w);
+	df.set_height(h);
+	cgv::data::const_data_view dv(&df, data_ptr);
+	// rows of packed rgb8 pixels are not 4 byte aligned in general
+	GLint unpack_alignment;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	tex.replace(ctx, x0, y0, dv);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
 }
 
 void polygon_rasterizer::clear(cgv::render::context& ctx)
@@ -113,9 +128,10 @@ void polygon_rasterizer::on_set(void* member_ptr)
 			}
 		}
 		reallocate_image();
-		rasterize_polygon();
-		tex_outofdate = true;
+		invalidate_image();
 	}
+	if (member_ptr == &use_worker_thread || member_ptr == &fill_rule || member_ptr == &raster_mode || member_ptr == &use_tiled_rasterization || member_ptr == &fg_clr || member_ptr == &isoline_spacing || member_ptr == &sample_pattern || member_ptr == &resolve_filter || (member_ptr >= &bg_clr[0] && member_ptr < &bg_clr[2]))
+		invalidate_image();
 	update_member(member_ptr);
 	post_redraw();
 }
@@ -132,6 +148,24 @@ void polygon_rasterizer::draw(cgv::render::context& ctx)
 	glPopMatrix();
 }
 
+/// rasterize the polygon at export resolution into a sparse tile image and write it to a binary ppm file
+bool polygon_rasterizer::write_tile_image(const std::string& file_name)
+{
+	sparse_tile_image target(export_width, export_height);
+	if (!rasterize_tiles(target)) {
+		if (raster_mode == RM_DISTANCE)
+			last_error = file_name + ": signed distance images cannot be rasterized into sparse tiles";
+		else
+			last_error = file_name + ": rasterization was cancelled";
+		return false;
+	}
+	if (!target.write_ppm(file_name)) {
+		last_error = file_name + ": could not write image";
+		return false;
+	}
+	return true;
+}
+
 /// add 
 bool polygon_rasterizer::handle(cgv::gui::event& e)
 {
@@ -165,6 +199,15 @@ void polygon_rasterizer::create_gui()
 			add_member_control(this, "synch_img_dimensions", synch_img_dimensions, "toggle");
 			add_member_control(this, "img_width", img_width, "value_slider", "min=2;max=1024;log=true;ticks=true");
 			add_member_control(this, "img_height", img_height, "value_slider", "min=2;max=1024;log=true;ticks=true");
+			add_member_control(this, "export_width", export_width, "value_slider", "min=256;max=65536;log=true;ticks=true");
+			add_member_control(this, "export_height", export_height, "value_slider", "min=256;max=65536;log=true;ticks=true");
+			add_member_control(this, "raster_mode", raster_mode, "dropdown", "enums='aliased,analytic,signed distance,supersampled'");
+			add_member_control(this, "sample_pattern", sample_pattern, "dropdown", "enums='grid 2x2,grid 4x4,rotated grid'");
+			add_member_control(this, "resolve_filter", resolve_filter, "dropdown", "enums='box,tent'");
+			add_member_control(this, "isoline_spacing", isoline_spacing, "value_slider", "min=0.01;max=1;log=true;ticks=true");
+			add_member_control(this, "fill_rule", fill_rule, "dropdown", "enums='even odd,nonzero'");
+			add_member_control(this, "use_tiled_rasterization", use_tiled_rasterization, "toggle");
+			add_member_control(this, "use_worker_thread", use_worker_thread, "toggle");
 			add_member_control(this, "bg_color0", bg_clr[0]);
 			add_member_control(this, "bg_color1", bg_clr[1]);
 			add_member_control(this, "fg_color", fg_clr);
@@ -1,45 +1,45 @@
 #pragma once
 
 #include <cgv/base/node.h>
-#include "polygon.h"
+#include "polygon_raster_engine.h"
+#include "polygon_raster_worker.h"
 #include <cgv/gui/event_handler.h>
 #include <cgv/gui/provider.h>
 #include <cgv/render/drawable.h>
 #include <cgv/render/texture.h>
 
-
 class polygon_rasterizer : 
 	public cgv::base::node,          /// derive from node to integrate into global tree structure and to store a name
 	public cgv::gui::event_handler,  /// derive from handler to receive events and to be asked for a help string
-	public polygon_types,
+	public polygon_raster_engine,    /// derive from engine for the gui independent rasterization
 	public cgv::gui::provider,
 	public cgv::render::drawable     /// derive from drawable for drawing the cube
 {
-public:
-	typedef cgv::math::fvec<int, 2> pixel_type;
 private:
+	/// whether the texture needs to be recreated because the image dimensions changed
 	bool tex_outofdate;
 protected:
-	const polygon& poly;
-	clr_type bg_clr[2];
-	clr_type fg_clr;
 	cgv::render::texture tex;
-	std::vector<clr_type> img;
-	size_t img_width, img_height;
-	box_type img_extent;
+	/// staging buffer for regions that do not span whole image rows
+	std::vector<clr_type> upload_buffer;
+	/// replace upload region in the texture
+	void upload_sub_image(cgv::render::context& ctx);
 	bool synch_img_dimensions;
-	bool validate_pixel_location(const pixel_type& p) const;
-	size_t linear_index(const pixel_type& p) const;
-	static pixel_type round(const vtx_type& p);
-	void set_pixel(const pixel_type& p, const clr_type& c);
-	const clr_type& get_pixel(const pixel_type& p) const;
-	vtx_type pixel_from_world(const vtx_type& p) const;
-	vtx_type world_from_pixel(const vtx_type& p) const;
-	void clear_image();
+	/// worker rasterizing snapshots of the polygon, whose completed images are swapped into img
+	polygon_raster_worker worker;
+	/// whether the dirty region is rasterized by the worker instead of in init_frame
+	bool use_worker_thread;
+	/// whether img has been written outside of the worker since the last presented image, e.g. by rasterize_stream, such that the next presented image is uploaded completely
+	bool img_written_directly;
+	/// resolution of images written by write_tile_image, which is not bounded by the texture size
+	size_t export_width, export_height;
+	/// resize image and recreate texture before the next frame
 	void reallocate_image();
+	/// schedule rasterization of the whole image after a change of the settings
+	void invalidate_image();
 public:
-	polygon_rasterizer(const polygon& _poly);
-	void rasterize_polygon();
+	/// construct from polygon and attach to its signals in order to track the dirty region
+	polygon_rasterizer(polygon& _poly);
 	///
 	void on_set(void* member_ptr);
 	/// return name of type
@@ -49,6 +49,8 @@ public:
 	void clear(cgv::render::context& ctx);
 	/// draw the image as a texture
 	void draw(cgv::render::context& ctx);
+	/// rasterize the polygon at export resolution into a sparse tile image and write it to a binary ppm file; on failure get_last_error() describes the cause
+	bool write_tile_image(const std::string& file_name);
 	/// add 
 	bool handle(cgv::gui::event& e);
 	///
@@ -56,4 +58,3 @@ public:
 	/// you must overload this for gui creation
 	void create_gui();
 };
-	
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "polygon_simplifier.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+
+/// return distance of p to the segment from p0 to p1
+static double segment_distance(const polygon_types::vtx_type& p, const polygon_types::vtx_type& p0, const polygon_types::vtx_type& p1)
+{
+	double dx = double(p1[0]) - p0[0], dy = double(p1[1]) - p0[1];
+	double px = double(p[0]) - p0[0], py = double(p[1]) - p0[1];
+	double len2 = dx*dx + dy*dy;
+	double t = len2 > 0 ? std::min(std::max((px*dx + py*dy) / len2, 0.0), 1.0) : 0.0;
+	px -= t*dx;
+	py -= t*dy;
+	return std::sqrt(px*px + py*py);
+}
+
+/// return area of triangle p0,p1,p2
+static double triangle_area(const polygon_types::vtx_type& p0, const polygon_types::vtx_type& p1, const polygon_types::vtx_type& p2)
+{
+	return 0.5*std::abs((double(p1[0]) - p0[0])*(double(p2[1]) - p0[1]) - (double(p1[1]) - p0[1])*(double(p2[0]) - p0[0]));
+}
+
+/// compute importances with the Douglas-Peucker recursion, where the importance of a vertex is its distance to the segment it splits clamped to the importance of the splitting parent
+void polygon_simplifier::compute_douglas_peucker(size_t loop_idx, std::vector<float>& importance) const
+{
+	const float infinity = std::numeric_limits<float>::infinity();
+	size_t vbegin = poly.loop_begin(loop_idx);
+	size_t n = poly.loop_size(loop_idx);
+	importance.assign(n, infinity);
+	if (n < 3)
+		return;
+	// segments are given by local indices of their end points together with the importance of the vertex that split them, where index n refers to the first vertex of a closed loop
+	struct segment
+	{
+		size_t i0, i1;
+		float cap;
+	};
+	std::vector<segment> segments;
+	if (poly.loop_closed(loop_idx)) {
+		// anchor closed loops at the first vertex and the vertex farthest from it
+		const vtx_type& p0 = poly.vertex(vbegin);
+		size_t far_idx = 1;
+		float max_dist = -1;
+		for (size_t i = 1; i < n; ++i) {
+			float dist = (poly.vertex(vbegin + i) - p0).sqr_length();
+			if (dist > max_dist) {
+				max_dist = dist;
+				far_idx = i;
+			}
+		}
+		segments.push_back({ 0, far_idx, infinity });
+		segments.push_back({ far_idx, n, infinity });
+	}
+	else
+		segments.push_back({ 0, n - 1, infinity });
+	while (!segments.empty()) {
+		segment s = segments.back();
+		segments.pop_back();
+		if (s.i1 - s.i0 < 2)
+			continue;
+		const vtx_type& p0 = poly.vertex(vbegin + s.i0);
+		const vtx_type& p1 = poly.vertex(vbegin + (s.i1 == n ? 0 : s.i1));
+		size_t max_idx = s.i0 + 1;
+		double max_dist = -1;
+		for (size_t i = s.i0 + 1; i < s.i1; ++i) {
+			double dist = segment_distance(poly.vertex(vbegin + i), p0, p1);
+			if (dist > max_dist) {
+				max_dist = dist;
+				max_idx = i;
+			}
+		}
+		float imp = std::min(float(max_dist), s.cap);
+		importance[max_idx] = imp;
+		segments.push_back({ s.i0, max_idx, imp });
+		segments.push_back({ max_idx, s.i1, imp });
+	}
+}
+
+/// compute importances as square roots of the effective triangle areas at the time of removal in the Visvalingam-Whyatt order, where effective areas are made monotonic
+void polygon_simplifier::compute_visvalingam_whyatt(size_t loop_idx, std::vector<float>& importance) const
+{
+	const float infinity = std::numeric_limits<float>::infinity();
+	size_t vbegin = poly.loop_begin(loop_idx);
+	size_t n = poly.loop_size(loop_idx);
+	bool closed = poly.loop_closed(loop_idx);
+	importance.assign(n, infinity);
+	// closed loops keep a triangle and open loops their end points
+	size_t nr_kept = closed ? 3 : 2;
+	if (n <= nr_kept)
+		return;
+	// doubly linked list of remaining vertices and current triangle areas
+	std::vector<size_t> prev(n), next(n);
+	std::vector<double> area(n, std::numeric_limits<double>::infinity());
+	for (size_t i = 0; i < n; ++i) {
+		prev[i] = i == 0 ? n - 1 : i - 1;
+		next[i] = i + 1 == n ? 0 : i + 1;
+	}
+	auto compute_area = [&](size_t i) {
+		if (!closed && (i == 0 || i + 1 == n))
+			return;
+		area[i] = triangle_area(poly.vertex(vbegin + prev[i]), poly.vertex(vbegin + i), poly.vertex(vbegin + next[i]));
+	};
+	// min heap with lazy deletion of entries whose area is outdated
+	typedef std::pair<double, size_t> entry_type;
+	std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type> > heap;
+	for (size_t i = 0; i < n; ++i) {
+		compute_area(i);
+		if (area[i] < std::numeric_limits<double>::infinity())
+			heap.push(entry_type(area[i], i));
+	}
+	double last_area = 0;
+	for (size_t nr_left = n; nr_left > nr_kept; ) {
+		entry_type e = heap.top();
+		heap.pop();
+		size_t i = e.second;
+		if (importance[i] != infinity || e.first != area[i])
+			continue;
+		last_area = std::max(last_area, e.first);
+		importance[i] = float(std::sqrt(last_area));
+		--nr_left;
+		next[prev[i]] = next[i];
+		prev[next[i]] = prev[i];
+		size_t neighbors[2] = { prev[i], next[i] };
+		for (size_t j : neighbors) {
+			compute_area(j);
+			if (area[j] < std::numeric_limits<double>::infinity())
+				heap.push(entry_type(area[j], j));
+		}
+	}
+}
+
+/// compute importances of a loop and build its tree
+void polygon_simplifier::rebuild_loop(size_t loop_idx)
+{
+	loop_hierarchy& lh = loops[loop_idx];
+	if (method == SM_DOUGLAS_PEUCKER)
+		compute_douglas_peucker(loop_idx, lh.importance);
+	else
+		compute_visvalingam_whyatt(loop_idx, lh.importance);
+	// build cartesian tree that is max heap ordered by importance with the rightmost path on the stack
+	size_t n = lh.importance.size();
+	lh.left_child.assign(n, size_t(-1));
+	lh.right_child.assign(n, size_t(-1));
+	stack.clear();
+	for (size_t i = 0; i < n; ++i) {
+		size_t last = size_t(-1);
+		while (!stack.empty() && lh.importance[stack.back()] < lh.importance[i]) {
+			last = stack.back();
+			stack.pop_back();
+		}
+		lh.left_child[i] = last;
+		if (!stack.empty())
+			lh.right_child[stack.back()] = i;
+		stack.push_back(i);
+	}
+	lh.root = stack.empty() ? size_t(-1) : stack.front();
+	lh.outofdate = false;
+}
+
+void polygon_simplifier::on_new_polygon()
+{
+	loops.clear();
+	loops.resize(poly.nr_loops());
+}
+
+void polygon_simplifier::after_insert_loop(size_t loop_idx)
+{
+	loops.insert(loops.begin() + loop_idx, loop_hierarchy());
+}
+
+void polygon_simplifier::on_change_loop(size_t loop_idx, int flags)
+{
+	if ((flags & (PLA_SIZE | PLA_CLOSED)) != 0)
+		loops[loop_idx].outofdate = true;
+}
+
+void polygon_simplifier::before_remove_loop(size_t loop_idx)
+{
+	loops.erase(loops.begin() + loop_idx);
+}
+
+void polygon_simplifier::on_change_vertex(size_t vtx_idx)
+{
+	loops[poly.find_loop(vtx_idx)].outofdate = true;
+}
+
+void polygon_simplifier::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	if (vtx_begin >= vtx_end)
+		return;
+	size_t loop_end = poly.find_loop(vtx_end - 1);
+	for (size_t li = poly.find_loop(vtx_begin); li <= loop_end; ++li)
+		loops[li].outofdate = true;
+}
+
+/// construct simplifier and connect to polygon signals
+polygon_simplifier::polygon_simplifier(polygon& _poly, SimplificationMethod _method) : poly(_poly), method(_method), loops(_poly.nr_loops())
+{
+	cgv::signal::connect(_poly.after_insert_loop, this, &polygon_simplifier::after_insert_loop);
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_simplifier::on_change_loop);
+	cgv::signal::connect(_poly.before_remove_loop, this, &polygon_simplifier::before_remove_loop);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_simplifier::on_change_vertex);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_simplifier::on_change_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_simplifier::on_new_polygon);
+}
+
+/// return the method used to compute importances
+SimplificationMethod polygon_simplifier::get_method() const
+{
+	return method;
+}
+
+/// set method, which invalidates all loop hierarchies
+void polygon_simplifier::set_method(SimplificationMethod _method)
+{
+	if (method == _method)
+		return;
+	method = _method;
+	for (size_t li = 0; li < loops.size(); ++li)
+		loops[li].outofdate = true;
+}
+
+/// return importance of given vertex, rebuilding its loop if necessary
+float polygon_simplifier::get_importance(size_t vtx_idx)
+{
+	size_t loop_idx = poly.find_loop(vtx_idx);
+	// insertions during batches are only signaled at the end of the batch, which is detected from the loop size
+	if (loops[loop_idx].outofdate || loops[loop_idx].importance.size() != poly.loop_size(loop_idx))
+		rebuild_loop(loop_idx);
+	return loops[loop_idx].importance[vtx_idx - poly.loop_begin(loop_idx)];
+}
+
+/// append indices of the vertices of the given loop with importance not smaller than tolerance in loop order to vertex_indices, rebuilding the loop if necessary
+void polygon_simplifier::select(size_t loop_idx, float tolerance, std::vector<size_t>& vertex_indices)
+{
+	if (loops[loop_idx].outofdate || loops[loop_idx].importance.size() != poly.loop_size(loop_idx))
+		rebuild_loop(loop_idx);
+	const loop_hierarchy& lh = loops[loop_idx];
+	size_t vbegin = poly.loop_begin(loop_idx);
+	// in-order traversal that does not descend into subtrees whose root is below tolerance, such that each visited node is selected
+	auto filter = [&](size_t i) { return i != size_t(-1) && lh.importance[i] >= tolerance ? i : size_t(-1); };
+	stack.clear();
+	size_t i = filter(lh.root);
+	while (i != size_t(-1) || !stack.empty()) {
+		for (; i != size_t(-1); i = filter(lh.left_child[i]))
+			stack.push_back(i);
+		i = stack.back();
+		stack.pop_back();
+		vertex_indices.push_back(vbegin + i);
+		i = filter(lh.right_child[i]);
+	}
+}
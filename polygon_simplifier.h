@@ -0,0 +1,60 @@
+#pragma once
+
+#include "polygon.h"
+
+/// methods used to rank the vertices of a loop by their importance for its shape
+enum SimplificationMethod
+{
+	SM_DOUGLAS_PEUCKER,
+	SM_VISVALINGAM_WHYATT
+};
+
+/// level of detail hierarchy over the vertices of a polygon; each vertex gets an importance in world units such that the simplification for a tolerance keeps the vertices whose importance is not smaller, and a max heap ordered tree per loop allows to extract these vertices in loop order in O(output); loops are recomputed lazily after edits
+class polygon_simplifier : public cgv::signal::tacker, public polygon_types
+{
+protected:
+	const polygon& poly;
+	SimplificationMethod method;
+	/// hierarchy of one loop in loop local vertex indices
+	struct loop_hierarchy
+	{
+		/// whether the loop changed since the hierarchy was built
+		bool outofdate;
+		/// root of the tree, which is size_t(-1) for empty loops
+		size_t root;
+		/// per vertex importance, where vertices kept at every tolerance are infinitely important
+		std::vector<float> importance;
+		/// children in the tree, whose in-order traversal enumerates the vertices in loop order
+		std::vector<size_t> left_child, right_child;
+		loop_hierarchy() : outofdate(true), root(size_t(-1)) {}
+	};
+	std::vector<loop_hierarchy> loops;
+	/// traversal stack reused between selections
+	std::vector<size_t> stack;
+
+	/// compute importances with the Douglas-Peucker recursion, where the importance of a vertex is its distance to the segment it splits clamped to the importance of the splitting parent
+	void compute_douglas_peucker(size_t loop_idx, std::vector<float>& importance) const;
+	/// compute importances as square roots of the effective triangle areas at the time of removal in the Visvalingam-Whyatt order, where effective areas are made monotonic
+	void compute_visvalingam_whyatt(size_t loop_idx, std::vector<float>& importance) const;
+	/// compute importances of a loop and build its tree
+	void rebuild_loop(size_t loop_idx);
+
+	/// callbacks used to mark changed loops
+	void on_new_polygon();
+	void after_insert_loop(size_t loop_idx);
+	void on_change_loop(size_t loop_idx, int flags);
+	void before_remove_loop(size_t loop_idx);
+	void on_change_vertex(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+public:
+	/// construct simplifier and connect to polygon signals
+	polygon_simplifier(polygon& _poly, SimplificationMethod _method = SM_DOUGLAS_PEUCKER);
+	/// return the method used to compute importances
+	SimplificationMethod get_method() const;
+	/// set method, which invalidates all loop hierarchies
+	void set_method(SimplificationMethod _method);
+	/// return importance of given vertex, rebuilding its loop if necessary
+	float get_importance(size_t vtx_idx);
+	/// append indices of the vertices of the given loop with importance not smaller than tolerance in loop order to vertex_indices, rebuilding the loop if necessary
+	void select(size_t loop_idx, float tolerance, std::vector<size_t>& vertex_indices);
+};
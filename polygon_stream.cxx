@@ -0,0 +1,315 @@
+#include "polygon_stream.h"
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+static const char binary_polygon_magic[8] = { 'E', 'C', 'G', 'P', 'O', 'L', 'Y', 0 };
+static const uint32_t binary_polygon_version = 1;
+static const uint32_t binary_polygon_byte_order = 0x01020304;
+
+/// fill header of binary polygon file with magic, version and byte order mark
+void init_binary_polygon_header(binary_polygon_header& header)
+{
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, binary_polygon_magic, sizeof(header.magic));
+	header.version = binary_polygon_version;
+	header.byte_order = binary_polygon_byte_order;
+}
+
+/// check magic, version, byte order and table extents of a header read from a file of given size and describe problems in error
+bool validate_binary_polygon_header(const binary_polygon_header& header, uint64_t file_size, std::string& error)
+{
+	if (std::memcmp(header.magic, binary_polygon_magic, sizeof(header.magic)) != 0) {
+		error = " is not a binary polygon file";
+		return false;
+	}
+	if (header.version != binary_polygon_version || header.byte_order != binary_polygon_byte_order) {
+		error = " has unsupported version or byte order";
+		return false;
+	}
+	// check that tables fit into file without overflowing the size computations
+	if (header.nr_loops > file_size / sizeof(binary_polygon_loop) || header.nr_vertices > file_size / sizeof(polygon_types::vtx_type) ||
+		header.vertex_offset < sizeof(binary_polygon_header) + header.nr_loops*sizeof(binary_polygon_loop) ||
+		header.vertex_offset % 8 != 0 || header.vertex_offset > file_size ||
+		header.nr_vertices > (file_size - header.vertex_offset) / sizeof(polygon_types::vtx_type)) {
+		error = " is truncated or has an invalid vertex offset";
+		return false;
+	}
+	return true;
+}
+
+/// check loop table entry given the index of its expected first vertex and the total number of vertices
+bool validate_binary_polygon_loop(const binary_polygon_loop& bl, uint64_t first_vertex, uint64_t nr_vertices)
+{
+	return bl.first_vertex == first_vertex && bl.nr_vertices > 0 && bl.nr_vertices <= nr_vertices - first_vertex &&
+		(bl.is_closed == 0 || bl.nr_vertices >= 3) && bl.orientation <= PO_CW && (bl.is_closed != 0 || bl.orientation == PO_UNDEF);
+}
+
+/// construct stream that passes chunks of at most the given number of vertices or whole loops if 0
+polygon_stream::polygon_stream(size_t _max_chunk_size) : max_chunk_size(_max_chunk_size), callback(0), stopped(false)
+{
+	chunk.loop_idx = chunk.first_vertex = chunk.nr_vertices = 0;
+	chunk.vertices = 0;
+	chunk.begins_loop = chunk.ends_loop = chunk.is_closed = false;
+}
+
+/// set maximum number of vertices per chunk, where 0 passes whole loops
+void polygon_stream::set_max_chunk_size(size_t _max_chunk_size)
+{
+	max_chunk_size = _max_chunk_size;
+}
+
+/// return maximum number of vertices per chunk
+size_t polygon_stream::get_max_chunk_size() const
+{
+	return max_chunk_size;
+}
+
+/// start a new loop with the given attributes
+void polygon_stream::begin_loop(size_t loop_idx, size_t first_vertex, const clr_type& color, bool is_closed)
+{
+	chunk.loop_idx = loop_idx;
+	chunk.first_vertex = first_vertex;
+	chunk.begins_loop = true;
+	chunk.color = color;
+	chunk.is_closed = is_closed;
+	chunk_vertices.clear();
+}
+
+/// pass current chunk to callback
+bool polygon_stream::emit_chunk(bool ends_loop)
+{
+	chunk.vertices = chunk_vertices.empty() ? 0 : &chunk_vertices[0];
+	chunk.nr_vertices = chunk_vertices.size();
+	chunk.ends_loop = ends_loop;
+	if (!(*callback)(chunk))
+		stopped = true;
+	chunk.first_vertex += chunk.nr_vertices;
+	chunk.begins_loop = false;
+	chunk_vertices.clear();
+	return !stopped;
+}
+
+/// append vertex to current loop and pass full chunks to the callback; return false if the callback asked to stop
+bool polygon_stream::add_vertex(const vtx_type& vtx)
+{
+	// full chunks are only passed on once the next vertex arrives, such that the last chunk of a loop is never empty
+	if (max_chunk_size > 0 && chunk_vertices.size() == max_chunk_size && !emit_chunk(false))
+		return false;
+	chunk_vertices.push_back(vtx);
+	return true;
+}
+
+/// pass remaining vertices of current loop to callback with its final closed flag; return false if the callback asked to stop
+bool polygon_stream::end_loop(bool is_closed)
+{
+	chunk.is_closed = is_closed;
+	return emit_chunk(true);
+}
+
+/// set last error to message prefixed by line number and return false
+bool polygon_stream::parse_error(size_t line, const std::string& message)
+{
+	last_error = "line " + std::to_string(line) + ": " + message;
+	return false;
+}
+
+/// read text or binary file, which is detected from the magic of the binary format, and pass its loops in chunks to the callback
+bool polygon_stream::read(const std::string& file_name, const callback_type& callback)
+{
+	char magic[sizeof(binary_polygon_magic)];
+	std::ifstream is(file_name.c_str(), std::ios::binary);
+	if (is.fail()) {
+		last_error = "could not open " + file_name;
+		return false;
+	}
+	if (is.read(magic, sizeof(magic)) && std::memcmp(magic, binary_polygon_magic, sizeof(magic)) == 0)
+		return read_binary(file_name, callback);
+	is.clear();
+	is.seekg(0, std::ios::beg);
+	return read_text(is, callback);
+}
+
+/// read text file in blocks with the parser used by polygon::read
+bool polygon_stream::read_text(const std::string& file_name, const callback_type& callback)
+{
+	std::ifstream is(file_name.c_str(), std::ios::binary);
+	if (is.fail()) {
+		last_error = "could not open " + file_name;
+		return false;
+	}
+	return read_text(is, callback);
+}
+
+/// read text from stream in blocks of complete lines
+bool polygon_stream::read_text(std::istream& is, const callback_type& _callback)
+{
+	last_error.clear();
+	callback = &_callback;
+	stopped = false;
+	std::vector<char> buffer(block_size);
+	size_t nr_kept = 0, line = 1;
+	bool at_eof = false, format_known = false, simple_format = false, done = false;
+	// parser state of the format with loops
+	size_t nr_loops = 0, loop_idx = 0, nr_loop_vertices_left = 0, vtx_idx = 0;
+	vtx_type vtx;
+	while (!at_eof && !done && !stopped) {
+		// an incomplete line filling the whole buffer requires a larger buffer
+		if (nr_kept == buffer.size())
+			buffer.resize(2 * buffer.size());
+		is.read(&buffer[nr_kept], std::streamsize(buffer.size() - nr_kept));
+		if (is.bad()) {
+			last_error = "could not read text";
+			return false;
+		}
+		size_t size = nr_kept + size_t(is.gcount());
+		at_eof = is.eof();
+		// parse complete lines only, such that all records of the format with loops and all numbers are complete
+		size_t block_end = size;
+		if (!at_eof) {
+			while (block_end > 0 && buffer[block_end - 1] != '\n')
+				--block_end;
+			if (block_end == 0) {
+				nr_kept = size;
+				continue;
+			}
+		}
+		const char* begin = buffer.empty() ? 0 : &buffer[0];
+		text_parser tp(begin, begin + block_end, line);
+
+		// simple format starts with the coordinates of the first vertex, otherwise the first line gives the number of loops
+		if (!format_known) {
+			text_parser first_line = tp;
+			simple_format = first_line.parse(vtx);
+			if (simple_format)
+				begin_loop(0, 0, clr_type(0, 0, 0), true);
+			else {
+				if (!tp.parse(nr_loops))
+					return parse_error(tp.line, "expected vertex coordinates or number of loops");
+				tp.next_line();
+			}
+			format_known = true;
+		}
+		if (simple_format) {
+			for (tp.skip_space(); tp.ptr < tp.end && !stopped; tp.skip_space()) {
+				const char* vtx_ptr = tp.ptr;
+				size_t vtx_line = tp.line;
+				if (!tp.parse(vtx)) {
+					// coordinates of a vertex can be split over the lines at the end of the block
+					size_t error_line = tp.line;
+					tp.skip_space();
+					if (!at_eof && tp.ptr == tp.end) {
+						tp.ptr = vtx_ptr;
+						tp.line = vtx_line;
+						break;
+					}
+					return parse_error(error_line, "expected x and y coordinates of vertex");
+				}
+				add_vertex(vtx);
+				++vtx_idx;
+			}
+		}
+		// each loop starts with a line containing number of vertices, closed flag and optional color
+		else {
+			while (!stopped) {
+				if (nr_loop_vertices_left == 0 && loop_idx == nr_loops) {
+					done = true;
+					break;
+				}
+				tp.skip_space();
+				if (!at_eof && tp.ptr == tp.end)
+					break;
+				if (nr_loop_vertices_left == 0) {
+					size_t nr_vertices;
+					int closed, r = 0, g = 0, b = 0;
+					if (!tp.parse(nr_vertices) || !tp.parse(closed))
+						return parse_error(tp.line, "expected number of vertices and closed flag of loop " + std::to_string(loop_idx));
+					if (!tp.at_line_end() && (!tp.parse(r) || !tp.parse(g) || !tp.parse(b)))
+						return parse_error(tp.line, "expected red, green and blue color components of loop " + std::to_string(loop_idx));
+					if (nr_vertices == 0)
+						return parse_error(tp.line, "loop " + std::to_string(loop_idx) + " without vertices");
+					tp.next_line();
+					begin_loop(loop_idx, vtx_idx, clr_type(r, g, b), closed != 0 && nr_vertices >= 3);
+					nr_loop_vertices_left = nr_vertices;
+					continue;
+				}
+				if (!tp.parse(vtx))
+					return parse_error(tp.line, "expected x and y coordinates of vertex");
+				tp.next_line();
+				++vtx_idx;
+				if (!add_vertex(vtx))
+					break;
+				if (--nr_loop_vertices_left == 0) {
+					end_loop(chunk.is_closed);
+					++loop_idx;
+				}
+			}
+		}
+		// keep unparsed rest for the next block
+		line = tp.line;
+		nr_kept = size - size_t(tp.ptr - begin);
+		if (nr_kept > 0)
+			std::memmove(&buffer[0], tp.ptr, nr_kept);
+	}
+	if (simple_format && !stopped)
+		end_loop(vtx_idx >= 3);
+	return true;
+}
+
+/// read binary file sequentially, where the loop table and the vertex block are read through separate file streams
+bool polygon_stream::read_binary(const std::string& file_name, const callback_type& _callback)
+{
+	last_error.clear();
+	callback = &_callback;
+	stopped = false;
+	std::ifstream table_is(file_name.c_str(), std::ios::binary), vertex_is(file_name.c_str(), std::ios::binary);
+	if (table_is.fail() || vertex_is.fail()) {
+		last_error = "could not open " + file_name;
+		return false;
+	}
+	table_is.seekg(0, std::ios::end);
+	uint64_t file_size = uint64_t(table_is.tellg());
+	table_is.seekg(0, std::ios::beg);
+	binary_polygon_header header;
+	if (file_size < sizeof(header) || !table_is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		last_error = file_name + " is too small for a binary polygon file";
+		return false;
+	}
+	std::string error;
+	if (!validate_binary_polygon_header(header, file_size, error)) {
+		last_error = file_name + error;
+		return false;
+	}
+	vertex_is.seekg(std::streamoff(header.vertex_offset), std::ios::beg);
+	uint64_t first_vertex = 0;
+	for (size_t li = 0; li < header.nr_loops && !stopped; ++li) {
+		binary_polygon_loop bl;
+		if (!table_is.read(reinterpret_cast<char*>(&bl), sizeof(bl)) || !validate_binary_polygon_loop(bl, first_vertex, header.nr_vertices)) {
+			last_error = file_name + ": invalid entry of loop " + std::to_string(li);
+			return false;
+		}
+		begin_loop(li, size_t(first_vertex), clr_type(bl.color[0], bl.color[1], bl.color[2]), bl.is_closed != 0);
+		for (uint64_t vi = 0; vi < bl.nr_vertices && !stopped; ) {
+			size_t n = size_t(max_chunk_size > 0 ? std::min(bl.nr_vertices - vi, uint64_t(max_chunk_size)) : bl.nr_vertices);
+			chunk_vertices.resize(n);
+			if (!vertex_is.read(reinterpret_cast<char*>(&chunk_vertices[0]), std::streamsize(n*sizeof(vtx_type)))) {
+				last_error = "could not read vertices of " + file_name;
+				return false;
+			}
+			vi += n;
+			emit_chunk(vi == bl.nr_vertices);
+		}
+		first_vertex += bl.nr_vertices;
+	}
+	if (!stopped && first_vertex != header.nr_vertices) {
+		last_error = file_name + ": loops do not cover all vertices";
+		return false;
+	}
+	return true;
+}
+
+/// return description of the last error, including the line number for text files
+const std::string& polygon_stream::get_last_error() const
+{
+	return last_error;
+}
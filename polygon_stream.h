@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <charconv>
+#include "polygon.h"
+
+/// minimal parser over a text buffer that keeps track of the current line number, which is the parsing core of all text polygon readers
+struct text_parser
+{
+	const char* ptr;
+	const char* end;
+	size_t line;
+	/// construct parser for text in [_ptr,_end) that starts in the given line
+	text_parser(const char* _ptr, const char* _end, size_t _line = 1) : ptr(_ptr), end(_end), line(_line) {}
+	/// skip blanks within the current line
+	void skip_blanks() { while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\r')) ++ptr; }
+	/// skip blanks and line breaks
+	void skip_space() {
+		for (; ptr < end; ++ptr)
+			if (*ptr == '\n')
+				++line;
+			else if (*ptr != ' ' && *ptr != '\t' && *ptr != '\r')
+				break;
+	}
+	/// return whether only blanks are left in the current line
+	bool at_line_end() { skip_blanks(); return ptr == end || *ptr == '\n'; }
+	/// advance to the beginning of the next line
+	void next_line() {
+		while (ptr < end && *ptr != '\n')
+			++ptr;
+		if (ptr < end) {
+			++ptr;
+			++line;
+		}
+	}
+	/// parse a number after blanks within the current line
+	template <typename T>
+	bool parse(T& value) {
+		skip_blanks();
+		std::from_chars_result result = std::from_chars(ptr, end, value);
+		if (result.ec != std::errc())
+			return false;
+		ptr = result.ptr;
+		return true;
+	}
+	/// parse a vertex from the current line
+	bool parse(polygon_types::vtx_type& vtx) { return parse(vtx[0]) && parse(vtx[1]); }
+};
+
+/// formatter of numbers into a large reusable buffer that is written to a stream in big blocks, which is the formatting core of text polygon writers
+struct text_writer
+{
+	std::ostream& os;
+	std::vector<char> buffer;
+	size_t size;
+	/// upper bound on the number of characters written per call of put
+	static const size_t max_item_size = 32;
+	/// construct writer that flushes whenever the buffer of given size is full
+	text_writer(std::ostream& _os, size_t block_size = 1 << 20) : os(_os), buffer(block_size + max_item_size), size(0) {}
+	/// write remaining characters
+	~text_writer() { flush(); }
+	/// write buffered characters to stream
+	void flush() {
+		if (size > 0)
+			os.write(&buffer[0], std::streamsize(size));
+		size = 0;
+	}
+	/// flush if less than max_item_size characters are left in the buffer
+	void reserve() {
+		if (size + max_item_size > buffer.size())
+			flush();
+	}
+	/// append a number, where floating point numbers use the shortest representation that is read back exactly
+	template <typename T>
+	void put(T value) {
+		reserve();
+		size = size_t(std::to_chars(&buffer[size], &buffer[0] + buffer.size(), value).ptr - &buffer[0]);
+	}
+	/// append a single character
+	void put_char(char c) {
+		reserve();
+		buffer[size++] = c;
+	}
+	/// append a line with the coordinates of a vertex
+	void put(const polygon_types::vtx_type& vtx) {
+		put(vtx[0]);
+		put_char(' ');
+		put(vtx[1]);
+		put_char('\n');
+	}
+};
+
+/// header of binary polygon files, which are stored in native little endian byte order
+struct binary_polygon_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t nr_loops;
+	uint64_t nr_vertices;
+	uint64_t vertex_offset;
+};
+
+/// loop table entry of binary polygon files
+struct binary_polygon_loop
+{
+	uint64_t first_vertex;
+	uint64_t nr_vertices;
+	uint8_t color[3];
+	uint8_t is_closed;
+	uint8_t orientation;
+	uint8_t padding[3];
+};
+
+static_assert(sizeof(binary_polygon_header) == 40 && sizeof(binary_polygon_loop) == 24, "binary polygon structs must not contain implicit padding");
+
+/// fill header of binary polygon file with magic, version and byte order mark
+extern void init_binary_polygon_header(binary_polygon_header& header);
+/// check magic, version, byte order and table extents of a header read from a file of given size and describe problems in error
+extern bool validate_binary_polygon_header(const binary_polygon_header& header, uint64_t file_size, std::string& error);
+/// check loop table entry given the index of its expected first vertex and the total number of vertices
+extern bool validate_binary_polygon_loop(const binary_polygon_loop& bl, uint64_t first_vertex, uint64_t nr_vertices);
+
+/// consecutive vertices of one loop handed to the callback of a polygon_stream
+struct polygon_chunk : public polygon_types
+{
+	/// index of the loop the vertices belong to
+	size_t loop_idx;
+	/// index of the first vertex of the chunk within the whole polygon
+	size_t first_vertex;
+	/// vertices of the chunk, which are only valid during the callback
+	const vtx_type* vertices;
+	size_t nr_vertices;
+	/// whether the chunk starts or ends its loop
+	bool begins_loop, ends_loop;
+	/// color of the loop
+	clr_type color;
+	/// whether the loop is closed; in the simple text format the loop is reported closed until its last chunk reveals that it has less than three vertices, which bound no area anyway
+	bool is_closed;
+};
+
+/// reader that passes the loops of text or binary polygon files in chunks to a callback without materializing the polygon, such that memory use is bounded by the chunk size
+class polygon_stream : public polygon_types
+{
+public:
+	/// callback receiving the chunks in file order, which can return false to stop reading
+	typedef std::function<bool(const polygon_chunk&)> callback_type;
+	/// size of the blocks in which text files are read
+	static const size_t block_size = 1 << 20;
+protected:
+	/// maximum number of vertices per chunk or 0 to pass whole loops
+	size_t max_chunk_size;
+	std::string last_error;
+	/// chunk under construction and its vertices
+	polygon_chunk chunk;
+	std::vector<vtx_type> chunk_vertices;
+	const callback_type* callback;
+	/// whether the callback asked to stop
+	bool stopped;
+	/// start a new loop with the given attributes
+	void begin_loop(size_t loop_idx, size_t first_vertex, const clr_type& color, bool is_closed);
+	/// append vertex to current loop and pass full chunks to the callback; return false if the callback asked to stop
+	bool add_vertex(const vtx_type& vtx);
+	/// pass remaining vertices of current loop to callback with its final closed flag; return false if the callback asked to stop
+	bool end_loop(bool is_closed);
+	/// pass current chunk to callback
+	bool emit_chunk(bool ends_loop);
+	/// set last error to message prefixed by line number and return false
+	bool parse_error(size_t line, const std::string& message);
+public:
+	/// construct stream that passes chunks of at most the given number of vertices or whole loops if 0
+	polygon_stream(size_t _max_chunk_size = 0);
+	/// set maximum number of vertices per chunk, where 0 passes whole loops
+	void set_max_chunk_size(size_t _max_chunk_size);
+	/// return maximum number of vertices per chunk
+	size_t get_max_chunk_size() const;
+	/// read text or binary file, which is detected from the magic of the binary format, and pass its loops in chunks to the callback; returns false on errors but not if the callback stopped reading
+	bool read(const std::string& file_name, const callback_type& callback);
+	/// read text file in blocks with the parser used by polygon::read
+	bool read_text(const std::string& file_name, const callback_type& callback);
+	/// read text from stream in blocks of complete lines
+	bool read_text(std::istream& is, const callback_type& callback);
+	/// read binary file sequentially, where the loop table and the vertex block are read through separate file streams
+	bool read_binary(const std::string& file_name, const callback_type& callback);
+	/// return description of the last error, including the line number for text files
+	const std::string& get_last_error() const;
+};
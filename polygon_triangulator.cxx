@@ -0,0 +1,652 @@
+#include "polygon_triangulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/// return z-component of the cross product of p1-p0 and p2-p0
+static double orientation(const polygon_types::vtx_type& p0, const polygon_types::vtx_type& p1, const polygon_types::vtx_type& p2)
+{
+	return (double(p1[0]) - p0[0])*(double(p2[1]) - p0[1]) - (double(p1[1]) - p0[1])*(double(p2[0]) - p0[0]);
+}
+
+/// return whether two points are at the same location
+static bool same_location(const polygon_types::vtx_type& p0, const polygon_types::vtx_type& p1)
+{
+	return p0[0] == p1[0] && p0[1] == p1[1];
+}
+
+bool polygon_triangulator::edge_order::operator () (size_t e0, size_t e1) const
+{
+	double x0 = e0 == size_t(-1) ? triangulator->sweep_x : triangulator->edge_x(e0);
+	double x1 = e1 == size_t(-1) ? triangulator->sweep_x : triangulator->edge_x(e1);
+	if (x0 != x1)
+		return x0 < x1;
+	// edges only coincide at the sweep line for inputs that are not simple and the current event is ordered behind all edges
+	return e0 < e1;
+}
+
+/// return whether vertex v0 is processed before v1 by the sweep
+bool polygon_triangulator::is_above(size_t v0, size_t v1) const
+{
+	const vtx_type& p0 = points[v0];
+	const vtx_type& p1 = points[v1];
+	if (p0[1] != p1[1])
+		return p0[1] > p1[1];
+	if (p0[0] != p1[0])
+		return p0[0] < p1[0];
+	return v0 < v1;
+}
+
+/// return x-coordinate of edge starting at vertex e at the sweep line
+double polygon_triangulator::edge_x(size_t e) const
+{
+	const vtx_type& p0 = points[e];
+	const vtx_type& p1 = points[next_point[e]];
+	// horizontal edges are only in the status while the sweep passes over them
+	if (p0[1] == p1[1])
+		return std::min(std::max(sweep_x, double(std::min(p0[0], p1[0]))), double(std::max(p0[0], p1[0])));
+	double t = (sweep_y - p0[1]) / (double(p1[1]) - p0[1]);
+	return p0[0] + t*(double(p1[0]) - p0[0]);
+}
+
+/// add triangle of region vertices in counter clockwise order
+void polygon_triangulator::add_triangle(std::vector<uint32_t>& tris, size_t v0, size_t v1, size_t v2) const
+{
+	if (orientation(points[v0], points[v1], points[v2]) < 0)
+		std::swap(v1, v2);
+	tris.push_back(uint32_t(v0));
+	tris.push_back(uint32_t(v1));
+	tris.push_back(uint32_t(v2));
+}
+
+/// return whether the point is inside of the closed loop by the even odd rule
+bool polygon_triangulator::is_inside_loop(size_t loop_idx, const vtx_type& p) const
+{
+	size_t vbegin = poly.loop_begin(loop_idx);
+	size_t vend = poly.loop_end(loop_idx);
+	bool inside = false;
+	for (size_t vi = vbegin, vj = vend - 1; vi < vend; vj = vi++) {
+		const vtx_type& pi = poly.vertex(vi);
+		const vtx_type& pj = poly.vertex(vj);
+		if ((pi[1] > p[1]) != (pj[1] > p[1]) &&
+			p[0] < pi[0] + (double(p[1]) - pi[1]) * (double(pj[0]) - pi[0]) / (double(pj[1]) - pi[1]))
+			inside = !inside;
+	}
+	return inside;
+}
+
+/// collect vertices of the loops of a region without repeated locations and return whether at least the outer loop is left
+bool polygon_triangulator::collect_points(region_type& region)
+{
+	points.clear();
+	next_point.clear();
+	prev_point.clear();
+	region.point_corners.clear();
+	region.member_begins.resize(region.loops.size());
+	region.vertex_points.clear();
+	for (size_t m = 0; m < region.loops.size(); ++m) {
+		size_t loop_idx = region.loops[m];
+		size_t vbegin = poly.loop_begin(loop_idx);
+		size_t n = poly.loop_size(loop_idx);
+		size_t first = points.size();
+		region.member_begins[m] = uint32_t(region.vertex_points.size());
+		region.vertex_points.resize(region.vertex_points.size() + n, uint32_t(-1));
+		uint32_t* vertex_points = &region.vertex_points[region.member_begins[m]];
+		for (size_t i = 0; i < n; ++i) {
+			const vtx_type& p = poly.vertex(vbegin + i);
+			if (points.size() > first && same_location(points.back(), p))
+				continue;
+			vertex_points[i] = uint32_t(points.size());
+			points.push_back(p);
+			region.point_corners.push_back({ uint32_t(m), uint32_t(i) });
+		}
+		while (points.size() > first + 1 && same_location(points.back(), points[first])) {
+			vertex_points[region.point_corners.back().offset] = uint32_t(-1);
+			points.pop_back();
+			region.point_corners.pop_back();
+		}
+		if (points.size() < first + 3) {
+			std::fill(vertex_points, vertex_points + n, uint32_t(-1));
+			points.resize(first);
+			region.point_corners.resize(first);
+			if (m == 0)
+				return false;
+			continue;
+		}
+		for (size_t i = first; i < points.size(); ++i) {
+			next_point.push_back(i + 1 == points.size() ? first : i + 1);
+			prev_point.push_back(i == first ? points.size() - 1 : i - 1);
+		}
+	}
+	return true;
+}
+
+/// sweep over region vertices and add diagonals that split the region into y-monotone pieces; return false for inputs that are not simple
+bool polygon_triangulator::compute_diagonals()
+{
+	size_t n = points.size();
+	// interior is left of the edges for counter clockwise outer loops and clockwise holes
+	vertex_types.resize(n);
+	for (size_t v = 0; v < n; ++v) {
+		size_t p = prev_point[v], q = next_point[v];
+		bool convex = orientation(points[p], points[v], points[q]) >= 0;
+		if (is_above(v, p) && is_above(v, q))
+			vertex_types[v] = convex ? VT_START : VT_SPLIT;
+		else if (is_above(p, v) && is_above(q, v))
+			vertex_types[v] = convex ? VT_END : VT_MERGE;
+		else
+			vertex_types[v] = VT_REGULAR;
+	}
+	sweep_order.resize(n);
+	for (size_t v = 0; v < n; ++v)
+		sweep_order[v] = v;
+	std::sort(sweep_order.begin(), sweep_order.end(), [this](size_t v0, size_t v1) { return is_above(v0, v1); });
+
+	// status holds the edges with the interior to their right, each with the lowest vertex above the sweep line between it and the next edge to its right as helper
+	status.clear();
+	status_entries.assign(n, status.end());
+	helper.assign(n, size_t(-1));
+	diagonals.clear();
+	auto add_diagonal = [this](size_t v0, size_t v1) {
+		diagonals.push_back(v0);
+		diagonals.push_back(v1);
+	};
+	auto connect_merge_helper = [&](size_t e, size_t v) {
+		if (vertex_types[helper[e]] == VT_MERGE)
+			add_diagonal(v, helper[e]);
+	};
+	auto insert_edge = [this](size_t e) {
+		status_entries[e] = status.insert(e).first;
+		helper[e] = e;
+	};
+	auto remove_edge = [&](size_t e, size_t v) {
+		if (status_entries[e] == status.end())
+			return false;
+		connect_merge_helper(e, v);
+		status.erase(status_entries[e]);
+		status_entries[e] = status.end();
+		return true;
+	};
+	auto left_edge = [this]() {
+		auto iter = status.lower_bound(size_t(-1));
+		return iter == status.begin() ? size_t(-1) : *--iter;
+	};
+	for (size_t v : sweep_order) {
+		sweep_x = points[v][0];
+		sweep_y = points[v][1];
+		size_t p = prev_point[v];
+		size_t e;
+		switch (vertex_types[v]) {
+		case VT_START:
+			insert_edge(v);
+			break;
+		case VT_END:
+			if (!remove_edge(p, v))
+				return false;
+			break;
+		case VT_SPLIT:
+			if ((e = left_edge()) == size_t(-1))
+				return false;
+			add_diagonal(v, helper[e]);
+			helper[e] = v;
+			insert_edge(v);
+			break;
+		case VT_MERGE:
+			if (!remove_edge(p, v) || (e = left_edge()) == size_t(-1))
+				return false;
+			connect_merge_helper(e, v);
+			helper[e] = v;
+			break;
+		case VT_REGULAR:
+			// boundary runs downwards at v if the interior is to the right
+			if (is_above(p, v)) {
+				if (!remove_edge(p, v))
+					return false;
+				insert_edge(v);
+			}
+			else {
+				if ((e = left_edge()) == size_t(-1))
+					return false;
+				connect_merge_helper(e, v);
+				helper[e] = v;
+			}
+			break;
+		}
+	}
+	return true;
+}
+
+/// return the half edge that follows the given one on the boundary of its face
+size_t polygon_triangulator::next_half_edge(size_t he) const
+{
+	size_t v = half_edge_end[he];
+	size_t begin = half_edge_begin[v], end = half_edge_begin[v + 1];
+	if (end - begin == 1)
+		return begin;
+	// take the first outgoing half edge in clockwise order from the reversed incoming one
+	const double two_pi = 8 * std::atan(1.0);
+	const vtx_type& p = points[v];
+	const vtx_type& p_in = points[half_edge_start[he]];
+	double back_angle = std::atan2(double(p_in[1]) - p[1], double(p_in[0]) - p[0]);
+	size_t best = begin;
+	double best_delta = std::numeric_limits<double>::infinity();
+	for (size_t oe = begin; oe < end; ++oe) {
+		double delta = two_pi;
+		if (half_edge_end[oe] != half_edge_start[he]) {
+			const vtx_type& p_out = points[half_edge_end[oe]];
+			delta = back_angle - std::atan2(double(p_out[1]) - p[1], double(p_out[0]) - p[0]);
+			while (delta <= 0)
+				delta += two_pi;
+		}
+		if (delta < best_delta) {
+			best_delta = delta;
+			best = oe;
+		}
+	}
+	return best;
+}
+
+/// return whether the piece stored in face is simple, y-monotone and counter clockwise
+bool polygon_triangulator::is_monotone_piece()
+{
+	size_t k = face.size();
+	if (k < 3)
+		return false;
+	size_t top = 0, bottom = 0;
+	for (size_t i = 1; i < k; ++i) {
+		if (is_above(face[i], face[top]))
+			top = i;
+		if (is_above(face[bottom], face[i]))
+			bottom = i;
+	}
+	// both chains are collected from the top to the bottom vertex, the left one in counter clockwise order
+	left_chain.clear();
+	right_chain.clear();
+	for (size_t i = top; ; i = (i + 1) % k) {
+		left_chain.push_back(face[i]);
+		if (i == bottom)
+			break;
+	}
+	for (size_t i = top; ; i = (i + k - 1) % k) {
+		right_chain.push_back(face[i]);
+		if (i == bottom)
+			break;
+	}
+	for (const std::vector<size_t>* chain : { &left_chain, &right_chain })
+		for (size_t j = 0; j + 1 < chain->size(); ++j)
+			if (!is_above((*chain)[j], (*chain)[j + 1]) || same_location(points[(*chain)[j]], points[(*chain)[j + 1]]))
+				return false;
+	// each vertex has to lie on the interior side of the opposite chain, which is to the right of the left chain traversed downwards
+	auto is_inside_of_chain = [this](const std::vector<size_t>& chain, const std::vector<size_t>& opposite, double sign) {
+		size_t j = 0;
+		for (size_t i = 1; i + 1 < chain.size(); ++i) {
+			size_t v = chain[i];
+			while (j + 2 < opposite.size() && is_above(opposite[j + 1], v))
+				++j;
+			if (sign * orientation(points[opposite[j]], points[opposite[j + 1]], points[v]) < 0)
+				return false;
+		}
+		return true;
+	};
+	return is_inside_of_chain(left_chain, right_chain, -1) && is_inside_of_chain(right_chain, left_chain, 1);
+}
+
+/// triangulate the y-monotone piece stored in face, which is reordered
+void polygon_triangulator::triangulate_monotone(std::vector<uint32_t>& tris)
+{
+	size_t k = face.size();
+	if (k < 3)
+		return;
+	if (k == 3) {
+		add_triangle(tris, face[0], face[1], face[2]);
+		return;
+	}
+	// in counter clockwise order the left chain descends from the top to the bottom vertex
+	size_t top = 0, bottom = 0;
+	for (size_t i = 1; i < k; ++i) {
+		if (is_above(face[i], face[top]))
+			top = i;
+		if (is_above(face[bottom], face[i]))
+			bottom = i;
+	}
+	for (size_t i = top; i != bottom; i = (i + 1) % k)
+		on_left_chain[face[i]] = true;
+	for (size_t i = bottom; i != top; i = (i + 1) % k)
+		on_left_chain[face[i]] = false;
+	std::sort(face.begin(), face.end(), [this](size_t v0, size_t v1) { return is_above(v0, v1); });
+
+	chain_stack.clear();
+	chain_stack.push_back(face[0]);
+	chain_stack.push_back(face[1]);
+	for (size_t j = 2; j + 1 < k; ++j) {
+		size_t v = face[j];
+		if (on_left_chain[v] != on_left_chain[chain_stack.back()]) {
+			// fan from v to all stacked vertices of the opposite chain
+			for (size_t i = 0; i + 1 < chain_stack.size(); ++i)
+				add_triangle(tris, v, chain_stack[i], chain_stack[i + 1]);
+			chain_stack.clear();
+			chain_stack.push_back(face[j - 1]);
+			chain_stack.push_back(v);
+		}
+		else {
+			// cut off stacked vertices as long as the diagonal from v is inside
+			size_t last = chain_stack.back();
+			chain_stack.pop_back();
+			while (!chain_stack.empty()) {
+				double o = orientation(points[v], points[chain_stack.back()], points[last]);
+				if (on_left_chain[v] ? o <= 0 : o >= 0)
+					break;
+				add_triangle(tris, v, last, chain_stack.back());
+				last = chain_stack.back();
+				chain_stack.pop_back();
+			}
+			chain_stack.push_back(last);
+			chain_stack.push_back(v);
+		}
+	}
+	for (size_t i = 0; i + 1 < chain_stack.size(); ++i)
+		add_triangle(tris, face[k - 1], chain_stack[i], chain_stack[i + 1]);
+}
+
+/// decompose region into monotone pieces and triangulate them, which results in no triangles if its loops are not simple
+void polygon_triangulator::triangulate_region(region_type& region)
+{
+	region.piece_begins.assign(1, 0);
+	region.piece_points.clear();
+	region.piece_triangles.clear();
+	if (collect_points(region) && compute_diagonals()) {
+		// half edges of the loops followed by both directions of the diagonals, sorted by start vertex
+		size_t n = points.size();
+		size_t nr_half_edges = n + diagonals.size();
+		half_edge_begin.assign(n + 2, 0);
+		for (size_t v = 0; v < n; ++v)
+			++half_edge_begin[v + 2];
+		for (size_t v : diagonals)
+			++half_edge_begin[v + 2];
+		for (size_t v = 2; v < n + 2; ++v)
+			half_edge_begin[v] += half_edge_begin[v - 1];
+		half_edge_start.resize(nr_half_edges);
+		half_edge_end.resize(nr_half_edges);
+		auto add_half_edge = [this](size_t v0, size_t v1) {
+			size_t he = half_edge_begin[v0 + 1]++;
+			half_edge_start[he] = v0;
+			half_edge_end[he] = v1;
+		};
+		for (size_t v = 0; v < n; ++v)
+			add_half_edge(v, next_point[v]);
+		for (size_t i = 0; i < diagonals.size(); i += 2) {
+			add_half_edge(diagonals[i], diagonals[i + 1]);
+			add_half_edge(diagonals[i + 1], diagonals[i]);
+		}
+		// each face of the subdivision is a monotone piece with the interior to the left of its half edges
+		half_edge_visited.assign(nr_half_edges, false);
+		on_left_chain.resize(n);
+		for (size_t he0 = 0; he0 < nr_half_edges; ++he0) {
+			if (half_edge_visited[he0])
+				continue;
+			face.clear();
+			size_t he = he0;
+			do {
+				if (half_edge_visited[he])
+					break;
+				half_edge_visited[he] = true;
+				face.push_back(half_edge_start[he]);
+				he = next_half_edge(he);
+			} while (he != he0);
+			// faces that do not close are only found for inputs that are not simple
+			if (he != he0)
+				continue;
+			region.piece_points.insert(region.piece_points.end(), face.begin(), face.end());
+			region.piece_begins.push_back(uint32_t(region.piece_points.size()));
+			region.piece_triangles.push_back(std::vector<uint32_t>());
+			triangulate_monotone(region.piece_triangles.back());
+		}
+	}
+	// pieces containing each vertex in the same layout as the half edges
+	size_t n = points.size();
+	region.point_piece_begins.assign(n + 2, 0);
+	for (uint32_t v : region.piece_points)
+		++region.point_piece_begins[v + 2];
+	for (size_t v = 2; v < n + 2; ++v)
+		region.point_piece_begins[v] += region.point_piece_begins[v - 1];
+	region.point_pieces.resize(region.piece_points.size());
+	for (uint32_t pi = 0; pi + 1 < region.piece_begins.size(); ++pi)
+		for (uint32_t i = region.piece_begins[pi]; i < region.piece_begins[pi + 1]; ++i)
+			region.point_pieces[region.point_piece_begins[region.piece_points[i] + 1]++] = pi;
+	region.point_piece_begins.pop_back();
+	region.points.swap(points);
+}
+
+/// move region vertices to their current locations and triangulate the pieces containing them again; return false if one of these pieces is no longer simple and y-monotone
+bool polygon_triangulator::update_pieces(region_type& region, const std::vector<uint32_t>& moved_points)
+{
+	// regions without pieces failed to triangulate and are retried
+	if (region.piece_triangles.empty())
+		return false;
+	points.swap(region.points);
+	affected_pieces.clear();
+	for (uint32_t v : moved_points) {
+		const corner_type& c = region.point_corners[v];
+		points[v] = poly.vertex(poly.loop_begin(region.loops[c.member]) + c.offset);
+		for (uint32_t i = region.point_piece_begins[v]; i < region.point_piece_begins[v + 1]; ++i)
+			affected_pieces.push_back(region.point_pieces[i]);
+	}
+	std::sort(affected_pieces.begin(), affected_pieces.end());
+	affected_pieces.erase(std::unique(affected_pieces.begin(), affected_pieces.end()), affected_pieces.end());
+	// by additivity of winding numbers simple counter clockwise pieces still partition the region as long as it is simple
+	bool valid = true;
+	for (uint32_t pi : affected_pieces) {
+		face.assign(region.piece_points.begin() + region.piece_begins[pi], region.piece_points.begin() + region.piece_begins[pi + 1]);
+		if (!is_monotone_piece()) {
+			valid = false;
+			break;
+		}
+	}
+	if (valid) {
+		on_left_chain.resize(points.size());
+		for (uint32_t pi : affected_pieces) {
+			face.assign(region.piece_points.begin() + region.piece_begins[pi], region.piece_points.begin() + region.piece_begins[pi + 1]);
+			region.piece_triangles[pi].clear();
+			triangulate_monotone(region.piece_triangles[pi]);
+		}
+	}
+	points.swap(region.points);
+	return valid;
+}
+
+void polygon_triangulator::mark_loop(size_t loop_idx)
+{
+	if (structure_outofdate || loop_dirty[loop_idx])
+		return;
+	loop_dirty[loop_idx] = true;
+	dirty_loops.push_back(loop_idx);
+}
+
+void polygon_triangulator::on_structure_change()
+{
+	structure_outofdate = true;
+}
+
+void polygon_triangulator::on_loop_structure_change(size_t)
+{
+	structure_outofdate = true;
+}
+
+void polygon_triangulator::on_change_loop(size_t loop_idx, int flags)
+{
+	if ((flags & (PLA_ORIENTATION | PLA_SIZE | PLA_CLOSED)) != 0)
+		mark_loop(loop_idx);
+}
+
+void polygon_triangulator::on_change_vertex(size_t vtx_idx)
+{
+	if (structure_outofdate)
+		return;
+	// loop and offset stay valid under insertions into other loops, while insertions into the same loop mark it dirty
+	size_t loop_idx = poly.find_loop(vtx_idx);
+	moved_vertices.push_back(std::make_pair(loop_idx, vtx_idx - poly.loop_begin(loop_idx)));
+	loop_boxes[loop_idx].add_point(poly.vertex(vtx_idx));
+}
+
+void polygon_triangulator::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	if (vtx_begin >= vtx_end)
+		return;
+	if (vtx_end == vtx_begin + 1) {
+		on_change_vertex(vtx_begin);
+		return;
+	}
+	size_t loop_end = poly.find_loop(vtx_end - 1);
+	for (size_t li = poly.find_loop(vtx_begin); li <= loop_end; ++li)
+		mark_loop(li);
+}
+
+/// construct triangulator and connect to polygon signals
+polygon_triangulator::polygon_triangulator(polygon& _poly) : poly(_poly), structure_outofdate(true), sweep_x(0), sweep_y(0), status(edge_order{ this })
+{
+	cgv::signal::connect(_poly.after_insert_loop, this, &polygon_triangulator::on_loop_structure_change);
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_triangulator::on_change_loop);
+	cgv::signal::connect(_poly.before_remove_loop, this, &polygon_triangulator::on_loop_structure_change);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_triangulator::on_change_vertex);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_triangulator::on_change_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_triangulator::on_structure_change);
+}
+
+/// assign holes to regions and triangulate the regions or pieces affected by changes since the last call; return whether the triangles changed
+bool polygon_triangulator::update()
+{
+	size_t nr_loops = poly.nr_loops();
+	if (structure_outofdate) {
+		regions.clear();
+		loop_dirty.assign(nr_loops, false);
+		loop_boxes.resize(nr_loops);
+		dirty_loops.clear();
+		moved_vertices.clear();
+		structure_outofdate = false;
+		for (size_t li = 0; li < nr_loops; ++li)
+			mark_loop(li);
+		if (nr_loops == 0) {
+			triangles.clear();
+			return true;
+		}
+	}
+	if (dirty_loops.empty() && moved_vertices.empty())
+		return false;
+	for (size_t li : dirty_loops) {
+		box_type& box = loop_boxes[li];
+		box.invalidate();
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi)
+			box.add_point(poly.vertex(vi));
+	}
+	// holes are assigned again after each change, as they are found by containment
+	std::vector<size_t> old_region_of_outer(nr_loops, size_t(-1));
+	std::vector<size_t> region_of_loop(nr_loops, size_t(-1)), member_of_loop(nr_loops, size_t(-1));
+	for (size_t ri = 0; ri < regions.size(); ++ri)
+		old_region_of_outer[regions[ri].loops[0]] = ri;
+	std::vector<region_type> new_regions;
+	std::vector<size_t> holes;
+	for (size_t li = 0; li < nr_loops; ++li) {
+		if (!poly.loop_closed(li) || poly.loop_size(li) < 3)
+			continue;
+		if (poly.loop_orientation(li) == PO_CCW) {
+			region_of_loop[li] = new_regions.size();
+			member_of_loop[li] = 0;
+			new_regions.push_back(region_type());
+			new_regions.back().loops.push_back(li);
+		}
+		else if (poly.loop_orientation(li) == PO_CW)
+			holes.push_back(li);
+	}
+	for (size_t hi : holes) {
+		const box_type& hole_box = loop_boxes[hi];
+		const vtx_type& p = poly.vertex(poly.loop_begin(hi));
+		size_t best = size_t(-1);
+		for (const region_type& r : new_regions) {
+			size_t li = r.loops[0];
+			if (!loop_boxes[li].inside(hole_box.get_min_pnt()) || !loop_boxes[li].inside(hole_box.get_max_pnt()))
+				continue;
+			if (best != size_t(-1) && std::abs(poly.loop_area(li)) >= std::abs(poly.loop_area(best)))
+				continue;
+			if (is_inside_loop(li, p))
+				best = li;
+		}
+		if (best != size_t(-1)) {
+			region_type& r = new_regions[region_of_loop[best]];
+			region_of_loop[hi] = region_of_loop[best];
+			member_of_loop[hi] = r.loops.size();
+			r.loops.push_back(hi);
+		}
+	}
+	// regions with the same loops of which none is dirty keep their decomposition
+	std::vector<bool> keep(new_regions.size(), false);
+	for (size_t ri = 0; ri < new_regions.size(); ++ri) {
+		region_type& r = new_regions[ri];
+		size_t old_ri = old_region_of_outer[r.loops[0]];
+		if (old_ri == size_t(-1) || regions[old_ri].loops != r.loops)
+			continue;
+		keep[ri] = true;
+		for (size_t m = 0; keep[ri] && m < r.loops.size(); ++m)
+			keep[ri] = !loop_dirty[r.loops[m]];
+		if (keep[ri])
+			r = std::move(regions[old_ri]);
+	}
+	std::vector<std::pair<size_t, uint32_t> > moved_points;
+	for (const auto& mv : moved_vertices) {
+		size_t ri = region_of_loop[mv.first];
+		if (ri == size_t(-1) || !keep[ri])
+			continue;
+		const region_type& r = new_regions[ri];
+		size_t n = poly.loop_size(mv.first);
+		const uint32_t* vertex_points = &r.vertex_points[r.member_begins[member_of_loop[mv.first]]];
+		// moving a vertex next to skipped repetitions changes the region vertices
+		if (vertex_points[mv.second] == uint32_t(-1) || vertex_points[(mv.second + 1) % n] == uint32_t(-1) || vertex_points[(mv.second + n - 1) % n] == uint32_t(-1))
+			keep[ri] = false;
+		else
+			moved_points.push_back(std::make_pair(ri, vertex_points[mv.second]));
+	}
+	std::sort(moved_points.begin(), moved_points.end());
+	std::vector<uint32_t> region_moved_points;
+	for (size_t i = 0; i < moved_points.size(); ) {
+		size_t ri = moved_points[i].first;
+		region_moved_points.clear();
+		for (; i < moved_points.size() && moved_points[i].first == ri; ++i)
+			region_moved_points.push_back(moved_points[i].second);
+		if (keep[ri] && !update_pieces(new_regions[ri], region_moved_points))
+			keep[ri] = false;
+	}
+	for (size_t ri = 0; ri < new_regions.size(); ++ri)
+		if (!keep[ri])
+			triangulate_region(new_regions[ri]);
+	regions.swap(new_regions);
+	for (size_t li : dirty_loops)
+		loop_dirty[li] = false;
+	dirty_loops.clear();
+	moved_vertices.clear();
+
+	// region vertices are resolved to vertex indices, which shift under insertions and removals in other loops
+	triangles.clear();
+	std::vector<size_t> loop_begins;
+	for (const region_type& r : regions) {
+		loop_begins.resize(r.loops.size());
+		for (size_t m = 0; m < r.loops.size(); ++m)
+			loop_begins[m] = poly.loop_begin(r.loops[m]);
+		for (const std::vector<uint32_t>& tris : r.piece_triangles)
+			for (uint32_t v : tris) {
+				const corner_type& c = r.point_corners[v];
+				triangles.push_back(uint32_t(loop_begins[c.member] + c.offset));
+			}
+	}
+	return true;
+}
+
+/// return vertex indices of the triangles in counter clockwise order, which are valid after update
+const std::vector<uint32_t>& polygon_triangulator::get_triangles() const
+{
+	return triangles;
+}
+
+/// return number of regions, each given by a counter clockwise loop and its holes
+size_t polygon_triangulator::nr_regions() const
+{
+	return regions.size();
+}
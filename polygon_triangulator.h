@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+#include <utility>
+#include "polygon.h"
+
+/// triangulation of the closed loops of a polygon for filled rendering, where counter clockwise loops bound regions and clockwise loops are holes in the smallest counter clockwise loop containing them; each region is split into y-monotone pieces by a sweep line in O(n log n) and the pieces are triangulated in linear time; when vertices are moved only the pieces containing them are triangulated again as long as these stay simple and y-monotone, otherwise the decomposition of their region is recomputed
+class polygon_triangulator : public cgv::signal::tacker, public polygon_types
+{
+protected:
+	const polygon& poly;
+	/// vertex of a region given by the index of its loop within the region and its offset in this loop, which stays valid when vertices of other loops are inserted or removed
+	struct corner_type
+	{
+		uint32_t member;
+		uint32_t offset;
+	};
+	/// outer loop with its holes, decomposed into monotone pieces
+	struct region_type
+	{
+		/// outer loop followed by the holes
+		std::vector<size_t> loops;
+		/// locations of the region vertices, where repeated locations of successive loop vertices are skipped, together with their loop corners
+		std::vector<vtx_type> points;
+		std::vector<corner_type> point_corners;
+		/// region vertex of each loop vertex or uint32_t(-1) for skipped ones, where the entries of a loop start at its member begin
+		std::vector<uint32_t> member_begins, vertex_points;
+		/// region vertices of the monotone pieces in counter clockwise order and their triangles, three region vertices each
+		std::vector<uint32_t> piece_begins, piece_points;
+		std::vector<std::vector<uint32_t> > piece_triangles;
+		/// pieces containing each region vertex
+		std::vector<uint32_t> point_piece_begins, point_pieces;
+	};
+	std::vector<region_type> regions;
+	/// triangle vertex indices of all regions
+	std::vector<uint32_t> triangles;
+	/// whether loops were inserted or removed, which invalidates all regions
+	bool structure_outofdate;
+	/// per loop flag and list of loops whose region needs to be decomposed again
+	std::vector<bool> loop_dirty;
+	std::vector<size_t> dirty_loops;
+	/// vertices moved since the last update given by loop and offset
+	std::vector<std::pair<size_t, size_t> > moved_vertices;
+	/// bounding boxes of loops used to assign holes, which are extended by moved vertices
+	std::vector<box_type> loop_boxes;
+
+	/**@name state of the region under construction, indexed by region vertices*/
+	//@{
+	enum VertexType { VT_START, VT_END, VT_SPLIT, VT_MERGE, VT_REGULAR };
+	std::vector<vtx_type> points;
+	std::vector<size_t> next_point, prev_point;
+	std::vector<VertexType> vertex_types;
+	/// vertices in decreasing y with increasing x among equal y
+	std::vector<size_t> sweep_order;
+	/// location of the current event, at which edges are compared
+	double sweep_x, sweep_y;
+	/// orders edges, identified by their start vertex, by their x-coordinate at the sweep line, where size_t(-1) denotes the current event
+	struct edge_order
+	{
+		const polygon_triangulator* triangulator;
+		bool operator () (size_t e0, size_t e1) const;
+	};
+	std::set<size_t, edge_order> status;
+	std::vector<std::set<size_t, edge_order>::iterator> status_entries;
+	std::vector<size_t> helper;
+	/// diagonals as pairs of vertices
+	std::vector<size_t> diagonals;
+	/// half edges of the subdivision into monotone pieces given by start and end vertex, ordered by start vertex
+	std::vector<size_t> half_edge_begin, half_edge_start, half_edge_end;
+	std::vector<bool> half_edge_visited;
+	std::vector<size_t> face, chain_stack, left_chain, right_chain;
+	std::vector<bool> on_left_chain;
+	std::vector<uint32_t> affected_pieces;
+	//@}
+
+	/// return whether vertex v0 is processed before v1 by the sweep
+	bool is_above(size_t v0, size_t v1) const;
+	/// return x-coordinate of edge starting at vertex e at the sweep line
+	double edge_x(size_t e) const;
+	/// add triangle of region vertices in counter clockwise order
+	void add_triangle(std::vector<uint32_t>& tris, size_t v0, size_t v1, size_t v2) const;
+	/// return whether the point is inside of the closed loop by the even odd rule
+	bool is_inside_loop(size_t loop_idx, const vtx_type& p) const;
+	/// collect vertices of the loops of a region without repeated locations and return whether at least the outer loop is left
+	bool collect_points(region_type& region);
+	/// sweep over region vertices and add diagonals that split the region into y-monotone pieces; return false for inputs that are not simple
+	bool compute_diagonals();
+	/// return the half edge that follows the given one on the boundary of its face
+	size_t next_half_edge(size_t he) const;
+	/// return whether the piece stored in face is simple, y-monotone and counter clockwise
+	bool is_monotone_piece();
+	/// triangulate the y-monotone piece stored in face, which is reordered
+	void triangulate_monotone(std::vector<uint32_t>& tris);
+	/// decompose region into monotone pieces and triangulate them, which results in no triangles if its loops are not simple
+	void triangulate_region(region_type& region);
+	/// move region vertices to their current locations and triangulate the pieces containing them again; return false if one of these pieces is no longer simple and y-monotone
+	bool update_pieces(region_type& region, const std::vector<uint32_t>& moved_points);
+
+	/// callbacks used to collect changed loops
+	void mark_loop(size_t loop_idx);
+	void on_structure_change();
+	void on_loop_structure_change(size_t loop_idx);
+	void on_change_loop(size_t loop_idx, int flags);
+	void on_change_vertex(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+public:
+	/// construct triangulator and connect to polygon signals
+	polygon_triangulator(polygon& _poly);
+	/// assign holes to regions and triangulate the regions or pieces affected by changes since the last call; return whether the triangles changed
+	bool update();
+	/// return vertex indices of the triangles in counter clockwise order, which are valid after update
+	const std::vector<uint32_t>& get_triangles() const;
+	/// return number of regions, each given by a counter clockwise loop and its holes
+	size_t nr_regions() const;
+};
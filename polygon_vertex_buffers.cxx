@@ -0,0 +1,264 @@
+#include "polygon_vertex_buffers.h"
+#include <cgv_gl/gl/gl.h>
+#include <cgv_gl/gl/gl_tools.h>
+#include <algorithm>
+
+/// extend dirty range by given vertex range
+void polygon_vertex_buffers::add_dirty_range(size_t vtx_begin, size_t vtx_end)
+{
+	if (vtx_begin >= vtx_end)
+		return;
+	if (dirty_begin >= dirty_end) {
+		dirty_begin = vtx_begin;
+		dirty_end = vtx_end;
+	}
+	else {
+		dirty_begin = std::min(dirty_begin, vtx_begin);
+		dirty_end = std::max(dirty_end, vtx_end);
+	}
+	lod_outofdate = true;
+}
+
+/// recompute draw ranges from loops
+void polygon_vertex_buffers::update_ranges()
+{
+	for (int m = 0; m < 2; ++m) {
+		firsts[m].clear();
+		counts[m].clear();
+	}
+	// loops are stored consecutively, which avoids the logarithmic loop_begin per loop
+	size_t vbegin = 0;
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		size_t n = poly.loop_size(li);
+		if (n >= 2) {
+			int m = poly.loop_closed(li) ? 1 : 0;
+			firsts[m].push_back(int(vbegin));
+			counts[m].push_back(int(n));
+		}
+		vbegin += n;
+	}
+	ranges_outofdate = false;
+}
+
+/// select simplified loops for given tolerance and upload their indices
+void polygon_vertex_buffers::update_lod(const cgv::render::context& ctx, polygon_simplifier& simplifier, float tolerance)
+{
+	lod_indices.clear();
+	for (int m = 0; m < 2; ++m) {
+		lod_counts[m].clear();
+		lod_offsets[m].clear();
+	}
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		if (poly.loop_size(li) < 2)
+			continue;
+		selection.clear();
+		simplifier.select(li, tolerance, selection);
+		if (selection.size() < 2)
+			continue;
+		int m = poly.loop_closed(li) ? 1 : 0;
+		lod_offsets[m].push_back(reinterpret_cast<const void*>(lod_indices.size()*sizeof(uint32_t)));
+		lod_counts[m].push_back(int(selection.size()));
+		for (size_t i = 0; i < selection.size(); ++i)
+			lod_indices.push_back(uint32_t(selection[i]));
+	}
+	if (lod_indices.size() > index_capacity) {
+		index_buffer.destruct(ctx);
+		index_capacity = std::max(lod_indices.size(), index_capacity + index_capacity / 2);
+		index_buffer.create(ctx, index_capacity*sizeof(uint32_t));
+	}
+	if (!lod_indices.empty())
+		index_buffer.replace(ctx, 0, &lod_indices[0], lod_indices.size());
+	lod_outofdate = false;
+	lod_tolerance = tolerance;
+}
+
+void polygon_vertex_buffers::on_new_polygon()
+{
+	add_dirty_range(0, poly.nr_vertices());
+	ranges_outofdate = true;
+}
+
+void polygon_vertex_buffers::on_structure_change(size_t)
+{
+	ranges_outofdate = true;
+	lod_outofdate = true;
+}
+
+void polygon_vertex_buffers::on_change_loop(size_t loop_idx, int flags)
+{
+	if ((flags & (PLA_SIZE | PLA_CLOSED)) != 0)
+		on_structure_change(loop_idx);
+	if ((flags & PLA_COLOR) != 0)
+		add_dirty_range(poly.loop_begin(loop_idx), poly.loop_end(loop_idx));
+}
+
+void polygon_vertex_buffers::after_insert_vertex(size_t vtx_idx)
+{
+	// all following vertices move up by one
+	add_dirty_range(vtx_idx, poly.nr_vertices());
+}
+
+void polygon_vertex_buffers::on_change_vertex(size_t vtx_idx)
+{
+	add_dirty_range(vtx_idx, vtx_idx + 1);
+}
+
+void polygon_vertex_buffers::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	add_dirty_range(vtx_begin, vtx_end);
+}
+
+void polygon_vertex_buffers::before_remove_vertex(size_t vtx_idx)
+{
+	add_dirty_range(vtx_idx, poly.nr_vertices());
+}
+
+void polygon_vertex_buffers::before_remove_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	add_dirty_range(vtx_begin, poly.nr_vertices());
+}
+
+/// construct without gpu resources and connect to polygon signals
+polygon_vertex_buffers::polygon_vertex_buffers(polygon& _poly) :
+	poly(_poly),
+	position_buffer(cgv::render::VBT_VERTICES, cgv::render::VBU_DYNAMIC_DRAW),
+	color_buffer(cgv::render::VBT_VERTICES, cgv::render::VBU_DYNAMIC_DRAW),
+	capacity(0), dirty_begin(0), dirty_end(0), ranges_outofdate(true),
+	index_buffer(cgv::render::VBT_INDICES, cgv::render::VBU_DYNAMIC_DRAW),
+	index_capacity(0), lod_outofdate(true), lod_tolerance(0),
+	triangle_buffer(cgv::render::VBT_INDICES, cgv::render::VBU_DYNAMIC_DRAW),
+	triangle_capacity(0), nr_triangle_indices(0)
+{
+	cgv::signal::connect(_poly.after_insert_loop, this, &polygon_vertex_buffers::on_structure_change);
+	cgv::signal::connect(_poly.on_change_loop, this, &polygon_vertex_buffers::on_change_loop);
+	cgv::signal::connect(_poly.before_remove_loop, this, &polygon_vertex_buffers::on_structure_change);
+	cgv::signal::connect(_poly.after_insert_vertex, this, &polygon_vertex_buffers::after_insert_vertex);
+	cgv::signal::connect(_poly.on_change_vertex, this, &polygon_vertex_buffers::on_change_vertex);
+	cgv::signal::connect(_poly.on_change_vertex_range, this, &polygon_vertex_buffers::on_change_vertex_range);
+	cgv::signal::connect(_poly.before_remove_vertex, this, &polygon_vertex_buffers::before_remove_vertex);
+	cgv::signal::connect(_poly.before_remove_vertex_range, this, &polygon_vertex_buffers::before_remove_vertex_range);
+	cgv::signal::connect(_poly.on_new_polygon, this, &polygon_vertex_buffers::on_new_polygon);
+}
+
+/// upload changed vertex ranges, reallocating the buffers if the polygon outgrew them
+void polygon_vertex_buffers::update(const cgv::render::context& ctx)
+{
+	size_t n = poly.nr_vertices();
+	if (n > capacity) {
+		position_buffer.destruct(ctx);
+		color_buffer.destruct(ctx);
+		capacity = std::max(n, capacity + capacity / 2);
+		position_buffer.create(ctx, capacity*sizeof(vtx_type));
+		color_buffer.create(ctx, capacity*sizeof(clr_type));
+		dirty_begin = 0;
+		dirty_end = n;
+	}
+	dirty_end = std::min(dirty_end, n);
+	if (dirty_begin >= dirty_end)
+		return;
+	size_t count = dirty_end - dirty_begin;
+	// chunked and mapped vertex storage needs to be gathered into contiguous memory
+	const vtx_type* positions = poly.vertex_data();
+	if (positions)
+		positions += dirty_begin;
+	else {
+		staging_positions.resize(count);
+		poly.copy_vertices(dirty_begin, dirty_end, &staging_positions[0]);
+		positions = &staging_positions[0];
+	}
+	position_buffer.replace(ctx, dirty_begin*sizeof(vtx_type), positions, count);
+	staging_colors.resize(count);
+	for (size_t li = poly.find_loop(dirty_begin); li < poly.nr_loops() && poly.loop_begin(li) < dirty_end; ++li) {
+		size_t vbegin = std::max(poly.loop_begin(li), dirty_begin);
+		size_t vend = std::min(poly.loop_end(li), dirty_end);
+		std::fill(staging_colors.begin() + (vbegin - dirty_begin), staging_colors.begin() + (vend - dirty_begin), poly.loop_color(li));
+	}
+	color_buffer.replace(ctx, dirty_begin*sizeof(clr_type), &staging_colors[0], count);
+	dirty_begin = dirty_end = 0;
+}
+
+/// return buffer with the vertex locations, which is valid after update
+const cgv::render::vertex_buffer& polygon_vertex_buffers::get_position_buffer() const
+{
+	return position_buffer;
+}
+
+/// draw loops with at least two vertices as lines in their loop colors with fixed function vertex arrays; if a simplifier is given, only the vertices selected for the tolerance are drawn
+void polygon_vertex_buffers::draw_lines(const cgv::render::context& ctx, polygon_simplifier* simplifier, float tolerance)
+{
+	update(ctx);
+	if (poly.nr_vertices() == 0)
+		return;
+	if (ranges_outofdate)
+		update_ranges();
+	bool use_lod = simplifier != 0 && tolerance > 0;
+	if (use_lod && (lod_outofdate || tolerance != lod_tolerance))
+		update_lod(ctx, *simplifier, tolerance);
+
+	glBindBuffer(GL_ARRAY_BUFFER, cgv::render::gl::get_gl_id(position_buffer.handle));
+	glVertexPointer(2, GL_FLOAT, 0, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, cgv::render::gl::get_gl_id(color_buffer.handle));
+	glColorPointer(3, GL_UNSIGNED_BYTE, 0, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	static const GLenum modes[2] = { GL_LINE_STRIP, GL_LINE_LOOP };
+	if (use_lod) {
+		if (!lod_indices.empty()) {
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cgv::render::gl::get_gl_id(index_buffer.handle));
+			for (int m = 0; m < 2; ++m)
+				if (!lod_counts[m].empty())
+					glMultiDrawElements(modes[m], &lod_counts[m][0], GL_UNSIGNED_INT, &lod_offsets[m][0], GLsizei(lod_counts[m].size()));
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		}
+	}
+	else
+		for (int m = 0; m < 2; ++m)
+			if (!counts[m].empty())
+				glMultiDrawArrays(modes[m], &firsts[m][0], &counts[m][0], GLsizei(counts[m].size()));
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+/// draw triangles of the closed loops in the current color, uploading them if the triangulation changed
+void polygon_vertex_buffers::draw_triangles(const cgv::render::context& ctx, polygon_triangulator& triangulator)
+{
+	update(ctx);
+	// a destructed buffer is filled again even if the triangulation did not change
+	if (triangulator.update() || triangle_capacity == 0) {
+		const std::vector<uint32_t>& triangles = triangulator.get_triangles();
+		if (triangles.size() > triangle_capacity) {
+			triangle_buffer.destruct(ctx);
+			triangle_capacity = std::max(triangles.size(), triangle_capacity + triangle_capacity / 2);
+			triangle_buffer.create(ctx, triangle_capacity*sizeof(uint32_t));
+		}
+		if (!triangles.empty())
+			triangle_buffer.replace(ctx, 0, &triangles[0], triangles.size());
+		nr_triangle_indices = triangles.size();
+	}
+	if (nr_triangle_indices == 0)
+		return;
+	glBindBuffer(GL_ARRAY_BUFFER, cgv::render::gl::get_gl_id(position_buffer.handle));
+	glVertexPointer(2, GL_FLOAT, 0, 0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cgv::render::gl::get_gl_id(triangle_buffer.handle));
+	glDrawElements(GL_TRIANGLES, GLsizei(nr_triangle_indices), GL_UNSIGNED_INT, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+/// destruct gpu buffers
+void polygon_vertex_buffers::clear(const cgv::render::context& ctx)
+{
+	position_buffer.destruct(ctx);
+	color_buffer.destruct(ctx);
+	index_buffer.destruct(ctx);
+	triangle_buffer.destruct(ctx);
+	// buffers are recreated and filled completely on the next update
+	capacity = 0;
+	index_capacity = 0;
+	triangle_capacity = 0;
+	nr_triangle_indices = 0;
+	lod_outofdate = true;
+}
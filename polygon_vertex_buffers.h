@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cgv/render/context.h>
+#include <cgv/render/vertex_buffer.h>
+#include "polygon.h"
+#include "polygon_simplifier.h"
+#include "polygon_triangulator.h"
+
+/// persistent gpu copies of the vertex locations and loop colors of a polygon; the vertex ranges reported by the polygon signals are uploaded before the next draw and loops are drawn with one multi draw call per primitive type, such that drawing an unchanged polygon costs no per vertex work on the cpu
+class polygon_vertex_buffers : public cgv::signal::tacker, public polygon_types
+{
+protected:
+	const polygon& poly;
+	/// vertex locations and per vertex copies of the loop colors
+	cgv::render::vertex_buffer position_buffer, color_buffer;
+	/// number of vertices for which buffer memory is allocated
+	size_t capacity;
+	/// range of vertices that changed since the last upload, where the end can exceed the current number of vertices after removals
+	size_t dirty_begin, dirty_end;
+	/// staging memory for vertex ranges of chunked or mapped vertex storage and for loop colors
+	std::vector<vtx_type> staging_positions;
+	std::vector<clr_type> staging_colors;
+
+	/// whether the draw ranges need to be recomputed from the loops
+	bool ranges_outofdate;
+	/// first vertex and vertex count of the loops drawn as line strips at index 0 and as line loops at index 1
+	std::vector<int> firsts[2], counts[2];
+
+	/// element buffer with the vertices of the simplified loops
+	cgv::render::vertex_buffer index_buffer;
+	/// number of indices for which buffer memory is allocated
+	size_t index_capacity;
+	/// whether the simplified loops need to be selected again, and the tolerance they were selected for
+	bool lod_outofdate;
+	float lod_tolerance;
+	/// indices of the simplified loops together with per loop counts and byte offsets into the element buffer for line strips at index 0 and line loops at index 1
+	std::vector<uint32_t> lod_indices;
+	std::vector<int> lod_counts[2];
+	std::vector<const void*> lod_offsets[2];
+	std::vector<size_t> selection;
+
+	/// element buffer with the triangle vertices of the filled loops
+	cgv::render::vertex_buffer triangle_buffer;
+	/// number of indices for which buffer memory is allocated and number of uploaded indices
+	size_t triangle_capacity, nr_triangle_indices;
+
+	/// extend dirty range by given vertex range
+	void add_dirty_range(size_t vtx_begin, size_t vtx_end);
+	/// recompute draw ranges from loops
+	void update_ranges();
+	/// select simplified loops for given tolerance and upload their indices
+	void update_lod(const cgv::render::context& ctx, polygon_simplifier& simplifier, float tolerance);
+
+	/// callbacks used to collect changes
+	void on_new_polygon();
+	void on_structure_change(size_t);
+	void on_change_loop(size_t loop_idx, int flags);
+	void after_insert_vertex(size_t vtx_idx);
+	void on_change_vertex(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
+	void before_remove_vertex(size_t vtx_idx);
+	void before_remove_vertex_range(size_t vtx_begin, size_t vtx_end);
+public:
+	/// construct without gpu resources and connect to polygon signals
+	polygon_vertex_buffers(polygon& _poly);
+	/// upload changed vertex ranges, reallocating the buffers if the polygon outgrew them
+	void update(const cgv::render::context& ctx);
+	/// return buffer with the vertex locations, which is valid after update
+	const cgv::render::vertex_buffer& get_position_buffer() const;
+	/// draw loops with at least two vertices as lines in their loop colors with fixed function vertex arrays; if a simplifier is given, only the vertices selected for the tolerance are drawn
+	void draw_lines(const cgv::render::context& ctx, polygon_simplifier* simplifier = 0, float tolerance = 0);
+	/// draw triangles of the closed loops in the current color, uploading them if the triangulation changed
+	void draw_triangles(const cgv::render::context& ctx, polygon_triangulator& triangulator);
+	/// destruct gpu buffers
+	void clear(const cgv::render::context& ctx);
+};
@@ -6,6 +6,7 @@
 #include <cgv/gui/mouse_event.h>
 #include <cgv_gl/gl/gl.h>
 #include <fstream>
+#include <iostream>
 
 using namespace cgv::base;
 using namespace cgv::signal;
@@ -27,6 +28,11 @@ void polygon_view::after_insert_loop(size_t loop_idx)
 
 void polygon_view::on_change_loop(size_t loop_idx, int flags)
 {
+	// size changes of preceding loops move the begin of the current loop, which is not signaled separately
+	if (loop_idx < loop_index && (flags & PLA_SIZE) != 0) {
+		current_loop.first_vertex = poly.loop_begin(loop_index);
+		update_member(&current_loop.first_vertex);
+	}
 	if (loop_idx != loop_index)
 		return;
 	if ((flags & PLA_BEGIN) != 0) {
@@ -89,6 +95,7 @@ void polygon_view::before_remove_loop(size_t loop_idx)
 
 void polygon_view::after_insert_vertex(size_t vtx_idx)
 {
+	vertex_colors_outofdate = true;
 	if (vtx_idx <= vertex_index) {
 		++vertex_index;
 		update_member(&vertex_index);
@@ -106,8 +113,16 @@ void polygon_view::on_change_vertex(size_t vtx_idx)
 	update_member(&current_vertex[1]);
 }
 
+void polygon_view::on_change_vertex_range(size_t vtx_begin, size_t vtx_end)
+{
+	if (vertex_index >= vtx_begin && vertex_index < vtx_end)
+		on_change_vertex(vertex_index);
+	post_redraw();
+}
+
 void polygon_view::before_remove_vertex(size_t vtx_idx)
 {
+	vertex_colors_outofdate = true;
 	if (poly.nr_vertices() == 1) {
 		if (find_control(vertex_index))
 			find_control(vertex_index)->set("max", 0);
@@ -138,6 +153,7 @@ void polygon_view::before_remove_vertex(size_t vtx_idx)
 
 void polygon_view::before_remove_vertex_range(size_t vtx_begin, size_t vtx_end)
 {
+	vertex_colors_outofdate = true;
 	if (poly.nr_vertices() == vtx_end-vtx_begin) {
 		if (find_control(vertex_index))
 			find_control(vertex_index)->set("max", 0);
@@ -179,70 +195,25 @@ void polygon_view::on_new_polygon()
 	on_set(&vertex_index);
 
 	std::fill(vertex_colors.begin(), vertex_colors.end(), clr_type(128, 128, 128));
+	vertex_colors_outofdate = true;
+	vertex_storage_mode = poly.get_vertex_storage_mode();
+	update_member(&vertex_storage_mode);
 	post_redraw();
 }
 
 /// find closest polygon vertex to p that is less than max_dist appart
-size_t polygon_view::find_closest_vertex(const vtx_type& p, float max_dist) const
+size_t polygon_view::find_closest_vertex(const vtx_type& p, float max_dist)
 {
-	size_t vtx_idx = size_t(-1);
-	float min_dist = 0;
-	for (size_t vi = 0; vi < poly.nr_vertices(); ++vi) {
-		float dist = (poly.vertex(vi) - p).length();
-		if (dist <= max_dist) {
-			if (vtx_idx == size_t(-1) || dist < min_dist) {
-				min_dist = dist;
-				vtx_idx = vi;
-			}
-		}
-	}
-	return vtx_idx;
+	return edge_grid.find_closest_vertex(p, max_dist);
 }
 
 /// find closest polygon edge to p that is less than max_dist appart and set edge_point to closest point on found edge
-size_t polygon_view::find_closest_edge(const vtx_type& p, float max_dist, vtx_type& edge_point) const
+size_t polygon_view::find_closest_edge(const vtx_type& p, float max_dist, vtx_type& edge_point)
 {
-	size_t edge_insert_vtx_index = size_t(-1);
-	float min_dist = 0;
-
-	// iterate all edges
-	for (size_t li = 0; li < poly.nr_loops(); ++li) {
-		size_t vbegin = poly.loop_begin(li);
-		size_t vi_last = poly.loop_end(li) - 1;
-		if (!poly.loop_closed(li)) {
-			vi_last = vbegin;
-			++vbegin;
-		}
-		for (size_t vi = vbegin; vi < poly.loop_end(li); ++vi) {
-			// for each edge extract vertex locations
-			const vtx_type& p0 = poly.vertex(vi_last);
-			const vtx_type& p1 = poly.vertex(vi);
-
-			// compute edge lambda and check that it is in [0,1]
-			vtx_type d = p1 - p0;
-			float lambda = dot(p - p0, d) / dot(d, d);
-			if (lambda > 0 && lambda < 1) {
-
-				// compute projected point
-				vtx_type projected_point = p0 + lambda*d;
-				float dist = (projected_point - p).length();
-
-				// check distance
-				if (dist < max_dist) {
-					if (edge_insert_vtx_index == size_t(-1) || dist < min_dist) {
-						min_dist = dist;
-						edge_insert_vtx_index = vi;
-						edge_point = projected_point;
-					}
-				}
-			}
-			vi_last = vi;
-		}
-	}
-	return edge_insert_vtx_index;
+	return edge_grid.find_closest_edge(p, max_dist, edge_point);
 }
 
-polygon_view::polygon_view() : cgv::base::group("polygon_view"), current_loop(0,1)
+polygon_view::polygon_view() : cgv::base::group("polygon_view"), current_loop(0,1), edge_grid(poly), simplifier(poly), triangulator(poly), intersection_finder(poly), vertex_buffers(poly)
 {
 	rasterizer = new polygon_rasterizer(poly);
 
@@ -259,8 +230,10 @@ polygon_view::polygon_view() : cgv::base::group("polygon_view"), current_loop(0,
 	connect(poly.before_remove_loop        , this, &polygon_view::before_remove_loop);
 	connect(poly.after_insert_vertex       , this, &polygon_view::after_insert_vertex);
 	connect(poly.on_change_vertex          , this, &polygon_view::on_change_vertex);
+	connect(poly.on_change_vertex_range    , this, &polygon_view::on_change_vertex_range);
 	connect(poly.before_remove_vertex      , this, &polygon_view::before_remove_vertex);
 	connect(poly.before_remove_vertex_range, this, &polygon_view::before_remove_vertex_range);
+	connect(poly.on_new_polygon            , this, &polygon_view::on_new_polygon);
 
 	on_new_polygon();
 
@@ -274,6 +247,14 @@ polygon_view::polygon_view() : cgv::base::group("polygon_view"), current_loop(0,
 
 	loop_index = 0;
 	vertex_index = 0;
+	vertex_storage_mode = poly.get_vertex_storage_mode();
+	use_simplification = true;
+	simplification_method = simplifier.get_method();
+	simplification_tolerance = 0.5f;
+	fill_polygon = false;
+	fill_color = clr_type(160, 200, 255);
+	show_intersections = false;
+	vertex_colors_outofdate = true;
 }
 
 void polygon_view::stream_help(std::ostream& os)
@@ -300,38 +281,82 @@ bool polygon_view::init(context& ctx)
 void polygon_view::clear(context& ctx)
 {
 	pnt_renderer.clear(ctx);
+	vertex_buffers.clear(ctx);
+	vertex_color_buffer.destruct(ctx);
+	vertex_colors_outofdate = true;
 }
 
-void polygon_view::draw_polygon()
+void polygon_view::draw_polygon(context& ctx)
 {
-	for (size_t li = 0; li < poly.nr_loops(); ++li) {
-		if (poly.loop_size(li) < 2)
-			continue;
-		GLenum gl_type = poly.loop_closed(li) ? GL_LINE_LOOP : GL_LINE_STRIP;
-		glColor3ubv(&poly.loop_color(li)[0]);
-		glBegin(gl_type);
-		for (size_t vi=poly.loop_begin(li); vi<poly.loop_end(li); ++vi)
-			glVertex2fv(poly.vertex(vi));
-		glEnd();
-	}
+	// vertices whose removal changes a loop by less than the tolerance are skipped
+	float tolerance = 0;
+	if (use_simplification && view_ptr)
+		tolerance = (float)(simplification_tolerance * view_ptr->get_y_extent_at_focus() / ctx.get_height());
+	vertex_buffers.draw_lines(ctx, &simplifier, tolerance);
 }
 
-
-void polygon_view::draw_vertices(context& ctx)
+void polygon_view::draw_filled_polygon(context& ctx)
 {
-	clr_type tmp(255,0,255);
-	if (selected_index != size_t(-1))
-		std::swap(tmp, vertex_colors[selected_index]);
+	glColor3ubv(&fill_color[0]);
+	vertex_buffers.draw_triangles(ctx, triangulator);
+}
 
-	pnt_renderer.set_color_array(ctx, vertex_colors);
-	pnt_renderer.set_position_array(ctx, &poly.vertex(0), poly.nr_vertices());
+void polygon_view::draw_intersections(context& ctx)
+{
+	intersection_finder.update(edge_grid);
+	const std::vector<polygon_intersection>& intersections = intersection_finder.get_intersections();
+	if (intersections.empty())
+		return;
+	intersection_lines.clear();
+	intersection_points.clear();
+	for (const polygon_intersection& pi : intersections) {
+		intersection_lines.push_back(poly.vertex(intersection_finder.edge_start(pi.edge0)));
+		intersection_lines.push_back(poly.vertex(pi.edge0));
+		intersection_lines.push_back(poly.vertex(intersection_finder.edge_start(pi.edge1)));
+		intersection_lines.push_back(poly.vertex(pi.edge1));
+		intersection_points.push_back(pi.location);
+	}
+	glColor3f(1, 0, 0);
+	glVertexPointer(2, GL_FLOAT, 0, &intersection_lines[0]);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glDrawArrays(GL_LINES, 0, GLsizei(intersection_lines.size()));
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	std::vector<clr_type> colors(intersection_points.size(), clr_type(255, 0, 0));
+	pnt_renderer.set_color_array(ctx, &colors[0], colors.size());
+	pnt_renderer.set_position_array(ctx, &intersection_points[0], intersection_points.size());
 	pnt_renderer.validate_and_enable(ctx);
-	glDrawArrays(GL_POINTS, 0, poly.nr_vertices());
+	glDrawArrays(GL_POINTS, 0, GLsizei(intersection_points.size()));
 	pnt_renderer.disable(ctx);
+}
 
-	if (selected_index != size_t(-1))
-		std::swap(tmp, vertex_colors[selected_index]);
+void polygon_view::draw_vertices(context& ctx)
+{
+	vertex_buffers.update(ctx);
+	if (vertex_colors_outofdate) {
+		vertex_colors.resize(poly.nr_vertices(), clr_type(128, 128, 128));
+		vertex_color_buffer.destruct(ctx);
+		if (!vertex_colors.empty())
+			vertex_color_buffer.create(ctx, vertex_colors);
+		vertex_colors_outofdate = false;
+	}
+	if (poly.nr_vertices() > 0) {
+		pnt_renderer.set_color_array<clr_type>(ctx, vertex_color_buffer, 0, poly.nr_vertices());
+		pnt_renderer.set_position_array<vtx_type>(ctx, vertex_buffers.get_position_buffer(), 0, poly.nr_vertices());
+		pnt_renderer.validate_and_enable(ctx);
+		glDrawArrays(GL_POINTS, 0, GLsizei(poly.nr_vertices()));
+		pnt_renderer.disable(ctx);
+	}
 
+	// highlighted vertices are drawn on top from client memory, such that the buffers stay untouched
+	clr_type tmp(255,0,255);
+	if (selected_index != size_t(-1)) {
+		pnt_renderer.set_color_array(ctx, &tmp, 1);
+		pnt_renderer.set_position_array(ctx, &poly.vertex(selected_index), 1);
+		pnt_renderer.validate_and_enable(ctx);
+		glDrawArrays(GL_POINTS, 0, 1);
+		pnt_renderer.disable(ctx);
+	}
 
 	if (edge_insert_vtx_index != size_t(-1)) {
 		pnt_renderer.set_color_array(ctx, &tmp, 1);
@@ -350,10 +375,14 @@ void polygon_view::init_frame(context& ctx)
 
 void polygon_view::draw(context& ctx)
 {
+	if (fill_polygon)
+		draw_filled_polygon(ctx);
 	draw_vertices(ctx);
 	glLineWidth(5);
 	glColor3f(0.8f, 0.5f, 0);
-	draw_polygon();
+	draw_polygon(ctx);
+	if (show_intersections)
+		draw_intersections(ctx);
 
 	if (rasterizer->is_visible())
 		rasterizer->draw(ctx);
@@ -380,9 +409,28 @@ bool polygon_view::handle(event& e)
 			poly.write(QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.txt");
 			break;
 		case 'R':
-			poly.clear();
-			poly.read(QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.txt");
-			on_new_polygon();
+			if (!poly.read(QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.txt"))
+				std::cerr << poly.get_last_error() << std::endl;
+			break;
+		case 'B':
+			poly.write_binary(QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.pbin");
+			break;
+		case 'L':
+			if (!poly.read_binary(QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.pbin"))
+				std::cerr << poly.get_last_error() << std::endl;
+			break;
+		case 'M': {
+			// preview of the mask of a file that is not loaded into the polygon
+			polygon_stream stream(polygon_stream::block_size / sizeof(vtx_type));
+			if (!rasterizer->rasterize_stream(stream, QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.txt"))
+				std::cerr << rasterizer->get_last_error() << std::endl;
+			post_redraw();
+			break;
+		}
+		case 'T':
+			// image at a resolution beyond the texture size, which is rasterized through sparse tiles
+			if (!rasterizer->write_tile_image(QUOTE_SYMBOL_VALUE(INPUT_DIR) "/my_poly.ppm"))
+				std::cerr << rasterizer->get_last_error() << std::endl;
 			break;
 		default: break;
 		}
@@ -432,15 +480,20 @@ bool polygon_view::handle(event& e)
 						switch (me.get_modifiers()) {
 						case 0:
 							poly.set_vertex(selected_index, poly.vertex(selected_index) + diff);
+							// only the two edges incident to the dragged vertex are tested again
+							if (show_intersections)
+								intersection_finder.update(edge_grid);
 							on_set(const_cast<vtx_type*>(&poly.vertex(selected_index)));
 							return true;
 						case cgv::gui::EM_CTRL:
 						{
 							size_t loop_idx = poly.find_loop(selected_index);
-							for (size_t vi = poly.loop_begin(loop_idx); vi < poly.loop_end(loop_idx); ++vi) {
-								poly.set_vertex(vi, poly.vertex(vi) + diff, false);
-								on_set(const_cast<vtx_type*>(&poly.vertex(selected_index)));
+							{
+								polygon_batch batch(poly);
+								for (size_t vi = poly.loop_begin(loop_idx); vi < poly.loop_end(loop_idx); ++vi)
+									poly.set_vertex(vi, poly.vertex(vi) + diff);
 							}
+							on_set(const_cast<vtx_type*>(&poly.vertex(selected_index)));
 							return true;
 						}
 						}
@@ -522,10 +575,6 @@ bool polygon_view::handle(event& e)
 
 void polygon_view::on_set(void* member_ptr)
 {
-	if (poly.nr_vertices() > 0 && member_ptr >= &poly.vertex(0) && member_ptr < &poly.vertex(0)+poly.nr_vertices()) {
-		rasterizer->rasterize_polygon();
-	}
-
 	if (member_ptr == &loop_index) {
 		current_loop.color = poly.loop_color(loop_index);
 		current_loop.first_vertex = poly.loop_begin(loop_index);
@@ -552,7 +601,6 @@ void polygon_view::on_set(void* member_ptr)
 	}
 	if (member_ptr >= &current_vertex && member_ptr < &current_vertex + 1) {
 		poly.set_vertex(vertex_index, current_vertex);
-		rasterizer->rasterize_polygon();
 	}
 	if (member_ptr == &selected_index) {
 		if (selected_index != size_t(-1) && vertex_index != selected_index) {
@@ -565,6 +613,13 @@ void polygon_view::on_set(void* member_ptr)
 			}
 		}
 	}
+	if (member_ptr == &vertex_storage_mode) {
+		// mapped storage results only from reading binary files
+		poly.set_vertex_storage_mode(vertex_storage_mode);
+		vertex_storage_mode = poly.get_vertex_storage_mode();
+	}
+	if (member_ptr == &simplification_method)
+		simplifier.set_method(simplification_method);
 	if (member_ptr == &vertex_index) {
 		current_vertex = poly.vertex(vertex_index);
 		update_member(&current_vertex[0]);
@@ -585,12 +640,19 @@ void polygon_view::create_gui()
 		align("\a");
 			add_member_control(this, "background_color", background_color);
 			add_gui("point style", pnt_render_style);
+			add_member_control(this, "simplification", use_simplification, "toggle");
+			add_member_control(this, "simplification method", simplification_method, "dropdown", "enums='douglas peucker,visvalingam whyatt'");
+			add_member_control(this, "simplification tolerance", simplification_tolerance, "value_slider", "min=0.1;max=10;log=true;ticks=true");
+			add_member_control(this, "fill polygon", fill_polygon, "toggle");
+			add_member_control(this, "fill color", fill_color);
+			add_member_control(this, "show intersections", show_intersections, "toggle");
 		align("\b");
 		end_tree_node(pnt_render_style);
 	}
 
 	if (begin_tree_node("polygon", poly)) {
 		align("\a");
+			add_member_control(this, "vertex storage", vertex_storage_mode, "dropdown", "enums='contiguous,chunked,mapped'");
 			add_member_control(this, "loop_index", loop_index, "value_slider", "min=0;max=1;ticks=true");
 			find_control(loop_index)->set("max", poly.nr_loops() - 1);
 			align("\a");
@@ -3,6 +3,11 @@
 #include <cgv/base/group.h>
 #include "polygon.h"
 #include "polygon_rasterizer.h"
+#include "polygon_edge_grid.h"
+#include "polygon_intersection_finder.h"
+#include "polygon_simplifier.h"
+#include "polygon_triangulator.h"
+#include "polygon_vertex_buffers.h"
 #include <cgv/gui/event_handler.h>
 #include <cgv/gui/provider.h>
 #include <cgv/render/drawable.h>
@@ -42,7 +47,29 @@ private:
 	// polygon members
 protected:
 	polygon poly;
+	/// spatial index used for picking
+	polygon_edge_grid edge_grid;
+	/// vertex importance hierarchy used to draw loops with the detail resolvable at the current zoom
+	polygon_simplifier simplifier;
+	bool use_simplification;
+	SimplificationMethod simplification_method;
+	/// tolerance of the simplification in pixels
+	float simplification_tolerance;
+	/// triangulation of the closed loops used to draw them filled
+	polygon_triangulator triangulator;
+	bool fill_polygon;
+	clr_type fill_color;
+	/// intersecting edges highlighted while dragging vertices
+	polygon_intersection_finder intersection_finder;
+	bool show_intersections;
+	std::vector<vtx_type> intersection_lines, intersection_points;
+	VertexStorageMode vertex_storage_mode;
 	std::vector<clr_type> vertex_colors;
+	/// gpu copies of vertex locations and loop colors that are updated from the polygon signals
+	polygon_vertex_buffers vertex_buffers;
+	/// gpu copy of the vertex colors, which is recreated whenever vertices are inserted or removed
+	cgv::render::vertex_buffer vertex_color_buffer;
+	bool vertex_colors_outofdate;
 
 	// managed objects
 	cgv::data::ref_ptr<polygon_rasterizer> rasterizer;
@@ -55,13 +82,14 @@ protected:
 	void before_remove_loop(size_t loop_idx);
 	void after_insert_vertex(size_t vtx_idx);
 	void on_change_vertex(size_t vtx_idx);
+	void on_change_vertex_range(size_t vtx_begin, size_t vtx_end);
 	void before_remove_vertex(size_t vtx_idx);
 	void before_remove_vertex_range(size_t vtx_begin, size_t vtx_end);
 
 	/// find closest polygon vertex to p that is less than max_dist appart
-	size_t find_closest_vertex(const vtx_type& p, float max_dist) const;
+	size_t find_closest_vertex(const vtx_type& p, float max_dist);
 	/// find closest polygon edge to p that is less than max_dist appart; return vertex index where edge point needs to be inserted and set edge_point to closest point on found edge
-	size_t find_closest_edge(const vtx_type& p, float max_dist, vtx_type& edge_point) const;
+	size_t find_closest_edge(const vtx_type& p, float max_dist, vtx_type& edge_point);
 public:
 
 	/// object management functions
@@ -74,7 +102,9 @@ public:
 	// rendering functions
 	bool init(cgv::render::context& ctx);
 	void init_frame(cgv::render::context& ctx);
-	void draw_polygon();
+	void draw_polygon(cgv::render::context& ctx);
+	void draw_filled_polygon(cgv::render::context& ctx);
+	void draw_intersections(cgv::render::context& ctx);
 	void draw_vertices(cgv::render::context& ctx);
 	void draw(cgv::render::context& ctx);
 	void stream_help(std::ostream& os);
@@ -0,0 +1,173 @@
+#include "raster_kernels.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RASTER_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define RASTER_KERNELS_AVX2_TARGET
+#else
+#include <cpuid.h>
+#define RASTER_KERNELS_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef polygon_types::clr_type clr_type;
+
+static_assert(sizeof(clr_type) == 3, "rgb8 colors need to be packed into three bytes");
+
+/// construct pattern alternating between c0 and c1
+raster_pattern::raster_pattern(const clr_type& c0, const clr_type& c1)
+{
+	for (unsigned ci = 0; ci < 3; ++ci) {
+		bytes[ci] = c0[ci];
+		bytes[ci + 3] = c1[ci];
+	}
+	for (size_t n = 6; n < size; n *= 2)
+		std::memcpy(bytes + n, bytes, std::min(n, size - n));
+}
+
+static void fill_row_scalar(clr_type* dst, size_t nr_pixels, const raster_pattern& pattern)
+{
+	cgv::type::uint8_type* ptr = &dst[0][0];
+	size_t nr_bytes = 3 * nr_pixels, i = 0;
+	for (; i + 6 <= nr_bytes; i += 6)
+		std::memcpy(ptr + i, pattern.bytes, 6);
+	std::memcpy(ptr + i, pattern.bytes, nr_bytes - i);
+}
+
+#ifdef RASTER_KERNELS_X86
+static void fill_row_sse2(clr_type* dst, size_t nr_pixels, const raster_pattern& p)
+{
+	const cgv::type::uint8_type* pattern = p.bytes;
+	cgv::type::uint8_type* ptr = &dst[0][0];
+	size_t nr_bytes = 3 * nr_pixels, i = 0;
+	// 48 bytes cover 16 pixels such that each block starts with c0
+	__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+	__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + 16));
+	__m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern + 32));
+	for (; i + 48 <= nr_bytes; i += 48) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr + i), v0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr + i + 16), v1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr + i + 32), v2);
+	}
+	std::memcpy(ptr + i, pattern, nr_bytes - i);
+}
+
+RASTER_KERNELS_AVX2_TARGET
+static void fill_row_avx2(clr_type* dst, size_t nr_pixels, const raster_pattern& p)
+{
+	const cgv::type::uint8_type* pattern = p.bytes;
+	cgv::type::uint8_type* ptr = &dst[0][0];
+	size_t nr_bytes = 3 * nr_pixels, i = 0;
+	// 96 bytes cover 32 pixels such that each block starts with c0
+	__m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern));
+	__m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern + 32));
+	__m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pattern + 64));
+	for (; i + 96 <= nr_bytes; i += 96) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr + i), v0);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr + i + 32), v1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr + i + 64), v2);
+	}
+	std::memcpy(ptr + i, pattern, nr_bytes - i);
+}
+
+/// check cpu and operating system support for avx2
+static bool cpu_supports_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+	__cpuid(info, 1);
+	// osxsave and avx
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	// os saves xmm and ymm registers
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+#endif
+
+/// return the fastest kernel supported by the cpu
+RasterKernel raster_kernels::get_best_kernel()
+{
+	if (is_supported(RK_AVX2))
+		return RK_AVX2;
+	if (is_supported(RK_SSE2))
+		return RK_SSE2;
+	return RK_SCALAR;
+}
+
+/// return whether given kernel is supported by the compiler and the cpu
+bool raster_kernels::is_supported(RasterKernel kernel)
+{
+	switch (kernel) {
+	case RK_SCALAR: return true;
+#ifdef RASTER_KERNELS_X86
+	case RK_SSE2: return true;
+	case RK_AVX2: {
+		static bool avx2 = cpu_supports_avx2();
+		return avx2;
+	}
+#endif
+	default: return false;
+	}
+}
+
+/// return the name of a kernel
+const char* raster_kernels::get_kernel_name(RasterKernel kernel)
+{
+	switch (kernel) {
+	case RK_SCALAR: return "scalar";
+	case RK_SSE2: return "sse2";
+	case RK_AVX2: return "avx2";
+	default: return "unknown";
+	}
+}
+
+static RasterKernel selected_kernel = raster_kernels::get_best_kernel();
+
+static raster_kernels::fill_row_func get_fill_row_func(RasterKernel kernel)
+{
+	switch (kernel) {
+#ifdef RASTER_KERNELS_X86
+	case RK_SSE2: return &fill_row_sse2;
+	case RK_AVX2: return &fill_row_avx2;
+#endif
+	default: return &fill_row_scalar;
+	}
+}
+
+static raster_kernels::fill_row_func selected_fill_row = get_fill_row_func(selected_kernel);
+
+/// select the kernel used by fill_row
+bool raster_kernels::select_kernel(RasterKernel kernel)
+{
+	if (!is_supported(kernel))
+		return false;
+	selected_kernel = kernel;
+	selected_fill_row = get_fill_row_func(kernel);
+	return true;
+}
+
+/// return currently selected kernel
+RasterKernel raster_kernels::get_selected_kernel()
+{
+	return selected_kernel;
+}
+
+/// write nr_pixels pixels of the pattern starting with its first color
+void raster_kernels::fill_row(clr_type* dst, size_t nr_pixels, const raster_pattern& pattern)
+{
+	selected_fill_row(dst, nr_pixels, pattern);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include "polygon.h"
+
+/// implementations of the row kernels used to write rgb8 pixels
+enum RasterKernel
+{
+	RK_SCALAR,
+	RK_SSE2,
+	RK_AVX2
+};
+
+/// repeating pattern of two rgb8 colors prepared for the row kernels
+struct raster_pattern : public polygon_types
+{
+	/// number of bytes, which is a multiple of the two pixel period and of the vector sizes
+	static const size_t size = 96;
+	/// pattern bytes starting with the first color
+	cgv::type::uint8_type bytes[size];
+	/// construct pattern alternating between c0 and c1, which coincide for solid fills
+	raster_pattern(const clr_type& c0 = clr_type(0, 0, 0), const clr_type& c1 = clr_type(0, 0, 0));
+};
+
+/// row kernels that write a raster pattern into rows of packed rgb8 pixels
+struct raster_kernels : public polygon_types
+{
+	/// signature of a row kernel writing nr_pixels pixels of the pattern
+	typedef void (*fill_row_func)(clr_type* dst, size_t nr_pixels, const raster_pattern& pattern);
+	/// return the fastest kernel supported by the cpu
+	static RasterKernel get_best_kernel();
+	/// return whether given kernel is supported by the compiler and the cpu
+	static bool is_supported(RasterKernel kernel);
+	/// return the name of a kernel
+	static const char* get_kernel_name(RasterKernel kernel);
+	/// select the kernel used by fill_row, which defaults to the best kernel; return false if not supported
+	static bool select_kernel(RasterKernel kernel);
+	/// return currently selected kernel
+	static RasterKernel get_selected_kernel();
+	/// write nr_pixels pixels of the pattern starting with its first color
+	static void fill_row(clr_type* dst, size_t nr_pixels, const raster_pattern& pattern);
+};
@@ -0,0 +1,207 @@
+#include "sparse_tile_image.h"
+#include <algorithm>
+#include <fstream>
+#include <cassert>
+
+/// construct image with all tiles set to background
+sparse_tile_image::sparse_tile_image(size_t _width, size_t _height, int _tile_size)
+{
+	bg_clr[0] = bg_clr[1] = fg_clr = clr_type(0, 0, 0);
+	resize(_width, _height, _tile_size);
+}
+
+/// set dimensions and tile size, which needs to be even such that all tiles start the checker board with the same color, and set all tiles to background
+void sparse_tile_image::resize(size_t _width, size_t _height, int _tile_size)
+{
+	assert(_tile_size > 0 && (_tile_size & 1) == 0);
+	width = _width;
+	height = _height;
+	tile_size = _tile_size;
+	nr_tile_cols = (width + tile_size - 1) / tile_size;
+	nr_tile_rows = (height + tile_size - 1) / tile_size;
+	tiles.clear();
+	tiles.resize(nr_tile_cols*nr_tile_rows);
+	for (size_t ti = 0; ti < tiles.size(); ++ti)
+		tiles[ti].state = TS_BACKGROUND;
+}
+
+/// return image width in pixels
+size_t sparse_tile_image::get_width() const
+{
+	return width;
+}
+
+/// return image height in pixels
+size_t sparse_tile_image::get_height() const
+{
+	return height;
+}
+
+/// return edge length of the tiles
+int sparse_tile_image::get_tile_size() const
+{
+	return tile_size;
+}
+
+/// return number of tile columns
+size_t sparse_tile_image::get_nr_tile_cols() const
+{
+	return nr_tile_cols;
+}
+
+/// return number of tile rows
+size_t sparse_tile_image::get_nr_tile_rows() const
+{
+	return nr_tile_rows;
+}
+
+/// set colors of uniform tiles
+void sparse_tile_image::set_colors(const clr_type& bg_clr0, const clr_type& bg_clr1, const clr_type& _fg_clr)
+{
+	bg_clr[0] = bg_clr0;
+	bg_clr[1] = bg_clr1;
+	fg_clr = _fg_clr;
+}
+
+/// return region of the tile in the given tile column and row
+sparse_tile_image::pixel_box_type sparse_tile_image::get_tile_region(size_t col, size_t row) const
+{
+	int x0 = int(col)*tile_size, y0 = int(row)*tile_size;
+	return pixel_box_type(pixel_type(x0, y0),
+		pixel_type(std::min(x0 + tile_size, int(width)) - 1, std::min(y0 + tile_size, int(height)) - 1));
+}
+
+/// return state of a tile
+TileState sparse_tile_image::get_tile_state(size_t col, size_t row) const
+{
+	return tiles[row*nr_tile_cols + col].state;
+}
+
+/// return pixels of a materialized tile or 0 for a uniform tile
+const sparse_tile_image::clr_type* sparse_tile_image::get_tile_pixels(size_t col, size_t row) const
+{
+	const tile_type& tile = tiles[row*nr_tile_cols + col];
+	return tile.state == TS_PIXELS ? &tile.pixels[0] : 0;
+}
+
+/// make tile uniform and release its pixels
+void sparse_tile_image::set_tile_uniform(size_t col, size_t row, TileState state)
+{
+	assert(state != TS_PIXELS);
+	tile_type& tile = tiles[row*nr_tile_cols + col];
+	tile.state = state;
+	std::vector<clr_type>().swap(tile.pixels);
+}
+
+/// materialize tile and return its pixels, whose content is undefined if the tile was uniform
+sparse_tile_image::clr_type* sparse_tile_image::materialize_tile(size_t col, size_t row)
+{
+	tile_type& tile = tiles[row*nr_tile_cols + col];
+	if (tile.state != TS_PIXELS) {
+		pixel_box_type region = get_tile_region(col, row);
+		tile.pixels.resize(size_t(region.get_extent()(0) + 1)*size_t(region.get_extent()(1) + 1));
+		tile.state = TS_PIXELS;
+	}
+	return &tile.pixels[0];
+}
+
+/// write the pixels of a tile into dst in the layout of the tile pixels, where uniform tiles are expanded
+void sparse_tile_image::expand_tile(size_t col, size_t row, clr_type* dst) const
+{
+	const tile_type& tile = tiles[row*nr_tile_cols + col];
+	if (tile.state == TS_PIXELS) {
+		std::copy(tile.pixels.begin(), tile.pixels.end(), dst);
+		return;
+	}
+	pixel_box_type region = get_tile_region(col, row);
+	int w = region.get_extent()(0) + 1;
+	for (int y = region.get_min_pnt()(1); y <= region.get_max_pnt()(1); ++y) {
+		if (tile.state == TS_FOREGROUND)
+			std::fill(dst, dst + w, fg_clr);
+		else
+			for (int x = 0; x < w; ++x)
+				dst[x] = bg_clr[(region.get_min_pnt()(0) + x + y) & 1];
+		dst += w;
+	}
+}
+
+/// return color of pixel (x,y)
+sparse_tile_image::clr_type sparse_tile_image::get_pixel(size_t x, size_t y) const
+{
+	const tile_type& tile = tiles[(y / tile_size)*nr_tile_cols + x / tile_size];
+	switch (tile.state) {
+	case TS_BACKGROUND:
+		return bg_clr[(x + y) & 1];
+	case TS_FOREGROUND:
+		return fg_clr;
+	default:
+		return tile.pixels[(y % tile_size)*std::min(size_t(tile_size), width - x / tile_size*tile_size) + x % tile_size];
+	}
+}
+
+/// return number of materialized tiles
+size_t sparse_tile_image::get_nr_materialized_tiles() const
+{
+	size_t n = 0;
+	for (size_t ti = 0; ti < tiles.size(); ++ti)
+		if (tiles[ti].state == TS_PIXELS)
+			++n;
+	return n;
+}
+
+/// return number of bytes used by the pixels of materialized tiles
+size_t sparse_tile_image::get_pixel_memory() const
+{
+	size_t n = 0;
+	for (size_t ti = 0; ti < tiles.size(); ++ti)
+		n += tiles[ti].pixels.capacity()*sizeof(clr_type);
+	return n;
+}
+
+/// pass tiles in row major order starting with the bottom tile row to the callback until it returns false, where uniform tiles are expanded into a scratch buffer if expand_uniform is set; return false if the export was stopped by the callback
+bool sparse_tile_image::export_tiles(const callback_type& callback, bool expand_uniform) const
+{
+	std::vector<clr_type> scratch;
+	if (expand_uniform)
+		scratch.resize(size_t(tile_size)*tile_size);
+	image_tile it;
+	for (it.row = 0; it.row < nr_tile_rows; ++it.row)
+		for (it.col = 0; it.col < nr_tile_cols; ++it.col) {
+			it.region = get_tile_region(it.col, it.row);
+			it.state = get_tile_state(it.col, it.row);
+			it.pixels = get_tile_pixels(it.col, it.row);
+			if (!it.pixels && expand_uniform) {
+				expand_tile(it.col, it.row, &scratch[0]);
+				it.pixels = &scratch[0];
+			}
+			if (!callback(it))
+				return false;
+		}
+	return true;
+}
+
+/// write image to a binary ppm file one tile row at a time, such that only the pixels of one tile row are expanded at once
+bool sparse_tile_image::write_ppm(const std::string& file_name) const
+{
+	std::ofstream os(file_name, std::ios::binary);
+	if (os.fail())
+		return false;
+	os << "P6\n" << width << " " << height << "\n255\n";
+	std::vector<clr_type> band(width*tile_size), scratch(size_t(tile_size)*tile_size);
+	// ppm stores the top row first, while pixel rows start at the bottom
+	for (size_t row = nr_tile_rows; row-- > 0; ) {
+		int y0 = get_tile_region(0, row).get_min_pnt()(1);
+		int h = get_tile_region(0, row).get_max_pnt()(1) - y0 + 1;
+		for (size_t col = 0; col < nr_tile_cols; ++col) {
+			pixel_box_type region = get_tile_region(col, row);
+			int w = region.get_extent()(0) + 1;
+			expand_tile(col, row, &scratch[0]);
+			for (int y = 0; y < h; ++y)
+				std::copy(&scratch[y*w], &scratch[y*w] + w, &band[y*width + region.get_min_pnt()(0)]);
+		}
+		for (int y = h; y-- > 0; )
+			os.write(reinterpret_cast<const char*>(&band[y*width]), std::streamsize(width*sizeof(clr_type)));
+	}
+	os.close();
+	return !os.fail();
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include "polygon.h"
+
+/// representation of a tile in a sparse tile image, where uniform tiles use no pixel memory
+enum TileState
+{
+	TS_BACKGROUND,
+	TS_FOREGROUND,
+	TS_PIXELS
+};
+
+/// tile passed to the export callback of a sparse tile image
+struct image_tile : public polygon_types
+{
+	typedef cgv::media::axis_aligned_box<int, 2> pixel_box_type;
+	/// tile column and row
+	size_t col, row;
+	/// pixels covered by the tile in inclusive pixel indices, which is clipped at the right and top image border
+	pixel_box_type region;
+	TileState state;
+	/// pixels of the region in row major order starting with the bottom row or 0 for a uniform tile that is not expanded
+	const clr_type* pixels;
+};
+
+/// rgb image stored as square tiles that are materialized lazily, where uniform tiles filled with the background checker board or the foreground color are represented by their state only
+class sparse_tile_image : public polygon_types
+{
+public:
+	typedef cgv::math::fvec<int, 2> pixel_type;
+	typedef cgv::media::axis_aligned_box<int, 2> pixel_box_type;
+	/// callback receiving the exported tiles, which returns false to stop the export
+	typedef std::function<bool(const image_tile&)> callback_type;
+protected:
+	size_t width, height;
+	int tile_size;
+	size_t nr_tile_cols, nr_tile_rows;
+	/// colors of the checker board, whose pixel (x,y) has color bg_clr[(x+y)&1], and of the foreground
+	clr_type bg_clr[2];
+	clr_type fg_clr;
+	struct tile_type
+	{
+		TileState state;
+		std::vector<clr_type> pixels;
+	};
+	std::vector<tile_type> tiles;
+public:
+	/// construct image with all tiles set to background
+	sparse_tile_image(size_t _width = 0, size_t _height = 0, int _tile_size = 256);
+	/// set dimensions and tile size, which needs to be even such that all tiles start the checker board with the same color, and set all tiles to background
+	void resize(size_t _width, size_t _height, int _tile_size = 256);
+	/// return image width in pixels
+	size_t get_width() const;
+	/// return image height in pixels
+	size_t get_height() const;
+	/// return edge length of the tiles
+	int get_tile_size() const;
+	/// return number of tile columns
+	size_t get_nr_tile_cols() const;
+	/// return number of tile rows
+	size_t get_nr_tile_rows() const;
+	/// set colors of uniform tiles
+	void set_colors(const clr_type& bg_clr0, const clr_type& bg_clr1, const clr_type& _fg_clr);
+	/// return region of the tile in the given tile column and row
+	pixel_box_type get_tile_region(size_t col, size_t row) const;
+	/// return state of a tile
+	TileState get_tile_state(size_t col, size_t row) const;
+	/// return pixels of a materialized tile or 0 for a uniform tile
+	const clr_type* get_tile_pixels(size_t col, size_t row) const;
+	/// make tile uniform and release its pixels
+	void set_tile_uniform(size_t col, size_t row, TileState state);
+	/// materialize tile and return its pixels, whose content is undefined if the tile was uniform
+	clr_type* materialize_tile(size_t col, size_t row);
+	/// write the pixels of a tile into dst in the layout of the tile pixels, where uniform tiles are expanded
+	void expand_tile(size_t col, size_t row, clr_type* dst) const;
+	/// return color of pixel (x,y)
+	clr_type get_pixel(size_t x, size_t y) const;
+	/// return number of materialized tiles
+	size_t get_nr_materialized_tiles() const;
+	/// return number of bytes used by the pixels of materialized tiles
+	size_t get_pixel_memory() const;
+	/// pass tiles in row major order starting with the bottom tile row to the callback until it returns false, where uniform tiles are expanded into a scratch buffer if expand_uniform is set; return false if the export was stopped by the callback
+	bool export_tiles(const callback_type& callback, bool expand_uniform = false) const;
+	/// write image to a binary ppm file one tile row at a time, such that only the pixels of one tile row are expanded at once
+	bool write_ppm(const std::string& file_name) const;
+};
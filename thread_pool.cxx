@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+
+/// pop task from back of own queue or steal from the front of another queue
+bool thread_pool::pop_task(size_t queue_idx, std::pair<job_type*, size_t>& task)
+{
+	{
+		queue_type& q = *queues[queue_idx];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (!q.tasks.empty()) {
+			task = q.tasks.back();
+			q.tasks.pop_back();
+			return true;
+		}
+	}
+	for (size_t i = 1; i < queues.size(); ++i) {
+		queue_type& q = *queues[(queue_idx + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		if (!q.tasks.empty()) {
+			task = q.tasks.front();
+			q.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+/// execute tasks until all queues are empty
+void thread_pool::process_tasks(size_t queue_idx)
+{
+	std::pair<job_type*, size_t> task;
+	while (pop_task(queue_idx, task)) {
+		// the job is referenced through the queue entry such that a late worker cannot mix up jobs
+		job_type* job = task.first;
+		(*job->task)(task.second);
+		if (--job->nr_remaining == 0) {
+			std::lock_guard<std::mutex> lock(mutex);
+			done_condition.notify_all();
+		}
+	}
+}
+
+/// main function of worker threads
+void thread_pool::work(size_t queue_idx)
+{
+	size_t seen_generation = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			work_condition.wait(lock, [&] { return terminate || generation != seen_generation; });
+			if (terminate)
+				return;
+			seen_generation = generation;
+		}
+		process_tasks(queue_idx);
+	}
+}
+
+/// construct pool with given number of worker threads, where 0 corresponds to the hardware concurrency
+thread_pool::thread_pool(size_t nr_threads) : generation(0), terminate(false)
+{
+	if (nr_threads == 0) {
+		nr_threads = std::thread::hardware_concurrency();
+		if (nr_threads > 0)
+			--nr_threads;
+	}
+	for (size_t i = 0; i <= nr_threads; ++i)
+		queues.push_back(std::unique_ptr<queue_type>(new queue_type()));
+	for (size_t i = 0; i < nr_threads; ++i)
+		threads.push_back(std::thread(&thread_pool::work, this, i + 1));
+}
+
+/// join all worker threads
+thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		terminate = true;
+	}
+	work_condition.notify_all();
+	for (size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+}
+
+/// return number of threads including the calling thread
+size_t thread_pool::get_nr_threads() const
+{
+	return queues.size();
+}
+
+/// execute task for all indices in [0,nr_tasks) and return after completion
+void thread_pool::parallel_for(size_t nr_tasks, const task_type& task)
+{
+	if (nr_tasks == 0)
+		return;
+	job_type job;
+	job.task = &task;
+	job.nr_remaining = nr_tasks;
+	// distribute contiguous index ranges over the queues
+	for (size_t qi = 0; qi < queues.size(); ++qi) {
+		size_t begin = nr_tasks*qi / queues.size();
+		size_t end = nr_tasks*(qi + 1) / queues.size();
+		std::lock_guard<std::mutex> lock(queues[qi]->mutex);
+		for (size_t ti = end; ti > begin; --ti)
+			queues[qi]->tasks.push_back(std::make_pair(&job, ti - 1));
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		++generation;
+	}
+	work_condition.notify_all();
+	process_tasks(0);
+	std::unique_lock<std::mutex> lock(mutex);
+	done_condition.wait(lock, [&] { return job.nr_remaining == 0; });
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <condition_variable>
+
+/// thread pool with one task queue per thread, idle threads steal tasks from the queues of other threads
+class thread_pool
+{
+public:
+	/// type of tasks, the argument is the index of the task
+	typedef std::function<void(size_t)> task_type;
+protected:
+	/// tasks of one call to parallel_for
+	struct job_type
+	{
+		const task_type* task;
+		std::atomic<size_t> nr_remaining;
+	};
+	/// queue of task indices of one thread
+	struct queue_type
+	{
+		std::mutex mutex;
+		std::deque<std::pair<job_type*, size_t> > tasks;
+	};
+	/// worker threads
+	std::vector<std::thread> threads;
+	/// one queue per worker thread plus one for the thread calling parallel_for
+	std::vector<std::unique_ptr<queue_type> > queues;
+	/// mutex and conditions used to wake up workers and to wait for job completion
+	std::mutex mutex;
+	std::condition_variable work_condition, done_condition;
+	size_t generation;
+	bool terminate;
+	/// pop task from back of own queue or steal from the front of another queue
+	bool pop_task(size_t queue_idx, std::pair<job_type*, size_t>& task);
+	/// execute tasks until all queues are empty
+	void process_tasks(size_t queue_idx);
+	/// main function of worker threads
+	void work(size_t queue_idx);
+public:
+	/// construct pool with given number of worker threads, where 0 corresponds to the hardware concurrency
+	thread_pool(size_t nr_threads = 0);
+	/// join all worker threads
+	~thread_pool();
+	/// return number of threads including the calling thread
+	size_t get_nr_threads() const;
+	/// execute task for all indices in [0,nr_tasks) and return after completion; the calling thread participates and must not call parallel_for concurrently
+	void parallel_for(size_t nr_tasks, const task_type& task);
+};
@@ -0,0 +1,613 @@
+#include "raster_kernels.h"
+#include "polygon.h"
+#include "polygon_edge_grid.h"
+#include "polygon_point_locator.h"
+#include "polygon_raster_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <random>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <limits>
+
+typedef polygon_types::clr_type clr_type;
+
+/// call func repeatedly for at least min_seconds and return average seconds per call
+static double time_per_call(const std::function<void()>& func, double min_seconds = 0.2)
+{
+	typedef std::chrono::steady_clock clock_type;
+	size_t nr_calls = 0;
+	clock_type::time_point start = clock_type::now();
+	double elapsed = 0;
+	do {
+		func();
+		++nr_calls;
+		elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+	} while (elapsed < min_seconds);
+	return elapsed / nr_calls;
+}
+
+/// checker board clear as implemented before the row kernels
+static void clear_per_pixel(std::vector<clr_type>& img, size_t w, size_t h, const clr_type* bg_clr)
+{
+	for (size_t y = 0; y < h; ++y)
+		for (size_t x = 0; x < w; ++x)
+			img[w*y + x] = bg_clr[(x + y) & 1];
+}
+
+/// checker board clear with the currently selected row kernel
+static void clear_rows(std::vector<clr_type>& img, size_t w, size_t h, const raster_pattern* bg_pattern)
+{
+	for (size_t y = 0; y < h; ++y)
+		raster_kernels::fill_row(&img[w*y], w, bg_pattern[y & 1]);
+}
+
+/// compare clearing the checker board per pixel against the row kernels and report throughput in GB/s
+static void bench_clear()
+{
+	clr_type bg_clr[2] = { clr_type(255, 230, 230), clr_type(230, 255, 230) };
+	raster_pattern bg_pattern[2] = { raster_pattern(bg_clr[0], bg_clr[1]), raster_pattern(bg_clr[1], bg_clr[0]) };
+	RasterKernel best = raster_kernels::get_best_kernel();
+	std::cout << "clear_image throughput in GB/s (best kernel " << raster_kernels::get_kernel_name(best) << ")\n";
+	std::cout << std::setw(8) << "size" << std::setw(12) << "per_pixel";
+	for (int k = RK_SCALAR; k <= RK_AVX2; ++k)
+		std::cout << std::setw(12) << raster_kernels::get_kernel_name(RasterKernel(k));
+	std::cout << "\n";
+	for (size_t size = 256; size <= 4096; size *= 2) {
+		std::vector<clr_type> reference(size*size), img(size*size);
+		double nr_gb = 3.0*size*size*1e-9;
+		std::cout << std::setw(8) << size << std::setw(12) << std::fixed << std::setprecision(2)
+			<< nr_gb / time_per_call([&] { clear_per_pixel(reference, size, size, bg_clr); });
+		for (int k = RK_SCALAR; k <= RK_AVX2; ++k) {
+			if (!raster_kernels::select_kernel(RasterKernel(k))) {
+				std::cout << std::setw(12) << "n/a";
+				continue;
+			}
+			double gb_per_second = nr_gb / time_per_call([&] { clear_rows(img, size, size, bg_pattern); });
+			bool equal = true;
+			for (size_t i = 0; equal && i < img.size(); ++i)
+				equal = img[i] == reference[i];
+			std::cout << std::setw(12) << gb_per_second;
+			if (!equal)
+				std::cout << "(!)";
+		}
+		std::cout << std::endl;
+	}
+	raster_kernels::select_kernel(best);
+}
+
+/// loop lookup by linear scan as implemented before the binary search
+static size_t find_loop_linear(const polygon& poly, size_t vtx_idx)
+{
+	for (size_t li = 0; li < poly.nr_loops(); ++li)
+		if (vtx_idx >= poly.loop_begin(li) && vtx_idx < poly.loop_end(li))
+			return li;
+	return size_t(-1);
+}
+
+/// create polygon with given number of closed square loops
+static void generate_loops(polygon& poly, size_t nr_loops)
+{
+	for (size_t li = 0; li < nr_loops; ++li) {
+		float x = float(li % 1000), y = float(li / 1000);
+		poly.append_loop(polygon::vtx_type(x, y));
+		poly.append_vertex_to_loop(polygon::vtx_type(x + 0.5f, y));
+		poly.append_vertex_to_loop(polygon::vtx_type(x + 0.5f, y + 0.5f));
+		poly.append_vertex_to_loop(polygon::vtx_type(x, y + 0.5f));
+		poly.close_loop(li);
+	}
+}
+
+/// compare find_loop against a linear scan for random vertices and for repeated queries of the same vertex as issued while dragging
+static void bench_find_loop()
+{
+	std::cout << "find_loop cost in ns per lookup\n";
+	std::cout << std::setw(10) << "loops" << std::setw(12) << "linear" << std::setw(12) << "random" << std::setw(12) << "repeated" << "\n";
+	std::mt19937 rng(0);
+	for (size_t nr_loops = 10; nr_loops <= 1000000; nr_loops *= 10) {
+		polygon poly;
+		generate_loops(poly, nr_loops);
+		std::vector<size_t> queries(1024);
+		for (size_t qi = 0; qi < queries.size(); ++qi)
+			queries[qi] = rng() % poly.nr_vertices();
+		size_t sum = 0;
+		double ns_linear = 1e9*time_per_call([&] { for (size_t qi = 0; qi < queries.size(); ++qi) sum += find_loop_linear(poly, queries[qi]); }) / queries.size();
+		double ns_random = 1e9*time_per_call([&] { for (size_t qi = 0; qi < queries.size(); ++qi) sum += poly.find_loop(queries[qi]); }) / queries.size();
+		double ns_repeated = 1e9*time_per_call([&] { for (size_t qi = 0; qi < queries.size(); ++qi) sum += poly.find_loop(queries[0]); }) / queries.size();
+		std::cout << std::setw(10) << nr_loops << std::setw(12) << std::fixed << std::setprecision(1)
+			<< ns_linear << std::setw(12) << ns_random << std::setw(12) << ns_repeated;
+		if (sum == 0)
+			std::cout << " ";
+		std::cout << std::endl;
+	}
+}
+
+/// measure random vertex insertion and removal followed by a sequential scan for both vertex storage modes
+static void bench_edit()
+{
+	std::cout << "vertex edit cost in us per insert/remove pair and scan cost in ns per vertex\n";
+	std::cout << std::setw(10) << "vertices" << std::setw(12) << "contiguous" << std::setw(12) << "chunked"
+		<< std::setw(12) << "scan_cont" << std::setw(12) << "scan_chunk" << "\n";
+	std::mt19937 rng(0);
+	for (size_t nr_loops = 1000; nr_loops <= 1000000; nr_loops *= 10) {
+		double us_edit[2], ns_scan[2];
+		for (int mode = VSM_CONTIGUOUS; mode <= VSM_CHUNKED; ++mode) {
+			polygon poly;
+			poly.set_vertex_storage_mode(VertexStorageMode(mode));
+			generate_loops(poly, nr_loops);
+			us_edit[mode] = 1e6*time_per_call([&] {
+				size_t vi = rng() % poly.nr_vertices();
+				poly.insert_vertex(poly.vertex(vi), vi);
+				poly.remove_vertex(vi);
+			});
+			float sum = 0;
+			ns_scan[mode] = 1e9*time_per_call([&] { for (size_t vi = 0; vi < poly.nr_vertices(); ++vi) sum += poly.vertex(vi)[0]; }) / poly.nr_vertices();
+			if (sum == 0)
+				std::cout << " ";
+		}
+		std::cout << std::setw(10) << 4 * nr_loops << std::setw(12) << std::fixed << std::setprecision(2)
+			<< us_edit[0] << std::setw(12) << us_edit[1] << std::setw(12) << ns_scan[0] << std::setw(12) << ns_scan[1] << std::endl;
+	}
+}
+
+/// vertex picking by linear scan as implemented in polygon_view before the edge grid
+static size_t find_closest_vertex_linear(const polygon& poly, const polygon::vtx_type& p, float max_dist)
+{
+	size_t vtx_idx = size_t(-1);
+	float min_dist = 0;
+	for (size_t vi = 0; vi < poly.nr_vertices(); ++vi) {
+		float dist = (poly.vertex(vi) - p).length();
+		if (dist <= max_dist && (vtx_idx == size_t(-1) || dist < min_dist)) {
+			min_dist = dist;
+			vtx_idx = vi;
+		}
+	}
+	return vtx_idx;
+}
+
+/// edge picking by linear scan as implemented in polygon_view before the edge grid
+static size_t find_closest_edge_linear(const polygon& poly, const polygon::vtx_type& p, float max_dist, polygon::vtx_type& edge_point)
+{
+	size_t edge_insert_vtx_index = size_t(-1);
+	float min_dist = 0;
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		size_t vbegin = poly.loop_begin(li);
+		size_t vi_last = poly.loop_end(li) - 1;
+		if (!poly.loop_closed(li)) {
+			vi_last = vbegin;
+			++vbegin;
+		}
+		for (size_t vi = vbegin; vi < poly.loop_end(li); ++vi) {
+			const polygon::vtx_type& p0 = poly.vertex(vi_last);
+			const polygon::vtx_type& p1 = poly.vertex(vi);
+			polygon::vtx_type d = p1 - p0;
+			float lambda = dot(p - p0, d) / dot(d, d);
+			if (lambda > 0 && lambda < 1) {
+				polygon::vtx_type projected_point = p0 + lambda*d;
+				float dist = (projected_point - p).length();
+				if (dist < max_dist && (edge_insert_vtx_index == size_t(-1) || dist < min_dist)) {
+					min_dist = dist;
+					edge_insert_vtx_index = vi;
+					edge_point = projected_point;
+				}
+			}
+			vi_last = vi;
+		}
+	}
+	return edge_insert_vtx_index;
+}
+
+/// read mouse path with one world location per line or synthesize a random walk along the unit circle
+static std::vector<polygon::vtx_type> load_mouse_path(const char* file_name)
+{
+	std::vector<polygon::vtx_type> path;
+	if (file_name) {
+		std::ifstream is(file_name);
+		float x, y;
+		while (is >> x >> y)
+			path.push_back(polygon::vtx_type(x, y));
+		if (!path.empty())
+			return path;
+		std::cerr << "could not read mouse path from " << file_name << ", using synthetic path" << std::endl;
+	}
+	std::mt19937 rng(1);
+	std::normal_distribution<float> step(0, 0.002f);
+	float angle = 0, radius = 1;
+	for (size_t i = 0; i < 2000; ++i) {
+		angle += 0.003f + step(rng);
+		radius = std::min(std::max(radius + step(rng), 0.9f), 1.1f);
+		path.push_back(polygon::vtx_type(radius*std::cos(angle), radius*std::sin(angle)));
+	}
+	return path;
+}
+
+/// replay hover picking along the mouse path with linear scans and with the edge grid, where every tenth event drags the picked vertex
+static void bench_picking(const char* path_file_name)
+{
+	std::vector<polygon::vtx_type> path = load_mouse_path(path_file_name);
+	const float max_dist = 0.01f;
+	std::cout << "picking cost in us per mouse event over " << path.size() << " events\n";
+	std::cout << std::setw(10) << "vertices" << std::setw(12) << "linear" << std::setw(12) << "grid" << std::setw(12) << "mismatches" << "\n";
+	for (size_t nr_vertices = 1000; nr_vertices <= 1000000; nr_vertices *= 10) {
+		typedef std::chrono::steady_clock clock_type;
+		double seconds[2];
+		size_t picks[2][2] = { { 0, 0 }, { 0, 0 } };
+		size_t nr_mismatches = 0;
+		std::vector<size_t> linear_picks;
+		for (int use_grid = 0; use_grid < 2; ++use_grid) {
+			polygon poly;
+			poly.generate_circle(nr_vertices);
+			polygon_edge_grid grid(poly);
+			clock_type::time_point start = clock_type::now();
+			for (size_t i = 0; i < path.size(); ++i) {
+				polygon::vtx_type edge_point;
+				size_t vi = use_grid ? grid.find_closest_vertex(path[i], max_dist) : find_closest_vertex_linear(poly, path[i], max_dist);
+				size_t ei = size_t(-1);
+				if (vi == size_t(-1))
+					ei = use_grid ? grid.find_closest_edge(path[i], max_dist, edge_point) : find_closest_edge_linear(poly, path[i], max_dist, edge_point);
+				else if (i % 10 == 0)
+					poly.set_vertex(vi, 0.5f*(poly.vertex(vi) + path[i]));
+				++picks[use_grid][vi == size_t(-1) ? 1 : 0];
+				if (!use_grid) {
+					linear_picks.push_back(vi);
+					linear_picks.push_back(ei);
+				}
+				else
+					nr_mismatches += (linear_picks[2 * i] != vi) + (linear_picks[2 * i + 1] != ei);
+			}
+			seconds[use_grid] = std::chrono::duration<double>(clock_type::now() - start).count();
+		}
+		std::cout << std::setw(10) << nr_vertices << std::setw(12) << std::fixed << std::setprecision(2)
+			<< 1e6*seconds[0] / path.size() << std::setw(12) << 1e6*seconds[1] / path.size() << std::setw(12) << nr_mismatches << std::endl;
+	}
+}
+
+/// text reader as implemented before the block parser, which appends vertex by vertex
+static bool read_legacy(polygon& poly, const std::string& file_name)
+{
+	std::ifstream is(file_name.c_str());
+	if (is.fail())
+		return false;
+	char buffer[1025];
+	buffer[1024] = 0;
+	float x, y;
+	is.getline(buffer, 1024);
+	std::string str(buffer);
+	std::stringstream ss(str);
+	size_t nr_loops;
+	ss >> nr_loops;
+	if (ss.fail())
+		return false;
+	for (size_t li = 0; li < nr_loops; ++li) {
+		is.getline(buffer, 1024);
+		std::stringstream ss_loop((std::string(buffer)));
+		size_t nr_vertices;
+		int closed, r, g, b;
+		ss_loop >> nr_vertices >> closed >> r >> g >> b;
+		if (ss_loop.fail() || nr_vertices == 0)
+			return false;
+		for (size_t vi = 0; vi < nr_vertices; ++vi) {
+			is.getline(buffer, 1024);
+			std::stringstream ss_vtx((std::string(buffer)));
+			ss_vtx >> x >> y;
+			if (ss_vtx.fail())
+				return false;
+			if (vi == 0) {
+				poly.append_loop(polygon::vtx_type(x, y));
+				poly.set_loop_color(li, polygon::clr_type(r, g, b));
+			}
+			else
+				poly.append_vertex_to_loop(polygon::vtx_type(x, y));
+		}
+		if (closed != 0)
+			poly.close_loop(li);
+	}
+	return true;
+}
+
+/// write a multi loop text file with loops of 1000 vertices and return its size in bytes
+static size_t write_text_polygon(const std::string& file_name, size_t nr_vertices)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> noise(-0.01f, 0.01f);
+	std::ofstream os(file_name.c_str());
+	const size_t loop_size = 1000;
+	size_t nr_loops = (nr_vertices + loop_size - 1) / loop_size;
+	os << nr_loops << "\n";
+	for (size_t li = 0; li < nr_loops; ++li) {
+		os << loop_size << " 1 " << li % 256 << " 0 0\n";
+		for (size_t vi = 0; vi < loop_size; ++vi) {
+			float angle = float(2 * M_PI*vi / loop_size);
+			os << li % 100 + std::cos(angle) + noise(rng) << " " << li / 100 + std::sin(angle) + noise(rng) << "\n";
+		}
+	}
+	return size_t(os.tellp());
+}
+
+/// return size of given file in bytes
+static size_t file_size(const std::string& file_name)
+{
+	std::ifstream is(file_name.c_str(), std::ios::binary | std::ios::ate);
+	return size_t(is.tellg());
+}
+
+/// compare the legacy reader with polygon::read on generated text files
+static void bench_read()
+{
+	typedef std::chrono::steady_clock clock_type;
+	std::string file_name = "polygon_bench_read.txt";
+	std::cout << "text read throughput in MB/s\n";
+	std::cout << std::setw(10) << "vertices" << std::setw(12) << "legacy" << std::setw(12) << "read" << "\n";
+	for (size_t nr_vertices = 100000; nr_vertices <= 5000000; nr_vertices *= nr_vertices < 1000000 ? 10 : 5) {
+		double nr_mb = 1e-6*write_text_polygon(file_name, nr_vertices);
+		std::cout << std::setw(10) << nr_vertices << std::setw(12) << std::fixed << std::setprecision(1);
+		// the legacy reader takes minutes for millions of vertices
+		if (nr_vertices <= 1000000) {
+			polygon poly;
+			clock_type::time_point start = clock_type::now();
+			read_legacy(poly, file_name);
+			std::cout << nr_mb / std::chrono::duration<double>(clock_type::now() - start).count();
+		}
+		else
+			std::cout << "n/a";
+		polygon poly;
+		clock_type::time_point start = clock_type::now();
+		bool success = poly.read(file_name);
+		std::cout << std::setw(12) << nr_mb / std::chrono::duration<double>(clock_type::now() - start).count();
+		if (!success)
+			std::cout << " " << poly.get_last_error();
+		std::cout << std::endl;
+	}
+	std::remove(file_name.c_str());
+}
+
+/// text writer as implemented before the buffered writer, which formats through operator<< and flushes every line
+static bool write_legacy(const polygon& poly, const std::string& file_name)
+{
+	std::ofstream os(file_name);
+	if (os.fail())
+		return false;
+	os.precision(std::numeric_limits<float>::max_digits10);
+	os << poly.nr_loops() << std::endl;
+	for (size_t li = 0; li < poly.nr_loops(); ++li) {
+		os << poly.loop_size(li) << " " << (poly.loop_closed(li) ? 1 : 0) << " " << int(poly.loop_color(li).R()) << " " << int(poly.loop_color(li).G()) << " " << int(poly.loop_color(li).B()) << std::endl;
+		for (size_t vi = poly.loop_begin(li); vi < poly.loop_end(li); ++vi)
+			os << poly.vertex(vi) << std::endl;
+	}
+	return true;
+}
+
+/// compare the legacy writer with polygon::write and check that the written files are read back exactly
+static void bench_write()
+{
+	typedef std::chrono::steady_clock clock_type;
+	std::string file_name = "polygon_bench_write.txt";
+	std::cout << "text write throughput in MB/s\n";
+	std::cout << std::setw(10) << "vertices" << std::setw(12) << "legacy" << std::setw(12) << "write" << std::setw(12) << "exact" << "\n";
+	for (size_t nr_vertices = 100000; nr_vertices <= 5000000; nr_vertices *= nr_vertices < 1000000 ? 10 : 5) {
+		polygon poly;
+		write_text_polygon(file_name, nr_vertices);
+		poly.read(file_name);
+		std::cout << std::setw(10) << nr_vertices << std::setw(12) << std::fixed << std::setprecision(1);
+		clock_type::time_point start = clock_type::now();
+		write_legacy(poly, file_name);
+		double legacy_seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+		std::cout << 1e-6*double(file_size(file_name)) / legacy_seconds;
+		start = clock_type::now();
+		poly.write(file_name);
+		double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+		std::cout << std::setw(12) << 1e-6*double(file_size(file_name)) / seconds;
+		polygon read_back;
+		bool exact = read_back.read(file_name) && read_back.nr_vertices() == poly.nr_vertices();
+		for (size_t vi = 0; exact && vi < poly.nr_vertices(); ++vi)
+			exact = read_back.vertex(vi)[0] == poly.vertex(vi)[0] && read_back.vertex(vi)[1] == poly.vertex(vi)[1];
+		std::cout << std::setw(12) << (exact ? "yes" : "no") << std::endl;
+	}
+	std::remove(file_name.c_str());
+}
+
+/// timing samples of one operation on a polygon of given size in nanoseconds per call
+struct timing_series
+{
+	std::string operation;
+	size_t nr_vertices;
+	size_t nr_pixels;
+	std::vector<double> samples;
+};
+
+/// call func in batches of batch_size calls and append the average nanoseconds per call of each batch until the time budget is used up, collecting at least min_samples and at most max_samples samples
+static void sample_calls(std::vector<double>& samples, const std::function<void()>& func, size_t batch_size = 1, double budget = 0.5, size_t min_samples = 3, size_t max_samples = 1000)
+{
+	typedef std::chrono::steady_clock clock_type;
+	clock_type::time_point start = clock_type::now();
+	while (samples.size() < max_samples) {
+		clock_type::time_point batch_start = clock_type::now();
+		for (size_t i = 0; i < batch_size; ++i)
+			func();
+		clock_type::time_point batch_end = clock_type::now();
+		samples.push_back(1e9*std::chrono::duration<double>(batch_end - batch_start).count() / batch_size);
+		if (samples.size() >= min_samples && std::chrono::duration<double>(batch_end - start).count() > budget)
+			break;
+	}
+}
+
+/// return nearest rank percentile of sorted samples for p in [0,100]
+static double percentile(const std::vector<double>& sorted_samples, double p)
+{
+	size_t rank = size_t(std::ceil(p / 100 * sorted_samples.size()));
+	return sorted_samples[rank == 0 ? 0 : rank - 1];
+}
+
+/// write timing series as json array of objects with sample count and percentiles in nanoseconds
+static void write_json(std::ostream& os, std::vector<timing_series>& series)
+{
+	os << "{\n  \"unit\": \"ns\",\n  \"results\": [";
+	for (size_t si = 0; si < series.size(); ++si) {
+		std::vector<double>& samples = series[si].samples;
+		std::sort(samples.begin(), samples.end());
+		double mean = 0;
+		for (size_t i = 0; i < samples.size(); ++i)
+			mean += samples[i];
+		mean /= samples.size();
+		os << (si == 0 ? "\n" : ",\n") << "    { \"operation\": \"" << series[si].operation << "\", \"vertices\": " << series[si].nr_vertices
+			<< ", \"pixels\": " << series[si].nr_pixels << ", \"samples\": " << samples.size() << std::fixed << std::setprecision(1)
+			<< ", \"min\": " << samples.front() << ", \"p50\": " << percentile(samples, 50) << ", \"p90\": " << percentile(samples, 90)
+			<< ", \"p99\": " << percentile(samples, 99) << ", \"max\": " << samples.back() << ", \"mean\": " << mean << " }";
+	}
+	os << "\n  ]\n}" << std::endl;
+}
+
+/// create closed noisy circles of up to 1000 vertices each with nr_vertices vertices in total, arranged on a grid inside of [-1.8,1.8]^2
+static void generate_synthetic(polygon& poly, size_t nr_vertices)
+{
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+	const size_t max_loop_size = 1000;
+	size_t nr_loops = (nr_vertices + max_loop_size - 1) / max_loop_size;
+	size_t nr_cols = size_t(std::ceil(std::sqrt(double(nr_loops))));
+	float cell_size = 3.6f / nr_cols;
+	size_t vtx_idx = 0;
+	for (size_t li = 0; li < nr_loops; ++li) {
+		size_t loop_size = std::min(max_loop_size, nr_vertices - vtx_idx);
+		polygon::vtx_type center(-1.8f + cell_size*(li % nr_cols + 0.5f), -1.8f + cell_size*(li / nr_cols + 0.5f));
+		for (size_t vi = 0; vi < loop_size; ++vi) {
+			float angle = float(2 * M_PI*vi / loop_size);
+			float radius = 0.5f*cell_size*(0.9f + noise(rng));
+			polygon::vtx_type p = center + polygon::vtx_type(radius*std::cos(angle), radius*std::sin(angle));
+			if (vi == 0)
+				poly.append_loop(p);
+			else
+				poly.append_vertex_to_loop(p, li);
+		}
+		poly.close_loop(li);
+		vtx_idx += loop_size;
+	}
+}
+
+/// time the hot paths of polygon and rasterizer on synthetic polygons with 10 to max_vertices vertices and write the percentiles as json to os
+static void bench_json(std::ostream& os, size_t max_vertices)
+{
+	std::vector<timing_series> series;
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> location(-1.9f, 1.9f);
+	const size_t img_size = 1024;
+	auto add_series = [&](const std::string& operation, size_t nr_vertices, size_t nr_pixels) -> std::vector<double>& {
+		series.push_back(timing_series());
+		series.back().operation = operation;
+		series.back().nr_vertices = nr_vertices;
+		series.back().nr_pixels = nr_pixels;
+		std::cerr << operation << " " << nr_vertices << std::endl;
+		return series.back().samples;
+	};
+	{
+		polygon poly;
+		polygon_raster_engine engine(poly);
+		engine.set_image_size(img_size, img_size);
+		sample_calls(add_series("clear_image", 0, img_size*img_size), [&] { engine.clear_image(); });
+	}
+	std::string text_file_name = "polygon_bench_json.txt", binary_file_name = "polygon_bench_json.pbin";
+	for (size_t nr_vertices = 10; nr_vertices <= max_vertices; nr_vertices *= 10) {
+		polygon poly;
+		generate_synthetic(poly, nr_vertices);
+		size_t n = poly.nr_vertices();
+
+		// file io
+		sample_calls(add_series("write", n, 0), [&] { poly.write(text_file_name); });
+		sample_calls(add_series("read", n, 0), [&] { polygon p; p.read(text_file_name); });
+		sample_calls(add_series("write_binary", n, 0), [&] { poly.write_binary(binary_file_name); });
+		sample_calls(add_series("read_binary", n, 0), [&] { polygon p; p.read_binary(binary_file_name); });
+
+		// vertex queries and edits
+		size_t sum = 0;
+		sample_calls(add_series("find_loop", n, 0), [&] { sum += poly.find_loop(rng() % n); }, 256);
+		sample_calls(add_series("set_vertex", n, 0), [&] {
+			size_t vi = rng() % n;
+			poly.set_vertex(vi, poly.vertex(vi) + polygon::vtx_type(1e-4f, 0));
+		}, 256);
+		for (int mode = VSM_CONTIGUOUS; mode <= VSM_CHUNKED; ++mode) {
+			poly.set_vertex_storage_mode(VertexStorageMode(mode));
+			sample_calls(add_series(mode == VSM_CONTIGUOUS ? "insert_remove_contiguous" : "insert_remove_chunked", n, 0), [&] {
+				size_t vi = rng() % n;
+				poly.insert_vertex(poly.vertex(vi), vi);
+				poly.remove_vertex(vi);
+			});
+		}
+		poly.set_vertex_storage_mode(VSM_CONTIGUOUS);
+
+		// picking at random locations, where the grid is built before timing
+		{
+			polygon_edge_grid grid(poly);
+			const float max_dist = 0.01f;
+			polygon::vtx_type edge_point;
+			sum += grid.find_closest_vertex(polygon::vtx_type(0, 0), max_dist);
+			sample_calls(add_series("pick_vertex", n, 0), [&] { sum += grid.find_closest_vertex(polygon::vtx_type(location(rng), location(rng)), max_dist); }, 64);
+			sample_calls(add_series("pick_edge", n, 0), [&] { sum += grid.find_closest_edge(polygon::vtx_type(location(rng), location(rng)), max_dist, edge_point); }, 64);
+		}
+
+		// batched point classification at random locations, where the index is built before timing
+		{
+			polygon_point_locator locator(poly);
+			const size_t nr_points = 65536;
+			std::vector<polygon::vtx_type> points(nr_points);
+			for (size_t i = 0; i < nr_points; ++i)
+				points[i] = polygon::vtx_type(location(rng), location(rng));
+			std::vector<cgv::type::uint8_type> inside(nr_points);
+			locator.classify_points(&points[0], 1, &inside[0]);
+			sample_calls(add_series("classify_points", n, nr_points), [&] { locator.classify_points(&points[0], nr_points, &inside[0]); });
+			sample_calls(add_series("classify_points_parallel", n, nr_points), [&] { locator.classify_points_parallel(&points[0], nr_points, &inside[0]); });
+		}
+
+		// full rasterization
+		{
+			polygon_raster_engine engine(poly);
+			engine.set_image_size(img_size, img_size);
+			sample_calls(add_series("rasterize_aliased", n, img_size*img_size), [&] { engine.rasterize_polygon(); });
+			engine.set_use_tiled_rasterization(true);
+			sample_calls(add_series("rasterize_tiled", n, img_size*img_size), [&] { engine.rasterize_polygon(); });
+			engine.set_use_tiled_rasterization(false);
+			engine.set_raster_mode(RM_ANALYTIC);
+			sample_calls(add_series("rasterize_analytic", n, img_size*img_size), [&] { engine.rasterize_polygon(); });
+			engine.set_raster_mode(RM_SUPERSAMPLED);
+			engine.set_sample_pattern(SP_ROTATED_GRID);
+			sample_calls(add_series("rasterize_supersampled_rgss_box", n, img_size*img_size), [&] { engine.rasterize_polygon(); });
+			engine.set_sample_pattern(SP_GRID_4X4);
+			engine.set_resolve_filter(RF_TENT);
+			sample_calls(add_series("rasterize_supersampled_4x4_tent", n, img_size*img_size), [&] { engine.rasterize_polygon(); });
+			engine.set_raster_mode(RM_DISTANCE);
+			sample_calls(add_series("rasterize_distance", n, img_size*img_size), [&] { engine.rasterize_polygon(); });
+			// sparse target far beyond the dense image size, where only tiles near edges materialize pixels
+			engine.set_raster_mode(RM_ALIASED);
+			const size_t sparse_size = 16384;
+			sparse_tile_image sparse_img(sparse_size, sparse_size);
+			sample_calls(add_series("rasterize_sparse_tiles", n, sparse_size*sparse_size), [&] { engine.rasterize_tiles(sparse_img); sum += sparse_img.get_nr_materialized_tiles(); });
+		}
+		if (sum == 0)
+			std::cerr << " ";
+	}
+	std::remove(text_file_name.c_str());
+	std::remove(binary_file_name.c_str());
+	write_json(os, series);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc >= 2 && std::strcmp(argv[1], "--json") == 0) {
+		size_t max_vertices = argc >= 3 ? size_t(std::stoull(argv[2])) : 10000000;
+		bench_json(std::cout, max_vertices);
+		return 0;
+	}
+	bench_clear();
+	bench_find_loop();
+	bench_edit();
+	bench_picking(argc > 1 ? argv[1] : 0);
+	bench_read();
+	bench_write();
+	return 0;
+}
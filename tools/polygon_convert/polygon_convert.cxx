@@ -0,0 +1,182 @@
+#include "polygon.h"
+#include "polygon_stream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+/// return whether file name has the extension of binary polygon files
+static bool is_binary_file_name(const std::string& file_name)
+{
+	return file_name.size() >= 5 && file_name.compare(file_name.size() - 5, 5, ".pbin") == 0;
+}
+
+/// read polygon in format given by file extension and report errors
+static bool read_polygon(polygon& poly, const std::string& file_name)
+{
+	bool success = is_binary_file_name(file_name) ? poly.read_binary(file_name) : poly.read(file_name);
+	if (!success)
+		std::cerr << "could not read " << file_name << ": " << poly.get_last_error() << std::endl;
+	return success;
+}
+
+/// write polygon in format given by file extension and report errors
+static bool write_polygon(const polygon& poly, const std::string& file_name)
+{
+	bool success = is_binary_file_name(file_name) ? poly.write_binary(file_name) : poly.write(file_name);
+	if (!success)
+		std::cerr << "could not write " << file_name << std::endl;
+	return success;
+}
+
+/// compare loops and vertices of two polygons and report first difference
+static bool equal_polygons(const polygon& p0, const polygon& p1, const std::string& what)
+{
+	if (p0.nr_loops() != p1.nr_loops() || p0.nr_vertices() != p1.nr_vertices()) {
+		std::cerr << what << ": number of loops or vertices differs" << std::endl;
+		return false;
+	}
+	for (size_t li = 0; li < p0.nr_loops(); ++li)
+		if (p0.loop_begin(li) != p1.loop_begin(li) || p0.loop_size(li) != p1.loop_size(li) ||
+			p0.loop_closed(li) != p1.loop_closed(li) || p0.loop_orientation(li) != p1.loop_orientation(li) ||
+			!(p0.loop_color(li) == p1.loop_color(li))) {
+			std::cerr << what << ": loop " << li << " differs" << std::endl;
+			return false;
+		}
+	for (size_t vi = 0; vi < p0.nr_vertices(); ++vi)
+		if (p0.vertex(vi)[0] != p1.vertex(vi)[0] || p0.vertex(vi)[1] != p1.vertex(vi)[1]) {
+			std::cerr << what << ": vertex " << vi << " differs" << std::endl;
+			return false;
+		}
+	return true;
+}
+
+/// write a binary file whose vertex offset makes the end of the vertex block wrap around and check that reading rejects it
+static bool check_invalid_vertex_offset(const std::string& file_name)
+{
+	binary_polygon_header header;
+	init_binary_polygon_header(header);
+	header.nr_loops = 1;
+	header.nr_vertices = 1;
+	header.vertex_offset = uint64_t(0) - 8;
+	binary_polygon_loop bl;
+	std::memset(&bl, 0, sizeof(bl));
+	bl.nr_vertices = 1;
+	static const char zeros[24] = { 0 };
+	std::ofstream os(file_name, std::ios::binary);
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	os.write(reinterpret_cast<const char*>(&bl), sizeof(bl));
+	os.write(zeros, sizeof(zeros));
+	os.close();
+	if (os.fail()) {
+		std::cerr << "could not write " << file_name << std::endl;
+		return false;
+	}
+	polygon poly;
+	bool rejected = !poly.read_binary(file_name);
+	std::remove(file_name.c_str());
+	if (!rejected)
+		std::cerr << "invalid vertex offset: file was accepted" << std::endl;
+	return rejected;
+}
+
+/// read polygon, pass it through the binary and the text format and check that both reproduce it exactly, and check that a corrupt header is rejected
+static int check_round_trip(const std::string& file_name)
+{
+	typedef std::chrono::steady_clock clock_type;
+	polygon poly;
+	if (!read_polygon(poly, file_name))
+		return 1;
+	std::string binary_file_name = file_name + ".check.pbin";
+	std::string text_file_name = file_name + ".check.txt";
+	bool success = true;
+
+	// text or binary input to binary
+	polygon from_binary;
+	clock_type::time_point start = clock_type::now();
+	success = write_polygon(poly, binary_file_name) && read_polygon(from_binary, binary_file_name) &&
+		equal_polygons(poly, from_binary, "to binary") && success;
+	double binary_seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+	// binary to text
+	polygon from_text;
+	start = clock_type::now();
+	success = write_polygon(from_binary, text_file_name) && read_polygon(from_text, text_file_name) &&
+		equal_polygons(from_binary, from_text, "binary to text") && success;
+	double text_seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+	std::remove(binary_file_name.c_str());
+	std::remove(text_file_name.c_str());
+
+	// header whose vertex block wraps around the end of the address range
+	success = check_invalid_vertex_offset(file_name + ".check.invalid.pbin") && success;
+	std::cout << (success ? "passed" : "failed") << " round trip of " << poly.nr_loops() << " loops and " << poly.nr_vertices()
+		<< " vertices (binary " << binary_seconds << " s, text " << text_seconds << " s)" << std::endl;
+	return success ? 0 : 1;
+}
+
+/// stream polygon in chunks and report statistics without loading it
+static int print_statistics(const std::string& file_name)
+{
+	typedef std::chrono::steady_clock clock_type;
+	polygon_stream stream(polygon_stream::block_size / sizeof(polygon::vtx_type));
+	size_t nr_loops = 0, nr_closed_loops = 0, nr_vertices = 0;
+	polygon::box_type box;
+	// signed area of the closed loops accumulated in double precision from the first and the previous vertex of each loop
+	double area = 0, loop_area = 0;
+	polygon::vtx_type first_vtx, last_vtx;
+	clock_type::time_point start = clock_type::now();
+	bool success = stream.read(file_name, [&](const polygon_chunk& chunk) {
+		if (chunk.begins_loop) {
+			++nr_loops;
+			loop_area = 0;
+			first_vtx = last_vtx = chunk.vertices[0];
+		}
+		for (size_t vi = 0; vi < chunk.nr_vertices; ++vi) {
+			const polygon::vtx_type& p = chunk.vertices[vi];
+			box.add_point(p);
+			loop_area += 0.5*(double(last_vtx[0])*p[1] - double(last_vtx[1])*p[0]);
+			last_vtx = p;
+		}
+		nr_vertices += chunk.nr_vertices;
+		if (chunk.ends_loop) {
+			loop_area += 0.5*(double(last_vtx[0])*first_vtx[1] - double(last_vtx[1])*first_vtx[0]);
+			if (chunk.is_closed) {
+				++nr_closed_loops;
+				area += loop_area;
+			}
+		}
+		return true;
+	});
+	double seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+	if (!success) {
+		std::cerr << "could not read " << file_name << ": " << stream.get_last_error() << std::endl;
+		return 1;
+	}
+	std::cout << nr_loops << " loops (" << nr_closed_loops << " closed), " << nr_vertices << " vertices\n"
+		<< "box " << box.get_min_pnt() << " - " << box.get_max_pnt() << "\n"
+		<< "signed area " << area << "\n"
+		<< "streamed in " << seconds << " s" << std::endl;
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc == 3 && std::strcmp(argv[1], "--check") == 0)
+		return check_round_trip(argv[2]);
+	if (argc == 3 && std::strcmp(argv[1], "--stats") == 0)
+		return print_statistics(argv[2]);
+	if (argc != 3) {
+		std::cerr << "usage: polygon_convert <input> <output>\n"
+			"       polygon_convert --check <input>\n"
+			"       polygon_convert --stats <input>\n"
+			"files with extension .pbin use the binary format, all others the text format" << std::endl;
+		return 1;
+	}
+	polygon poly;
+	if (!read_polygon(poly, argv[1]) || !write_polygon(poly, argv[2]))
+		return 1;
+	return 0;
+}
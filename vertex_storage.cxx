@@ -0,0 +1,315 @@
+#include "vertex_storage.h"
+#include <algorithm>
+#include <cassert>
+
+static_assert(sizeof(vertex_storage::vtx_type) == 2 * sizeof(float), "mapped vertices need to be stored as pairs of floats");
+
+/// construct empty storage in given mode
+vertex_storage::vertex_storage(VertexStorageMode _mode) : mode(_mode == VSM_MAPPED ? VSM_CONTIGUOUS : _mode), nr_chunked_vertices(0),
+	mapped_vertices(0), nr_mapped_vertices(0), cached_chunk(0), cached_begin(0), cached_end(0)
+{
+}
+
+/// copy mapped vertices to contiguous storage before a modification
+void vertex_storage::detach()
+{
+	if (mode != VSM_MAPPED)
+		return;
+	vertices.assign(mapped_vertices, mapped_vertices + nr_mapped_vertices);
+	mapping.reset();
+	mapped_vertices = 0;
+	nr_mapped_vertices = 0;
+	mode = VSM_CONTIGUOUS;
+}
+
+/// return the chunk containing the given vertex index and its first vertex index
+size_t vertex_storage::locate(size_t vtx_idx, size_t& chunk_begin) const
+{
+	if (vtx_idx < cached_begin || vtx_idx >= cached_end) {
+		cached_chunk = chunk_offsets.find(vtx_idx);
+		assert(cached_chunk < chunks.size());
+		cached_begin = chunk_offsets.prefix_sum(cached_chunk);
+		cached_end = cached_begin + chunks[cached_chunk].size();
+	}
+	chunk_begin = cached_begin;
+	return cached_chunk;
+}
+
+/// rebuild chunk offsets after chunks have been inserted or removed
+void vertex_storage::update_chunk_offsets()
+{
+	std::vector<size_t> sizes(chunks.size());
+	for (size_t ci = 0; ci < chunks.size(); ++ci)
+		sizes[ci] = chunks[ci].size();
+	chunk_offsets.build(sizes);
+	cached_begin = cached_end = 0;
+}
+
+/// distribute the given vertices to half filled chunks
+void vertex_storage::build_chunks(const std::vector<vtx_type>& vts)
+{
+	// leave room in each chunk such that insertions do not split chunks right away
+	const size_t fill = chunk_size / 2;
+	chunks.clear();
+	for (size_t vi = 0; vi < vts.size(); vi += fill)
+		chunks.push_back(std::vector<vtx_type>(vts.begin() + vi, vts.begin() + std::min(vi + fill, vts.size())));
+	nr_chunked_vertices = vts.size();
+	update_chunk_offsets();
+}
+
+/// return storage mode
+VertexStorageMode vertex_storage::get_mode() const
+{
+	return mode;
+}
+
+/// convert storage to given mode in O(n)
+void vertex_storage::set_mode(VertexStorageMode _mode)
+{
+	if (mode == _mode || _mode == VSM_MAPPED)
+		return;
+	detach();
+	if (mode == _mode)
+		return;
+	if (_mode == VSM_CHUNKED) {
+		build_chunks(vertices);
+		std::vector<vtx_type>().swap(vertices);
+	}
+	else {
+		vertices.resize(nr_chunked_vertices);
+		copy(0, nr_chunked_vertices, vertices.data());
+		chunks.clear();
+		nr_chunked_vertices = 0;
+		update_chunk_offsets();
+	}
+	mode = _mode;
+}
+
+/// use n vertices stored as pairs of floats at given byte offset within the mapped file
+void vertex_storage::map(const std::shared_ptr<mapped_file>& file, size_t offset, size_t n)
+{
+	assert(offset % sizeof(float) == 0 && offset + n*sizeof(vtx_type) <= file->size());
+	clear();
+	mapping = file;
+	mapped_vertices = reinterpret_cast<const vtx_type*>(file->data() + offset);
+	nr_mapped_vertices = n;
+	mode = VSM_MAPPED;
+}
+
+/// return number of vertices
+size_t vertex_storage::size() const
+{
+	switch (mode) {
+	case VSM_CHUNKED: return nr_chunked_vertices;
+	case VSM_MAPPED: return nr_mapped_vertices;
+	default: return vertices.size();
+	}
+}
+
+/// read access to a vertex
+const vertex_storage::vtx_type& vertex_storage::operator [] (size_t vtx_idx) const
+{
+	if (mode == VSM_CONTIGUOUS)
+		return vertices[vtx_idx];
+	if (mode == VSM_MAPPED)
+		return mapped_vertices[vtx_idx];
+	size_t chunk_begin;
+	size_t ci = locate(vtx_idx, chunk_begin);
+	return chunks[ci][vtx_idx - chunk_begin];
+}
+
+/// write access to a vertex
+vertex_storage::vtx_type& vertex_storage::operator [] (size_t vtx_idx)
+{
+	detach();
+	if (mode == VSM_CONTIGUOUS)
+		return vertices[vtx_idx];
+	size_t chunk_begin;
+	size_t ci = locate(vtx_idx, chunk_begin);
+	return chunks[ci][vtx_idx - chunk_begin];
+}
+
+/// set vertex location, where vtx may reference a stored vertex
+void vertex_storage::set(size_t vtx_idx, const vtx_type& vtx)
+{
+	// copy location before detaching releases the mapped vertices
+	vtx_type new_vtx = vtx;
+	(*this)[vtx_idx] = new_vtx;
+}
+
+/// return pointer to vertices in contiguous and mapped mode and 0 in chunked mode
+const vertex_storage::vtx_type* vertex_storage::data() const
+{
+	if (mode == VSM_CONTIGUOUS && !vertices.empty())
+		return &vertices[0];
+	if (mode == VSM_MAPPED && nr_mapped_vertices > 0)
+		return mapped_vertices;
+	return 0;
+}
+
+/// copy vertex range [begin,end) to dst
+void vertex_storage::copy(size_t begin, size_t end, vtx_type* dst) const
+{
+	if (begin >= end)
+		return;
+	if (mode == VSM_CONTIGUOUS) {
+		std::copy(vertices.begin() + begin, vertices.begin() + end, dst);
+		return;
+	}
+	if (mode == VSM_MAPPED) {
+		std::copy(mapped_vertices + begin, mapped_vertices + end, dst);
+		return;
+	}
+	size_t chunk_begin;
+	size_t ci = locate(begin, chunk_begin);
+	size_t offset = begin - chunk_begin;
+	while (begin < end) {
+		const std::vector<vtx_type>& chunk = chunks[ci++];
+		size_t n = std::min(end - begin, chunk.size() - offset);
+		dst = std::copy(chunk.begin() + offset, chunk.begin() + offset + n, dst);
+		begin += n;
+		offset = 0;
+	}
+}
+
+/// append a vertex
+void vertex_storage::push_back(const vtx_type& vtx)
+{
+	if (mode == VSM_MAPPED) {
+		vtx_type new_vtx = vtx;
+		detach();
+		vertices.push_back(new_vtx);
+		return;
+	}
+	if (mode == VSM_CONTIGUOUS) {
+		vertices.push_back(vtx);
+		return;
+	}
+	// appending does not move any chunk begin such that the cached chunk stays valid
+	if (chunks.empty() || chunks.back().size() == chunk_size) {
+		chunks.push_back(std::vector<vtx_type>());
+		chunks.back().reserve(chunk_size);
+		chunks.back().push_back(vtx);
+		chunk_offsets.push_back(1);
+	}
+	else {
+		chunks.back().push_back(vtx);
+		chunk_offsets.add(chunks.size() - 1, 1);
+	}
+	++nr_chunked_vertices;
+}
+
+/// insert a vertex before the given vertex index
+void vertex_storage::insert(size_t vtx_idx, const vtx_type& vtx)
+{
+	assert(vtx_idx <= size());
+	if (mode == VSM_MAPPED) {
+		vtx_type new_vtx = vtx;
+		detach();
+		vertices.insert(vertices.begin() + vtx_idx, new_vtx);
+		return;
+	}
+	if (vtx_idx == size()) {
+		push_back(vtx);
+		return;
+	}
+	if (mode == VSM_CONTIGUOUS) {
+		vertices.insert(vertices.begin() + vtx_idx, vtx);
+		return;
+	}
+	size_t chunk_begin;
+	size_t ci = locate(vtx_idx, chunk_begin);
+	size_t offset = vtx_idx - chunk_begin;
+	++nr_chunked_vertices;
+	cached_begin = cached_end = 0;
+	if (chunks[ci].size() < chunk_size) {
+		chunks[ci].insert(chunks[ci].begin() + offset, vtx);
+		chunk_offsets.add(ci, 1);
+		return;
+	}
+	// split full chunk into two halves, which requires to rebuild the chunk offsets in O(n/chunk_size)
+	const size_t half = chunk_size / 2;
+	chunks.insert(chunks.begin() + ci + 1, std::vector<vtx_type>(chunks[ci].begin() + half, chunks[ci].end()));
+	chunks[ci].resize(half);
+	if (offset > half) {
+		offset -= half;
+		++ci;
+	}
+	chunks[ci].insert(chunks[ci].begin() + offset, vtx);
+	update_chunk_offsets();
+}
+
+/// remove the vertex range [begin,end)
+void vertex_storage::erase(size_t begin, size_t end)
+{
+	assert(begin <= end && end <= size());
+	if (begin == end)
+		return;
+	detach();
+	if (mode == VSM_CONTIGUOUS) {
+		vertices.erase(vertices.begin() + begin, vertices.begin() + end);
+		return;
+	}
+	size_t chunk_begin;
+	size_t first_ci = locate(begin, chunk_begin);
+	size_t ci = first_ci;
+	size_t offset = begin - chunk_begin;
+	size_t n = end - begin;
+	nr_chunked_vertices -= n;
+	cached_begin = cached_end = 0;
+	while (n > 0) {
+		std::vector<vtx_type>& chunk = chunks[ci];
+		size_t m = std::min(n, chunk.size() - offset);
+		chunk.erase(chunk.begin() + offset, chunk.begin() + offset + m);
+		chunk_offsets.add(ci++, -ptrdiff_t(m));
+		n -= m;
+		offset = 0;
+	}
+	// a single chunk that keeps enough vertices can neither be emptied nor merged
+	if (ci == first_ci + 1 && 4 * chunks[first_ci].size() >= chunk_size)
+		return;
+	// remove empty chunks and merge small chunks with their successor
+	size_t nr_chunks = chunks.size();
+	chunks.erase(std::remove_if(chunks.begin() + first_ci, chunks.begin() + ci,
+		[](const std::vector<vtx_type>& chunk) { return chunk.empty(); }), chunks.begin() + ci);
+	if (first_ci > 0)
+		--first_ci;
+	for (ci = first_ci; ci + 1 < chunks.size() && ci < first_ci + 2; ++ci)
+		if (2 * (chunks[ci].size() + chunks[ci + 1].size()) <= chunk_size) {
+			chunks[ci].insert(chunks[ci].end(), chunks[ci + 1].begin(), chunks[ci + 1].end());
+			chunks.erase(chunks.begin() + ci + 1);
+		}
+	// small chunks that could not merge keep their place, such that the updated sizes stay valid unless the list of chunks changed
+	if (chunks.size() != nr_chunks)
+		update_chunk_offsets();
+}
+
+/// replace all vertices by the given ones, which are left empty
+void vertex_storage::assign(std::vector<vtx_type>& vts)
+{
+	if (mode == VSM_MAPPED)
+		clear();
+	if (mode == VSM_CONTIGUOUS) {
+		vertices.swap(vts);
+		vts.clear();
+	}
+	else {
+		build_chunks(vts);
+		std::vector<vtx_type>().swap(vts);
+	}
+}
+
+/// remove all vertices
+void vertex_storage::clear()
+{
+	vertices.clear();
+	chunks.clear();
+	nr_chunked_vertices = 0;
+	update_chunk_offsets();
+	if (mode == VSM_MAPPED) {
+		mapping.reset();
+		mapped_vertices = 0;
+		nr_mapped_vertices = 0;
+		mode = VSM_CONTIGUOUS;
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cgv/math/fvec.h>
+#include "fenwick_tree.h"
+#include "mapped_file.h"
+
+/// different layouts of the vertex storage
+enum VertexStorageMode
+{
+	VSM_CONTIGUOUS,
+	VSM_CHUNKED,
+	VSM_MAPPED
+};
+
+/// sequence of polygon vertices that is either stored contiguously, in chunks such that insertion and removal cost O(chunk_size + log(n)), or read only in a mapped file that is copied to contiguous storage on the first modification
+class vertex_storage
+{
+public:
+	typedef cgv::math::fvec<float, 2> vtx_type;
+	/// maximum number of vertices per chunk
+	static const size_t chunk_size = 1024;
+protected:
+	/// current storage mode
+	VertexStorageMode mode;
+	/// vertices in contiguous mode
+	std::vector<vtx_type> vertices;
+	/// non empty chunks in chunked mode
+	std::vector<std::vector<vtx_type> > chunks;
+	/// chunk sizes used to locate the chunk of a vertex index
+	fenwick_tree chunk_offsets;
+	/// number of vertices in chunked mode
+	size_t nr_chunked_vertices;
+	/// mapped file and vertices within it in mapped mode
+	std::shared_ptr<mapped_file> mapping;
+	const vtx_type* mapped_vertices;
+	size_t nr_mapped_vertices;
+	/// copy mapped vertices to contiguous storage before a modification
+	void detach();
+	/// chunk found in last call to locate together with its vertex index range, which makes sequential access O(1)
+	mutable size_t cached_chunk, cached_begin, cached_end;
+	/// return the chunk containing the given vertex index and its first vertex index
+	size_t locate(size_t vtx_idx, size_t& chunk_begin) const;
+	/// rebuild chunk offsets after chunks have been inserted or removed
+	void update_chunk_offsets();
+	/// distribute the given vertices to half filled chunks
+	void build_chunks(const std::vector<vtx_type>& vts);
+public:
+	/// construct empty storage in given mode
+	vertex_storage(VertexStorageMode _mode = VSM_CONTIGUOUS);
+	/// return storage mode
+	VertexStorageMode get_mode() const;
+	/// convert storage to given mode in O(n), where conversion to mapped mode is only possible through map()
+	void set_mode(VertexStorageMode _mode);
+	/// use n vertices stored as pairs of floats at given byte offset within the mapped file, which needs to be aligned to 4 bytes
+	void map(const std::shared_ptr<mapped_file>& file, size_t offset, size_t n);
+	/// return number of vertices
+	size_t size() const;
+	/// read access to a vertex, which is O(1) for contiguous storage and for sequential access in chunked storage and O(log(n)) otherwise; not safe for concurrent readers in chunked mode
+	const vtx_type& operator [] (size_t vtx_idx) const;
+	/// write access to a vertex with the same cost as read access, besides the copy of all vertices on first write access in mapped mode
+	vtx_type& operator [] (size_t vtx_idx);
+	/// set vertex location, where vtx may reference a stored vertex
+	void set(size_t vtx_idx, const vtx_type& vtx);
+	/// return pointer to vertices in contiguous and mapped mode and 0 in chunked mode
+	const vtx_type* data() const;
+	/// copy vertex range [begin,end) to dst
+	void copy(size_t begin, size_t end, vtx_type* dst) const;
+	/// append a vertex, where vtx may reference a stored vertex
+	void push_back(const vtx_type& vtx);
+	/// insert a vertex before the given vertex index, where vtx may reference a stored vertex
+	void insert(size_t vtx_idx, const vtx_type& vtx);
+	/// remove the vertex range [begin,end)
+	void erase(size_t begin, size_t end);
+	/// replace all vertices by the given ones, which are left empty
+	void assign(std::vector<vtx_type>& vts);
+	/// remove all vertices, which returns from mapped to contiguous mode
+	void clear();
+};